@@ -26,6 +26,12 @@
 typedef cpuset_t cpu_set_t;
 #endif
 
+#if defined(__linux__)
+#	include <linux/futex.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
 #define REWEIGHT_S 4
 
 // non-rt
@@ -134,49 +140,30 @@ _uri_to_id(LV2_URI_Map_Callback_Data handle, const char *_, const char *uri)
 }
 #pragma GCC diagnostic pop
 
-__realtime static inline bool
-_sp_app_has_source_automations(mod_t *mod)
-{
-	for(unsigned i = 0; i < MAX_AUTOMATIONS; i++)
-	{
-		auto_t *automation = &mod->automations[i];
-
-		if(  (automation->type != AUTO_TYPE_NONE)
-			&& automation->src_enabled )
-		{
-			return true; // has automations
-		}
-	}
-
-	return false; // has no automations
-}
-
 __realtime static inline auto_t *
-_sp_app_find_automation_for_port(mod_t *mod, uint32_t index)
+_sp_app_find_automation_for_property(mod_t *mod, LV2_URID property)
 {
-	for(unsigned i = 0; i < MAX_AUTOMATIONS; i++)
+	const auto_index_t *idx = _automation_index(mod);
+
+	if(!property) // matches first port automation
 	{
-		auto_t *automation = &mod->automations[i];
+		for(unsigned i = 0; i < MAX_AUTOMATIONS; i++)
+		{
+			auto_t *automation = &mod->automations[i];
 
-		if(automation->type == AUTO_TYPE_NONE)
-			continue; // skip empty slot
+			if( (automation->type != AUTO_TYPE_NONE) && (automation->property == 0) )
+				return automation; // found match
+		}
 
-		if( (automation->property == 0) && (automation->index == index) )
-			return automation; // found match
+		return NULL;
 	}
 
-	return NULL;
-}
-
-__realtime static inline auto_t *
-_sp_app_find_automation_for_property(mod_t *mod, LV2_URID property)
-{
-	for(unsigned i = 0; i < MAX_AUTOMATIONS; i++)
+	for(unsigned i = idx->property[property & (AUTO_HASH - 1)]; i; i = idx->next_property[i - 1])
 	{
-		auto_t *automation = &mod->automations[i];
+		auto_t *automation = &mod->automations[i - 1];
 
 		if(automation->type == AUTO_TYPE_NONE)
-			continue; // skip empty slot
+			continue; // skip slot invalidated since last rebuild
 
 		if(automation->property == property)
 			return automation; // found match
@@ -220,10 +207,65 @@ _sp_app_automation_out(sp_app_t *app, LV2_Atom_Forge *forge, auto_t *automation,
 	return ref;
 }
 
+__realtime static inline uint64_t
+_dsp_master_now(sp_app_t *app)
+{
+	struct timespec now;
+	cross_clock_gettime(&app->clk_mono, &now);
+
+	return now.tv_sec*1000000000ULL + now.tv_nsec;
+}
+
+__realtime static inline bool
+_sp_app_mod_dirty_otype(sp_app_t *app, port_t *port, LV2_URID otype)
+{
+	if(port->direction == PORT_DIRECTION_OUTPUT)
+		return otype == app->regs.state.state_changed.urid;
+
+	// any patch message but patch:Get may change state
+	return (otype == app->regs.patch.set.urid)
+		|| (otype == app->regs.patch.put.urid)
+		|| (otype == app->regs.patch.patch.urid)
+		|| (otype == app->regs.patch.insert.urid)
+		|| (otype == app->regs.patch.delete.urid)
+		|| (otype == app->regs.patch.copy.urid)
+		|| (otype == app->regs.patch.move.urid);
+}
+
+// mark module for its state to be saved again upon patch messages into or
+// state:StateChanged notifications out of it
+__realtime static inline void
+_sp_app_mod_dirty_scan(sp_app_t *app, mod_t *mod)
+{
+	for(unsigned p=0; p<mod->num_ports; p++)
+	{
+		port_t *port = &mod->ports[p];
+
+		if(  (port->type != PORT_TYPE_ATOM)
+			|| (port->atom.buffer_type != PORT_BUFFER_TYPE_SEQUENCE) )
+			continue;
+
+		const LV2_Atom_Sequence *seq = PORT_BUFFER_ALIGNED(port);
+
+		LV2_ATOM_SEQUENCE_FOREACH(seq, ev)
+		{
+			const LV2_Atom_Object *obj = (const LV2_Atom_Object *)&ev->body;
+
+			if(  lv2_atom_forge_is_object_type(&app->forge, obj->atom.type)
+				&& _sp_app_mod_dirty_otype(app, port, obj->body.otype) )
+			{
+				atomic_store(&mod->dirty, true);
+				return;
+			}
+		}
+	}
+}
+
 __realtime static inline void
-_sp_app_process_single_run(mod_t *mod, uint32_t nsamples)
+_sp_app_process_single_run(mod_t *mod, uint32_t nsamples, unsigned tid)
 {
 	sp_app_t *app = mod->app;
+	const bool tracing = app->trace.rings != NULL;
 
 	struct timespec mod_t1;
 	struct timespec mod_t2;
@@ -251,11 +293,20 @@ _sp_app_process_single_run(mod_t *mod, uint32_t nsamples)
 		}
 		else // PORT_DIRECTION_INPUT
 		{
-			if(port->driver->multiplex)
+			// aliases are only ever rewired at cycle boundary
+			if(port->driver->multiplex && !port->alias)
 				port->driver->multiplex(app, port, nsamples);
 		}
 	}
 
+	uint64_t t1 = 0;
+	if(tracing)
+	{
+		t1 = _dsp_master_now(app);
+		_sp_app_trace(app, tid, TRACE_TYPE_MULTIPLEX, mod->urn,
+			mod_t1.tv_sec*1000000000ULL + mod_t1.tv_nsec, t1);
+	}
+
 	mod_worker_t *mod_worker = &mod->mod_worker;
 	if(mod_worker->app_from_worker)
 	{
@@ -271,15 +322,29 @@ _sp_app_process_single_run(mod_t *mod, uint32_t nsamples)
 
 			varchunk_read_advance(mod_worker->app_from_worker);
 		}
+
+		if(tracing)
+			_sp_app_trace(app, tid, TRACE_TYPE_WORKER, mod->urn, t1, _dsp_master_now(app));
 	}
 
 	// is module currently loading a preset asynchronously?
-	if(!mod->bypassed)
+	if(!mod->bypassed && !mod->disabled)
 	{
 		// run plugin
-		if(!mod->disabled)
+		lilv_instance_run(mod->inst, nsamples);
+	}
+	else
+	{
+		// shared buffers hold content of other modules, silence them
+		for(unsigned p=0; p<mod->num_ports; p++)
 		{
-			lilv_instance_run(mod->inst, nsamples);
+			port_t *port = &mod->ports[p];
+
+			if(  (port->direction == PORT_DIRECTION_OUTPUT)
+				&& _sp_app_arena_owns(app, port->base) )
+			{
+				memset(port->base, 0x0, nsamples * sizeof(float));
+			}
 		}
 	}
 
@@ -289,6 +354,10 @@ _sp_app_process_single_run(mod_t *mod, uint32_t nsamples)
 		mod->worker.iface->end_run(mod->handle);
 	}
 
+	// only modules with state need scanning, already dirty ones not until saved
+	if(mod->dirty_scan && !atomic_load_explicit(&mod->dirty, memory_order_relaxed))
+		_sp_app_mod_dirty_scan(app, mod);
+
 	//handle automation output
 	{
 		const unsigned ao = mod->num_ports - 1;
@@ -302,35 +371,44 @@ _sp_app_process_single_run(mod_t *mod, uint32_t nsamples)
 		lv2_atom_forge_set_buffer(&forge, (uint8_t *)seq, capacity);
 		LV2_Atom_Forge_Ref ref = lv2_atom_forge_sequence_head(&forge, &frame, 0);
 
-		if(_sp_app_has_source_automations(mod))
+		const auto_index_t *idx = _automation_index(mod);
+
+		if(idx->has_source)
 		{
 			uint32_t t0 = 0;
 
-			for(unsigned p=0; p<mod->num_ports; p++)
+			// only visit control ports with source automation
+			for(uint64_t sources = idx->port_sources; sources; sources &= sources - 1)
 			{
-				port_t *port = &mod->ports[p];
+				auto_t *automation = &mod->automations[__builtin_ctzll(sources)];
 
-				if(port->type == PORT_TYPE_CONTROL)
-				{
-					const float *val = PORT_BASE_ALIGNED(port);
+				if(automation->type == AUTO_TYPE_NONE)
+					continue; // invalidated since last rebuild
 
-					if(  (*val != port->control.last)
-						|| (port->control.auto_dirty) ) // has changed since last cycle
-					{
-						auto_t *automation = _sp_app_find_automation_for_port(mod, p);
+				port_t *port = &mod->ports[automation->index];
 
-						if(automation && automation->src_enabled)
-						{
-							const double value = (*val - automation->add) / automation->mul;
+				if(port->type != PORT_TYPE_CONTROL)
+					continue;
 
-							if(ref)
-								ref = _sp_app_automation_out(app, &forge, automation, t0, value);
-						}
+				const float *val = PORT_BASE_ALIGNED(port);
 
-						port->control.auto_dirty = false;
-					}
+				if(  (*val != port->control.last)
+					|| (port->control.auto_dirty) ) // has changed since last cycle
+				{
+					const double value = (*val - automation->add) / automation->mul;
+
+					if(ref)
+						ref = _sp_app_automation_out(app, &forge, automation, t0, value);
+
+					port->control.auto_dirty = false;
 				}
-				else if( (port->type == PORT_TYPE_ATOM)
+			}
+
+			for(unsigned p=0; idx->property_sources && (p<mod->num_ports); p++)
+			{
+				port_t *port = &mod->ports[p];
+
+				if( (port->type == PORT_TYPE_ATOM)
 					&& port->atom.patchable )
 				{
 					const LV2_Atom_Sequence *patch_seq = PORT_BASE_ALIGNED(port);
@@ -452,6 +530,13 @@ _sp_app_process_single_run(mod_t *mod, uint32_t nsamples)
 	const unsigned run_time = (mod_t2.tv_sec - mod_t1.tv_sec)*1000000000
 		+ mod_t2.tv_nsec - mod_t1.tv_nsec;
 	mod->prof.sum += run_time;
+	_sp_app_hist_add(&mod->prof.hist, run_time, app->prof.budget);
+
+	if(tracing)
+	{
+		const uint64_t t0 = mod_t1.tv_sec*1000000000ULL + mod_t1.tv_nsec;
+		_sp_app_trace(app, tid, TRACE_TYPE_RUN, mod->urn, t0, t0 + run_time);
+	}
 
 	if(run_time < mod->prof.min)
 		mod->prof.min = run_time;
@@ -460,9 +545,9 @@ _sp_app_process_single_run(mod_t *mod, uint32_t nsamples)
 }
 
 __realtime static void
-_sync_midi_automation_to_ui(sp_app_t *app, mod_t *mod, auto_t *automation)
+_sync_midi_automation_to_ui(sp_app_t *app, post_t *post, mod_t *mod, auto_t *automation)
 {
-	LV2_Atom *answer = _sp_app_to_ui_request_atom(app);
+	LV2_Atom *answer = _sp_app_post_request_atom(app, post);
 	if(answer)
 	{
 		const LV2_URID subj = 0; //FIXME
@@ -472,15 +557,15 @@ _sync_midi_automation_to_ui(sp_app_t *app, mod_t *mod, auto_t *automation)
 
 		LV2_Atom_Forge_Frame frame [3];
 		LV2_Atom_Forge_Ref ref = synthpod_patcher_add_object(
-			&app->regs, &app->forge, &frame[0], subj, sn, prop);
+			&app->regs, post->forge, &frame[0], subj, sn, prop);
 
 		if(ref)
-			ref = _sp_app_forge_midi_automation(app, &frame[2], mod, port, automation);
+			ref = _sp_app_forge_midi_automation(app, post->forge, &frame[2], mod, port, automation);
 
 		if(ref)
 		{
-			synthpod_patcher_pop(&app->forge, frame, 2);
-			_sp_app_to_ui_advance_atom(app, answer);
+			synthpod_patcher_pop(post->forge, frame, 2);
+			_sp_app_post_advance_atom(app, post, answer);
 		}
 		else
 		{
@@ -494,9 +579,9 @@ _sync_midi_automation_to_ui(sp_app_t *app, mod_t *mod, auto_t *automation)
 }
 
 __realtime static void
-_sync_osc_automation_to_ui(sp_app_t *app, mod_t *mod, auto_t *automation)
+_sync_osc_automation_to_ui(sp_app_t *app, post_t *post, mod_t *mod, auto_t *automation)
 {
-	LV2_Atom *answer = _sp_app_to_ui_request_atom(app);
+	LV2_Atom *answer = _sp_app_post_request_atom(app, post);
 	if(answer)
 	{
 		const LV2_URID subj = 0; //FIXME
@@ -506,15 +591,15 @@ _sync_osc_automation_to_ui(sp_app_t *app, mod_t *mod, auto_t *automation)
 
 		LV2_Atom_Forge_Frame frame [3];
 		LV2_Atom_Forge_Ref ref = synthpod_patcher_add_object(
-			&app->regs, &app->forge, &frame[0], subj, sn, prop);
+			&app->regs, post->forge, &frame[0], subj, sn, prop);
 
 		if(ref)
-			ref = _sp_app_forge_osc_automation(app, &frame[2], mod, port, automation);
+			ref = _sp_app_forge_osc_automation(app, post->forge, &frame[2], mod, port, automation);
 
 		if(ref)
 		{
-			synthpod_patcher_pop(&app->forge, frame, 2);
-			_sp_app_to_ui_advance_atom(app, answer);
+			synthpod_patcher_pop(post->forge, frame, 2);
+			_sp_app_post_advance_atom(app, post, answer);
 		}
 		else
 		{
@@ -528,10 +613,15 @@ _sync_osc_automation_to_ui(sp_app_t *app, mod_t *mod, auto_t *automation)
 }
 
 __realtime static inline void
-_sp_app_process_single_post(mod_t *mod, uint32_t nsamples, bool sparse_update_timeout)
+_sp_app_process_single_post(mod_t *mod, post_t *post, uint32_t nsamples,
+	bool sparse_update_timeout)
 {
 	sp_app_t *app = mod->app;
 
+	struct timespec mod_t1;
+	struct timespec mod_t2;
+	cross_clock_gettime(&app->clk_mono, &mod_t1);
+
 	//handle dsp debug output (for next cycle)
 	{
 		const unsigned ao = mod->num_ports - 4;
@@ -541,7 +631,7 @@ _sp_app_process_single_post(mod_t *mod, uint32_t nsamples, bool sparse_update_ti
 		const uint32_t capacity = PORT_SIZE(auto_port);
 		LV2_Atom_Forge_Frame frame;
 
-		LV2_Atom_Forge forge = app->forge; //FIXME do this only once
+		LV2_Atom_Forge forge = *post->forge; //FIXME do this only once
 		lv2_atom_forge_set_buffer(&forge, (uint8_t *)seq, capacity);
 		LV2_Atom_Forge_Ref ref = lv2_atom_forge_sequence_head(&forge, &frame, 0);
 
@@ -558,20 +648,17 @@ _sp_app_process_single_post(mod_t *mod, uint32_t nsamples, bool sparse_update_ti
 		}
 	}
 
-	// handle mod ui post
-	for(unsigned i=0; i<mod->num_ports; i++)
+	// handle mod ui post, only subscribed ports need notification
+	for(unsigned i=0; i<mod->num_subscribed; i++)
 	{
-		port_t *port = &mod->ports[i];
+		port_t *port = &mod->ports[mod->subscribed[i]];
 
-		// no notification/subscription and no support for patch:Message
-		const bool subscribed = port->subscriptions != 0;
-		if(!subscribed)
-			continue; // skip this port
+		// no support for patch:Message
 		if( (port->type == PORT_TYPE_ATOM) && !port->atom.patchable)
 			continue; // skip this port
 
 		if(port->driver->transfer && (port->driver->sparse_update ? sparse_update_timeout : true))
-			port->driver->transfer(app, port, nsamples);
+			port->driver->transfer(app, post, port, nsamples);
 	}
 
 	// handle inline display
@@ -586,25 +673,25 @@ _sp_app_process_single_post(mod_t *mod, uint32_t nsamples, bool sparse_update_ti
 			if(surf)
 			{
 				// to nk
-				LV2_Atom *answer = _sp_app_to_ui_request_atom(app);
+				LV2_Atom *answer = _sp_app_post_request_atom(app, post);
 				if(answer)
 				{
 					LV2_Atom_Forge_Frame frame [3];
 
-					LV2_Atom_Forge_Ref ref = synthpod_patcher_set_object(&app->regs, &app->forge, &frame[0],
+					LV2_Atom_Forge_Ref ref = synthpod_patcher_set_object(&app->regs, post->forge, &frame[0],
 						mod->urn, 0, app->regs.idisp.surface.urid); //TODO seqn
 					if(ref)
-						ref = lv2_atom_forge_tuple(&app->forge, &frame[1]);
+						ref = lv2_atom_forge_tuple(post->forge, &frame[1]);
 					if(ref)
-						ref = lv2_atom_forge_int(&app->forge, surf->width);
+						ref = lv2_atom_forge_int(post->forge, surf->width);
 					if(ref)
-						ref = lv2_atom_forge_int(&app->forge, surf->height);
+						ref = lv2_atom_forge_int(post->forge, surf->height);
 					if(ref)
-						ref = lv2_atom_forge_vector_head(&app->forge, &frame[2], sizeof(int32_t), app->forge.Int);
+						ref = lv2_atom_forge_vector_head(post->forge, &frame[2], sizeof(int32_t), post->forge->Int);
 					if(surf->stride == surf->width * sizeof(uint32_t))
 					{
 						if(ref)
-							ref = lv2_atom_forge_write(&app->forge, surf->data, surf->height * surf->stride);
+							ref = lv2_atom_forge_write(post->forge, surf->data, surf->height * surf->stride);
 					}
 					else
 					{
@@ -613,18 +700,18 @@ _sp_app_process_single_post(mod_t *mod, uint32_t nsamples, bool sparse_update_ti
 							const uint8_t *row = &surf->data[surf->stride * h];
 
 							if(ref)
-								ref = lv2_atom_forge_raw(&app->forge, row, surf->width * sizeof(uint32_t));
+								ref = lv2_atom_forge_raw(post->forge, row, surf->width * sizeof(uint32_t));
 						}
 						if(ref)
-							lv2_atom_forge_pad(&app->forge, surf->height * surf->width * sizeof(uint32_t));
+							lv2_atom_forge_pad(post->forge, surf->height * surf->width * sizeof(uint32_t));
 					}
 
 					if(ref)
-						synthpod_patcher_pop(&app->forge, frame, 3);
+						synthpod_patcher_pop(post->forge, frame, 3);
 
 					if(ref)
 					{
-						_sp_app_to_ui_advance_atom(app, answer);
+						_sp_app_post_advance_atom(app, post, answer);
 					}
 					else
 					{
@@ -644,20 +731,21 @@ _sp_app_process_single_post(mod_t *mod, uint32_t nsamples, bool sparse_update_ti
 		}
 	}
 
-	// handle automation learn
-	for(unsigned i = 0; i < MAX_AUTOMATIONS; i++)
+	// handle automation learn, only wildcard automations may be learning
+	const auto_index_t *idx = _automation_index(mod);
+	for(uint64_t wild = idx->midi_wild | idx->osc_wild; wild; wild &= wild - 1)
 	{
-		auto_t *automation = &mod->automations[i];
+		auto_t *automation = &mod->automations[__builtin_ctzll(wild)];
 
 		if(automation->sync)
 		{
 			if(automation->type == AUTO_TYPE_MIDI)
 			{
-				_sync_midi_automation_to_ui(app, mod, automation);
+				_sync_midi_automation_to_ui(app, post, mod, automation);
 			}
 			else if(automation->type == AUTO_TYPE_OSC)
 			{
-				_sync_osc_automation_to_ui(app, mod, automation);
+				_sync_osc_automation_to_ui(app, post, mod, automation);
 			}
 
 			automation->sync = false;
@@ -673,7 +761,7 @@ _sp_app_process_single_post(mod_t *mod, uint32_t nsamples, bool sparse_update_ti
 		const uint32_t capacity = PORT_SIZE(auto_port);
 		LV2_Atom_Forge_Frame frame;
 
-		LV2_Atom_Forge forge = app->forge; //FIXME do this only once
+		LV2_Atom_Forge forge = *post->forge; //FIXME do this only once
 		lv2_atom_forge_set_buffer(&forge, (uint8_t *)seq, capacity);
 		LV2_Atom_Forge_Ref ref = lv2_atom_forge_sequence_head(&forge, &frame, 0);
 
@@ -689,10 +777,45 @@ _sp_app_process_single_post(mod_t *mod, uint32_t nsamples, bool sparse_update_ti
 			lv2_atom_sequence_clear(seq);
 		}
 	}
+
+	if(post->to_ui)
+		varchunk_write_commit(post->to_ui);
+
+	cross_clock_gettime(&app->clk_mono, &mod_t2);
+
+	// profiling
+	mod->prof.post += (mod_t2.tv_sec - mod_t1.tv_sec)*1000000000
+		+ mod_t2.tv_nsec - mod_t1.tv_nsec;
+}
+
+__realtime static inline void
+_dsp_client_ran(dsp_master_t *dsp_master, dsp_client_t *dsp_client, int node)
+{
+	if( (dsp_master->num_nodes > 1) && (node < MAX_NODES) )
+		dsp_client->node_runs[node] += 1;
+}
+
+// post right after run on the same thread, sinks are released afterwards
+__realtime static inline void
+_dsp_client_post(sp_app_t *app, dsp_master_t *dsp_master, mod_t *mod, unsigned idx)
+{
+	if(app->posts)
+	{
+		_sp_app_process_single_post(mod, &app->posts[idx], dsp_master->nsamples,
+			dsp_master->sparse_update_timeout);
+	}
 }
 
 __realtime static inline int
-_dsp_slave_fetch(dsp_master_t *dsp_master, int head)
+_dsp_slave_node(dsp_master_t *dsp_master, unsigned idx)
+{
+	return idx == 0
+		? dsp_master->node
+		: dsp_master->dsp_slaves[idx - 1].node;
+}
+
+__realtime static inline int
+_dsp_slave_fetch(dsp_master_t *dsp_master, int head, unsigned idx, int node)
 {
 	sp_app_t *app = (void *)dsp_master - offsetof(sp_app_t, dsp_master);
 
@@ -701,8 +824,8 @@ _dsp_slave_fetch(dsp_master_t *dsp_master, int head)
 
 	for(unsigned m=M; m<app->num_mods; m++)
 	{
-		mod_t *mod = app->mods[m];
-		dsp_client_t *dsp_client = &mod->dsp_client;
+		dsp_client_t *dsp_client = dsp_master->dsp_clients[m];
+		mod_t *mod = (void *)dsp_client - offsetof(mod_t, dsp_client);
 
 		int expected = 0;
 		const int desired = -1; // mark as done
@@ -710,7 +833,9 @@ _dsp_slave_fetch(dsp_master_t *dsp_master, int head)
 			&expected, desired);
 		if(match) // needs to run now
 		{
-			_sp_app_process_single_run(mod, dsp_master->nsamples);
+			_sp_app_process_single_run(mod, dsp_master->nsamples, idx);
+			_dsp_client_ran(dsp_master, dsp_client, node);
+			_dsp_client_post(app, dsp_master, mod, idx);
 
 			for(unsigned j=0; j<dsp_client->num_sinks; j++)
 			{
@@ -732,13 +857,208 @@ _dsp_slave_fetch(dsp_master_t *dsp_master, int head)
 }
 
 __realtime static inline void
-_dsp_slave_spin(sp_app_t *app, dsp_master_t *dsp_master, bool post)
+_dsp_cpu_relax(void)
 {
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+#if defined(__linux__)
+__realtime static inline void
+_dsp_futex_wait(atomic_uint *addr, unsigned val)
+{
+	syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+__realtime static inline void
+_dsp_futex_wake(atomic_uint *addr)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+#endif
+
+// spin for a bounded time for the next cycle, then park on futex
+__realtime static inline unsigned
+_dsp_slave_park(sp_app_t *app, dsp_master_t *dsp_master, unsigned generation)
+{
+	const uint64_t t0 = _dsp_master_now(app);
+	unsigned next;
+
+	for(unsigned i = 1; ; i++)
+	{
+		next = atomic_load_explicit(&dsp_master->generation, memory_order_acquire);
+		if(next != generation)
+			return next;
+
+		if( !(i % 64) && (_dsp_master_now(app) - t0 >= dsp_master->spin_ns) )
+			break; // spun long enough
+
+		_dsp_cpu_relax();
+	}
+
+#if defined(__linux__)
+	atomic_fetch_add(&dsp_master->sleepers, 1);
+
+	while( (next = atomic_load(&dsp_master->generation)) == generation)
+	{
+		_dsp_futex_wait(&dsp_master->generation, generation);
+	}
+
+	atomic_fetch_sub(&dsp_master->sleepers, 1);
+#endif
+
+	return next;
+}
+
+__realtime static inline void
+_dsp_slave_done(dsp_master_t *dsp_master)
+{
+	if(dsp_master->spin_ns)
+	{
+		atomic_fetch_add_explicit(&dsp_master->done, 1, memory_order_release);
+	}
+	else
+	{
+		sem_post(&dsp_master->sem);
+	}
+}
+
+#if defined(USE_WORK_STEALING)
+__realtime static inline void
+_dsp_deque_reset(dsp_deque_t *dsp_deque)
+{
+	atomic_store_explicit(&dsp_deque->top, 0, memory_order_relaxed);
+	atomic_store_explicit(&dsp_deque->bottom, 0, memory_order_relaxed);
+}
+
+// only to be called by owner thread (or by master before waking up slaves)
+__realtime static inline void
+_dsp_deque_push(dsp_deque_t *dsp_deque, dsp_client_t *dsp_client)
+{
+	const int b = atomic_load_explicit(&dsp_deque->bottom, memory_order_relaxed);
+	assert(b < MAX_MODS);
+
+	atomic_store_explicit(&dsp_deque->clients[b], dsp_client, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&dsp_deque->bottom, b + 1, memory_order_relaxed);
+}
+
+// only to be called by owner thread, LIFO
+__realtime static inline dsp_client_t *
+_dsp_deque_take(dsp_deque_t *dsp_deque)
+{
+	const int b = atomic_load_explicit(&dsp_deque->bottom, memory_order_relaxed) - 1;
+	atomic_store_explicit(&dsp_deque->bottom, b, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	int t = atomic_load_explicit(&dsp_deque->top, memory_order_relaxed);
+
+	if(t > b) // empty
+	{
+		atomic_store_explicit(&dsp_deque->bottom, b + 1, memory_order_relaxed);
+		return NULL;
+	}
+
+	dsp_client_t *dsp_client = atomic_load_explicit(&dsp_deque->clients[b], memory_order_relaxed);
+
+	if(t == b) // last element, race against thieves
+	{
+		if(!atomic_compare_exchange_strong_explicit(&dsp_deque->top, &t, t + 1,
+			memory_order_seq_cst, memory_order_relaxed))
+		{
+			dsp_client = NULL; // lost race
+		}
+
+		atomic_store_explicit(&dsp_deque->bottom, b + 1, memory_order_relaxed);
+	}
+
+	return dsp_client;
+}
+
+// may be called by any thread, FIFO
+__realtime static inline dsp_client_t *
+_dsp_deque_steal(dsp_deque_t *dsp_deque)
+{
+	int t = atomic_load_explicit(&dsp_deque->top, memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	const int b = atomic_load_explicit(&dsp_deque->bottom, memory_order_acquire);
+
+	if(t >= b) // empty
+		return NULL;
+
+	dsp_client_t *dsp_client = atomic_load_explicit(&dsp_deque->clients[t], memory_order_relaxed);
+
+	if(!atomic_compare_exchange_strong_explicit(&dsp_deque->top, &t, t + 1,
+		memory_order_seq_cst, memory_order_relaxed))
+	{
+		return NULL; // lost race, try again later
+	}
+
+	return dsp_client;
+}
+
+__realtime static inline void
+_dsp_slave_spin(sp_app_t *app, dsp_master_t *dsp_master, unsigned idx, bool post)
+{
+	const unsigned num_deques = dsp_master->num_deques;
+
+	if(idx < num_deques) // was this thread scheduled for this cycle?
+	{
+		dsp_deque_t *dsp_deque = &dsp_master->dsp_deques[idx];
+		const int node = _dsp_slave_node(dsp_master, idx);
+
+		while(atomic_load_explicit(&dsp_master->pending, memory_order_acquire)
+			&& !atomic_load_explicit(&dsp_master->emergency_exit, memory_order_relaxed))
+		{
+			dsp_client_t *dsp_client = _dsp_deque_take(dsp_deque);
+
+			// nothing to do locally, try to steal from the others
+			for(unsigned i = 1; !dsp_client && (i < num_deques); i++)
+			{
+				dsp_client = _dsp_deque_steal(&dsp_master->dsp_deques[(idx + i) % num_deques]);
+			}
+
+			if(!dsp_client)
+				continue; // nothing ready yet
+
+			mod_t *mod = (void *)dsp_client - offsetof(mod_t, dsp_client);
+
+			_sp_app_process_single_run(mod, dsp_master->nsamples, idx);
+			_dsp_client_ran(dsp_master, dsp_client, node);
+			_dsp_client_post(app, dsp_master, mod, idx);
+
+			// push in ascending rank, so the sink on the critical path is taken first
+			for(int j=dsp_client->num_sinks - 1; j>=0; j--)
+			{
+				dsp_client_t *sink = dsp_client->sinks[j];
+				const int32_t ref_count = atomic_fetch_sub(&sink->ref_count, 1);
+				assert(ref_count > 0);
+
+				if(ref_count == 1) // all sources of sink have run, it is ready now
+					_dsp_deque_push(dsp_deque, sink);
+			}
+
+			atomic_fetch_sub_explicit(&dsp_master->pending, 1, memory_order_release);
+		}
+	}
+
+	if(post)
+	{
+		_dsp_slave_done(dsp_master);
+	}
+}
+#else
+__realtime static inline void
+_dsp_slave_spin(sp_app_t *app, dsp_master_t *dsp_master, unsigned idx, bool post)
+{
+	const int node = _dsp_slave_node(dsp_master, idx);
 	int head = 0;
 
 	while(!atomic_load(&dsp_master->emergency_exit))
 	{
-		head = _dsp_slave_fetch(dsp_master, head);
+		head = _dsp_slave_fetch(dsp_master, head, idx, node);
 		if(head == -1) // no more work left
 		{
 			break;
@@ -747,9 +1067,10 @@ _dsp_slave_spin(sp_app_t *app, dsp_master_t *dsp_master, bool post)
 
 	if(post)
 	{
-		sem_post(&dsp_master->sem);
+		_dsp_slave_done(dsp_master);
 	}
 }
+#endif
 
 __non_realtime static void *
 _dsp_slave_thread(void *data)
@@ -772,20 +1093,44 @@ _dsp_slave_thread(void *data)
 			sp_app_log_error(app, "%s: pthread_setschedparam error\n", __func__);
 	}
 
-	if(app->driver->cpu_affinity)
+	if(app->driver->cpu_affinity && (dsp_slave->cpu >= 0))
 	{
 		cpu_set_t cpuset;
 		CPU_ZERO(&cpuset);
-		CPU_SET(num, &cpuset);
+		CPU_SET(dsp_slave->cpu, &cpuset);
 		if(pthread_setaffinity_np(self, sizeof(cpu_set_t), &cpuset))
 			sp_app_log_error(app, "%s: pthread_setaffinity_np error\n", __func__);
 	}
 
+	unsigned generation = atomic_load(&dsp_master->generation);
+
 	while(true)
 	{
-		sem_wait(&dsp_slave->sem);
+		if(dsp_master->spin_ns)
+		{
+			generation = _dsp_slave_park(app, dsp_master, generation);
+
+			// slaves taking part are published with the very generation observed
+			if(num > (generation & DSP_ACTIVE_MASK))
+				continue; // not taking part in this cycle
+		}
+		else
+		{
+			sem_wait(&dsp_slave->sem);
+		}
 
-		_dsp_slave_spin(app, dsp_master, true);
+		// profile wake-to-run latency
+		const uint64_t t_wake = _dsp_master_now(app);
+		const uint64_t dt = t_wake - dsp_master->t_post;
+		dsp_slave->wake_sum += dt;
+		dsp_slave->wake_count += 1;
+		if(dt > dsp_slave->wake_max)
+			dsp_slave->wake_max = dt;
+
+		if(app->trace.rings)
+			_sp_app_trace(app, num, TRACE_TYPE_WAKE, 0, dsp_master->t_post, t_wake);
+
+		_dsp_slave_spin(app, dsp_master, num, true);
 
 		if(atomic_load(&dsp_master->kill))
 			break;
@@ -797,8 +1142,28 @@ _dsp_slave_thread(void *data)
 }
 
 __realtime static inline void
-_dsp_master_post(dsp_master_t *dsp_master, unsigned num)
+_dsp_master_post(sp_app_t *app, dsp_master_t *dsp_master, unsigned num)
 {
+	dsp_master->t_post = _dsp_master_now(app);
+
+	if(dsp_master->spin_ns)
+	{
+		const unsigned generation = atomic_load_explicit(&dsp_master->generation,
+			memory_order_relaxed); // only ever written by master
+
+		atomic_store_explicit(&dsp_master->done, 0, memory_order_relaxed);
+
+		// releases all slaves at once
+		atomic_store(&dsp_master->generation,
+			((generation & ~DSP_ACTIVE_MASK) + (1U << DSP_ACTIVE_BITS)) | num);
+#if defined(__linux__)
+		if(atomic_load(&dsp_master->sleepers))
+			_dsp_futex_wake(&dsp_master->generation);
+#endif
+
+		return;
+	}
+
 	for(unsigned i=0; i<num; i++)
 	{
 		dsp_slave_t *dsp_slave = &dsp_master->dsp_slaves[i];
@@ -810,6 +1175,24 @@ _dsp_master_post(dsp_master_t *dsp_master, unsigned num)
 __realtime static inline void
 _dsp_master_wait(sp_app_t *app, dsp_master_t *dsp_master, unsigned num)
 {
+	if(dsp_master->spin_ns)
+	{
+		// if workers have not finished in due 1s, do emergency exit!
+		const uint64_t to = _dsp_master_now(app) + 1000000000ULL;
+
+		for(unsigned i = 1;
+			atomic_load_explicit(&dsp_master->done, memory_order_acquire) < num;
+			i++)
+		{
+			if( !(i % 1024) && (_dsp_master_now(app) > to) )
+				atomic_store(&dsp_master->emergency_exit, true);
+
+			_dsp_cpu_relax();
+		}
+
+		return;
+	}
+
 	// derive timeout
 	struct timespec to;
 	cross_clock_gettime(&app->clk_real, &to);
@@ -840,6 +1223,23 @@ _dsp_master_wait(sp_app_t *app, dsp_master_t *dsp_master, unsigned num)
 __realtime static inline void
 _dsp_master_process(sp_app_t *app, dsp_master_t *dsp_master, unsigned nsamples)
 {
+	unsigned num_slaves = dsp_master->concurrent - 1;
+	if(num_slaves > dsp_master->num_slaves)
+		num_slaves = dsp_master->num_slaves;
+
+#if defined(USE_WORK_STEALING)
+	dsp_master->num_deques = num_slaves + 1;
+
+	for(unsigned i=0; i<dsp_master->num_deques; i++)
+	{
+		_dsp_deque_reset(&dsp_master->dsp_deques[i]);
+	}
+
+	atomic_store_explicit(&dsp_master->pending, app->num_mods, memory_order_relaxed);
+
+	unsigned d = 0;
+#endif
+
 	for(unsigned m=0; m<app->num_mods; m++)
 	{
 		mod_t *mod = app->mods[m];
@@ -848,15 +1248,35 @@ _dsp_master_process(sp_app_t *app, dsp_master_t *dsp_master, unsigned nsamples)
 		atomic_store(&dsp_client->ref_count, dsp_client->num_sources);
 	}
 
+#if defined(USE_WORK_STEALING)
+	// seed root clients round-robin in ascending rank, deques are taken LIFO
+	for(int m=app->num_mods - 1; m>=0; m--)
+	{
+		dsp_client_t *dsp_client = dsp_master->dsp_clients[m];
+
+		if(dsp_client->num_sources == 0)
+		{
+			_dsp_deque_push(&dsp_master->dsp_deques[d], dsp_client);
+			d = (d + 1) % dsp_master->num_deques;
+		}
+	}
+#endif
+
 	dsp_master->nsamples = nsamples;
 
-	unsigned num_slaves = dsp_master->concurrent - 1;
-	if(num_slaves > dsp_master->num_slaves)
-		num_slaves = dsp_master->num_slaves;
+	_dsp_master_post(app, dsp_master, num_slaves); // wake up other slaves
+	_dsp_slave_spin(app, dsp_master, 0, false); // runs jobs itself 
 
-	_dsp_master_post(dsp_master, num_slaves); // wake up other slaves
-	_dsp_slave_spin(app, dsp_master, false); // runs jobs itself 
-	_dsp_master_wait(app, dsp_master, num_slaves);
+	if(app->trace.rings)
+	{
+		const uint64_t t0 = _dsp_master_now(app);
+		_dsp_master_wait(app, dsp_master, num_slaves);
+		_sp_app_trace(app, 0, TRACE_TYPE_BARRIER, 0, t0, _dsp_master_now(app));
+	}
+	else
+	{
+		_dsp_master_wait(app, dsp_master, num_slaves);
+	}
 }
 
 void
@@ -902,6 +1322,58 @@ _sp_app_populate(sp_app_t *app)
 	{
 		sp_app_log_error(app, "%s: failed to create system sink\n", __func__);
 	}
+
+	_dsp_master_reorder(app);
+}
+
+__non_realtime static void
+_sp_app_post_deinit(sp_app_t *app)
+{
+	if(app->posts)
+	{
+		for(unsigned i=0; i<app->num_posts; i++)
+			varchunk_free(app->posts[i].to_ui);
+
+		free(app->posts);
+		app->posts = NULL;
+	}
+
+	app->num_posts = 0;
+}
+
+__non_realtime static void
+_sp_app_post_init(sp_app_t *app)
+{
+	app->posts = NULL;
+	app->num_posts = 0;
+
+	if(app->dsp_master.num_slaves == 0)
+		return; // serial processing posts directly
+
+	// one ring for master and each slave thread
+	app->num_posts = app->dsp_master.num_slaves + 1;
+	app->posts = calloc(app->num_posts, sizeof(post_t));
+	if(!app->posts)
+	{
+		sp_app_log_error(app, "%s: calloc failed\n", __func__);
+		app->num_posts = 0;
+		return;
+	}
+
+	for(unsigned i=0; i<app->num_posts; i++)
+	{
+		post_t *post = &app->posts[i];
+
+		post->local = app->forge;
+		post->forge = &post->local;
+		post->to_ui = varchunk_new(POST_RING_SIZE, true);
+		if(!post->to_ui)
+		{
+			sp_app_log_error(app, "%s: varchunk_new failed\n", __func__);
+			_sp_app_post_deinit(app); // fall back to posting serially
+			return;
+		}
+	}
 }
 
 sp_app_t *
@@ -946,7 +1418,7 @@ sp_app_new(const LilvWorld *world, sp_app_driver_t *driver, void *data)
 			lilv_world_set_option(app->world, LILV_OPTION_DYN_MANIFEST, node_false);
 			lilv_node_free(node_false);
 		}
-		lilv_world_load_all(app->world);
+		_sp_app_index_init(app); // loads world in full if index is stale
 		LilvNode *synthpod_bundle = lilv_new_file_uri(app->world, NULL, SYNTHPOD_BUNDLE_DIR);
 		if(synthpod_bundle)
 		{
@@ -959,12 +1431,14 @@ sp_app_new(const LilvWorld *world, sp_app_driver_t *driver, void *data)
 	lv2_atom_forge_init(&app->forge, app->driver->map);
 	sp_regs_init(&app->regs, app->world, app->driver->map);
 
+	_sp_app_arena_init(app);
 	_sp_app_populate(app);
 
 	app->fps.bound = driver->sample_rate / driver->update_rate;
 	app->fps.counter = 0;
 
 	app->ramp_samples = driver->sample_rate / 10; // ramp over 0.1s FIXME make this configurable
+	app->mix = _sp_app_mix_dispatch();
 
 	// populate uri_to_id
 	app->uri_to_id.callback_data = app;
@@ -993,8 +1467,40 @@ sp_app_new(const LilvWorld *world, sp_app_driver_t *driver, void *data)
 	atomic_init(&dsp_master->kill, false);
 	atomic_init(&dsp_master->emergency_exit, false);
 	atomic_init(&dsp_master->xrun_report, false);
+	atomic_init(&dsp_master->replan, false);
+	atomic_init(&dsp_master->reorder, false);
+	atomic_init(&dsp_master->realias, false);
 	sem_init(&dsp_master->sem, 0, 0);
+	atomic_init(&dsp_master->generation, 0);
+	atomic_init(&dsp_master->sleepers, 0);
+	atomic_init(&dsp_master->done, 0);
+#if defined(__linux__)
+	if(driver->slave_spin < 0) // auto: spin for a quarter of a period
+		dsp_master->spin_ns = driver->max_block_size * 250000000ULL / driver->sample_rate;
+	else
+		dsp_master->spin_ns = driver->slave_spin * 1000ULL;
+#else
+	dsp_master->spin_ns = 0; // futex barrier only available on linux
+#endif
 	dsp_master->num_slaves = driver->num_slaves;
+	dsp_master->dsp_slaves = calloc(dsp_master->num_slaves, sizeof(dsp_slave_t));
+	if(!dsp_master->dsp_slaves)
+		dsp_master->num_slaves = 0;
+	_sp_app_topo_plan(app);
+	if(dsp_master->num_slaves > DSP_ACTIVE_MASK)
+		dsp_master->num_slaves = DSP_ACTIVE_MASK; // must fit into generation word
+#if defined(USE_WORK_STEALING)
+	if(posix_memalign((void **)&dsp_master->dsp_deques, CACHE_LINE_SIZE,
+		(dsp_master->num_slaves + 1) * sizeof(dsp_deque_t)))
+	{
+		sp_app_log_error(app, "%s: failed to allocate deques\n", __func__);
+		dsp_master->dsp_deques = NULL;
+		dsp_master->num_slaves = 0; // fall back to serial processing
+	}
+#endif
+	_sp_app_trace_init(app);
+	_sp_app_post_init(app);
+	_sp_app_mod_worker_pool_init(app);
 	dsp_master->concurrent = dsp_master->num_slaves + 1; // this is a safe fallback
 	for(unsigned i=0; i<dsp_master->num_slaves; i++)
 	{
@@ -1014,12 +1520,19 @@ sp_app_new(const LilvWorld *world, sp_app_driver_t *driver, void *data)
 	return app;
 }
 
+int
+sp_app_dsp_cpu(sp_app_t *app)
+{
+	return app->dsp_master.cpu;
+}
+
 void
 sp_app_run_pre(sp_app_t *app, uint32_t nsamples)
 {
 	mod_t *del_me = NULL;
 
 	cross_clock_gettime(&app->clk_mono, &app->prof.t1);
+	app->prof.budget = nsamples * 1000000000ULL / app->driver->sample_rate;
 
 	// iterate over all modules
 	for(unsigned m=0; m<app->num_mods; m++)
@@ -1066,30 +1579,101 @@ sp_app_run_pre(sp_app_t *app, uint32_t nsamples)
 static inline void
 _sp_app_process_serial(sp_app_t *app, uint32_t nsamples, bool sparse_update_timeout)
 {
+	post_t post = {
+		.forge = &app->forge,
+		.to_ui = NULL
+	};
+
 	// iterate over all modules
 	for(unsigned m=0; m<app->num_mods; m++)
 	{
 		mod_t *mod = app->mods[m];
 
-		_sp_app_process_single_run(mod, nsamples);
-		_sp_app_process_single_post(mod, nsamples, sparse_update_timeout);
+		_sp_app_process_single_run(mod, nsamples, 0);
+		_sp_app_process_single_post(mod, &post, nsamples, sparse_update_timeout);
+	}
+}
+
+// forward staged notifications in thread order, e.g. only master talks to driver
+__realtime static void
+_sp_app_post_flush(sp_app_t *app)
+{
+	for(unsigned i=0; i<app->num_posts; i++)
+	{
+		varchunk_t *to_ui = app->posts[i].to_ui;
+		const void *src;
+		size_t size;
+
+		while((src = varchunk_read_request(to_ui, &size)))
+		{
+			void *dst = _sp_app_to_ui_request(app, size);
+			if(dst)
+			{
+				memcpy(dst, src, size);
+				_sp_app_to_ui_advance(app, size);
+			}
+			else
+			{
+				_sp_app_to_ui_overflow(app);
+			}
+
+			varchunk_read_stage(to_ui);
+		}
+
+		varchunk_read_commit(to_ui);
 	}
 }
 
 static inline void
 _sp_app_process_parallel(sp_app_t *app, uint32_t nsamples, bool sparse_update_timeout)
 {
-	_dsp_master_process(app, &app->dsp_master, nsamples);
+	dsp_master_t *dsp_master = &app->dsp_master;
+
+	dsp_master->sparse_update_timeout = sparse_update_timeout;
+	_dsp_master_process(app, dsp_master, nsamples);
+
+	if(app->posts) // modules have been posted by the thread that ran them
+	{
+		_sp_app_post_flush(app);
+		return;
+	}
+
+	post_t post = {
+		.forge = &app->forge,
+		.to_ui = NULL
+	};
 
 	// iterate over all modules
 	for(unsigned m=0; m<app->num_mods; m++)
 	{
 		mod_t *mod = app->mods[m];
 
-		_sp_app_process_single_post(mod, nsamples, sparse_update_timeout);
+		_sp_app_process_single_post(mod, &post, nsamples, sparse_update_timeout);
 	}
 }
 
+// remember the NUMA node the module has been run on most, port pools are
+// bound to it upon their next allocation, never while the graph uses them
+__realtime static inline void
+_sp_app_mod_rebind(mod_t *mod)
+{
+	dsp_client_t *dsp_client = &mod->dsp_client;
+	int node = mod->node_next;
+
+	if( (node < 0) || (node >= MAX_NODES) )
+		node = 0;
+
+	for(int n=0; n<MAX_NODES; n++)
+	{
+		if(dsp_client->node_runs[n] > dsp_client->node_runs[node])
+			node = n;
+	}
+
+	memset(dsp_client->node_runs, 0x0, sizeof(dsp_client->node_runs));
+
+	mod->node_next = node;
+}
+
 void
 sp_app_run_post(sp_app_t *app, uint32_t nsamples)
 {
@@ -1104,6 +1688,10 @@ sp_app_run_post(sp_app_t *app, uint32_t nsamples)
 	}
 
 	dsp_master_t *dsp_master = &app->dsp_master;
+
+	// apply pending rewiring while no module is running
+	_dsp_master_replan(app);
+
 	if( (dsp_master->num_slaves > 0) && (dsp_master->concurrent > 1) ) // parallel processing makes sense here
 	{
 		_sp_app_process_parallel(app, nsamples, sparse_update_timeout);
@@ -1121,6 +1709,7 @@ sp_app_run_post(sp_app_t *app, uint32_t nsamples)
 		+ app_t2.tv_nsec - app->prof.t1.tv_nsec;
 	app->prof.sum += run_time;
 	app->prof.count += 1;
+	_sp_app_hist_add(&app->prof.hist, run_time, app->prof.budget);
 
 	if(run_time < app->prof.min)
 		app->prof.min = run_time;
@@ -1135,12 +1724,15 @@ sp_app_run_post(sp_app_t *app, uint32_t nsamples)
 		reset_parallelizer = true;
 	}
 
-	if(atomic_exchange(&dsp_master->xrun_report, false))
+	const bool xrun = atomic_exchange(&dsp_master->xrun_report, false);
+	if(xrun)
 	{
 		sp_app_log_trace(app, "%s: Xruns reported\n", __func__);
 		reset_parallelizer = true;
 	}
 
+	_sp_app_trace_schedule(app, nsamples, xrun);
+
 	if(reset_parallelizer)
 	{
 		app->dsp_master.concurrent = dsp_master->num_slaves + 1; // spin up all cores
@@ -1158,6 +1750,7 @@ sp_app_run_post(sp_app_t *app, uint32_t nsamples)
 			mod->prof.min = 0;
 			mod->prof.sum= 0;
 			mod->prof.max= 0;
+			mod->prof.post = 0;
 		}
 	}
 
@@ -1261,7 +1854,7 @@ sp_app_run_post(sp_app_t *app, uint32_t nsamples)
 			mod_t *mod = app->mods[m];
 
 			const float mod_min = mod->prof.min * app->prof.count * tot_time_1;
-			const float mod_avg = mod->prof.sum * tot_time_1;
+			const float mod_avg = (mod->prof.sum + mod->prof.post) * tot_time_1; // inclusive ui post
 			const float mod_max = mod->prof.max * app->prof.count * tot_time_1;
 
 			// to nk
@@ -1292,29 +1885,63 @@ sp_app_run_post(sp_app_t *app, uint32_t nsamples)
 				_sp_app_to_ui_overflow(app);
 			}
 
+			mod->dsp_client.cost = mod->prof.sum;
+
+			if(dsp_master->num_nodes > 1)
+			{
+				_sp_app_mod_rebind(mod);
+			}
 			mod->prof.min = UINT_MAX;
 			mod->prof.max = 0;
 			mod->prof.sum = 0;
+			mod->prof.post = 0;
 		}
 
+		// reprioritize critical path with updated weights
+		_dsp_master_rank(app);
+
+		// tail latencies from cumulative histograms
+		_sp_app_stats_report(app);
+
 		{
 			const float app_min = app->prof.min * app->prof.count * tot_time_1;
 			const float app_avg = app->prof.sum * tot_time_1;
 			const float app_max = app->prof.max * app->prof.count * tot_time_1;
 
+			// wake-to-run latency of slaves in us
+			uint64_t wake_sum = 0;
+			unsigned wake_count = 0;
+			unsigned wake_max = 0;
+
+			for(unsigned i=0; i<dsp_master->num_slaves; i++)
+			{
+				dsp_slave_t *dsp_slave = &dsp_master->dsp_slaves[i];
+
+				wake_sum += dsp_slave->wake_sum;
+				wake_count += dsp_slave->wake_count;
+				if(dsp_slave->wake_max > wake_max)
+					wake_max = dsp_slave->wake_max;
+
+				dsp_slave->wake_sum = 0;
+				dsp_slave->wake_count = 0;
+				dsp_slave->wake_max = 0;
+			}
+
+			const float wake_avg = wake_count ? wake_sum * 1e-3f / wake_count : 0.f;
+
 			// to nk
 			LV2_Atom *answer = _sp_app_to_ui_request_atom(app);
 			if(answer)
 			{
 				const float vec [] = {
-					app_min, app_avg, app_max
+					app_min, app_avg, app_max, wake_avg, wake_max * 1e-3f
 				};
 
 				LV2_Atom_Forge_Frame frame [1];
 				LV2_Atom_Forge_Ref ref = synthpod_patcher_set_object(
 					&app->regs, &app->forge, &frame[0], 0, 0, app->regs.synthpod.dsp_profiling.urid); //TODO subj, seqn
 				if(ref)
-					ref = lv2_atom_forge_vector(&app->forge, sizeof(float), app->forge.Float, 3, vec);
+					ref = lv2_atom_forge_vector(&app->forge, sizeof(float), app->forge.Float, 5, vec);
 				if(ref)
 				{
 					synthpod_patcher_pop(&app->forge, frame, 1);
@@ -1365,11 +1992,14 @@ sp_app_free(sp_app_t *app)
 	if(!app)
 		return;
 
+	// finish pending session save
+	_sp_app_state_writer_join(app);
+
 	// deinit parallel processing
 	dsp_master_t *dsp_master = &app->dsp_master;
 	atomic_store(&dsp_master->kill, true);
 	//printf("finish\n");
-	_dsp_master_post(dsp_master, dsp_master->num_slaves);
+	_dsp_master_post(app, dsp_master, dsp_master->num_slaves);
 	_dsp_master_wait(app, dsp_master, dsp_master->num_slaves);
 
 	for(unsigned i=0; i<dsp_master->num_slaves; i++)
@@ -1381,13 +2011,25 @@ sp_app_free(sp_app_t *app)
 		sem_destroy(&dsp_slave->sem);
 	}
 	sem_destroy(&dsp_master->sem);
+	free(dsp_master->dsp_slaves);
+#if defined(USE_WORK_STEALING)
+	free(dsp_master->dsp_deques);
+#endif
 
 	// free mods
 	for(unsigned m=0; m<app->num_mods; m++)
 		_sp_app_mod_del(app, app->mods[m]);
 
+	_sp_app_mod_worker_pool_deinit(app);
+
+	_sp_app_arena_deinit(app);
+	_sp_app_trace_deinit(app);
+	_sp_app_post_deinit(app);
+
 	sp_regs_deinit(&app->regs);
 
+	_sp_app_index_deinit(app);
+
 	if(!app->embedded)
 		lilv_world_free(app->world);
 
@@ -1437,6 +2079,9 @@ _sp_app_reinitialize(sp_app_t *app)
 		_sp_app_mod_reinitialize(mod);
 	}
 
+	// resize shared buffers to new block size, pools have been resliced
+	_sp_app_arena_resize(app);
+
 	// refresh all connections
 	for(unsigned m=0; m<app->num_mods; m++)
 	{
@@ -1447,7 +2092,7 @@ _sp_app_reinitialize(sp_app_t *app)
 			port_t *tar = &mod->ports[i];
 
 			// set port buffer
-			lilv_instance_connect_port(mod->inst, i, tar->base);
+			lilv_instance_connect_port(mod->inst, i, PORT_BUFFER(tar));
 		}
 
 		lilv_instance_activate(mod->inst);
@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <sys/mman.h>
+
+#include <synthpod_app_private.h>
+#include <synthpod_patcher.h>
+
+static inline void
+_mod_set_clear(mod_set_t *set)
+{
+	memset(set->bits, 0x0, sizeof(set->bits));
+}
+
+static inline void
+_mod_set_add(mod_set_t *set, unsigned idx)
+{
+	set->bits[idx / 64] |= 1ULL << (idx % 64);
+}
+
+static inline bool
+_mod_set_has(const mod_set_t *set, unsigned idx)
+{
+	return set->bits[idx / 64] & (1ULL << (idx % 64));
+}
+
+static inline void
+_mod_set_or(mod_set_t *dst, const mod_set_t *src)
+{
+	for(unsigned i=0; i<MAX_MODS/64; i++)
+		dst->bits[i] |= src->bits[i];
+}
+
+static inline void
+_mod_set_and(mod_set_t *dst, const mod_set_t *src)
+{
+	for(unsigned i=0; i<MAX_MODS/64; i++)
+		dst->bits[i] &= src->bits[i];
+}
+
+static inline bool
+_arena_port_candidate(port_t *port)
+{
+	return (port->type == PORT_TYPE_AUDIO) || (port->type == PORT_TYPE_CV);
+}
+
+// whether module at position m reads from port at position i
+static inline bool
+_arena_port_reads(const arena_graph_t *graph, unsigned m, unsigned i)
+{
+	const arena_mod_t *amod = &graph->mods[m];
+
+	for(unsigned p=amod->ports; p<amod->ports + amod->num_ports; p++)
+	{
+		const arena_port_t *aport = &graph->ports[p];
+
+		if(aport->output)
+			continue;
+
+		for(unsigned e=aport->sources; e<aport->sources + aport->num_sources; e++)
+		{
+			if(graph->edges[e] == i)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+__non_realtime static void
+_arena_buf_alloc(sp_app_t *app)
+{
+	arena_t *arena = &app->arena;
+
+	arena->slot_size = lv2_atom_pad_size(app->driver->max_block_size * sizeof(float));
+	arena->slot_size = (arena->slot_size + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+	arena->size = arena->slot_size * ARENA_SLOTS;
+
+	if(posix_memalign(&arena->buf, CACHE_LINE_SIZE, arena->size))
+	{
+		sp_app_log_error(app, "%s: posix_memalign failed\n", __func__);
+		arena->buf = NULL;
+		return;
+	}
+
+	memset(arena->buf, 0x0, arena->size);
+
+	if(mlock(arena->buf, arena->size))
+		sp_app_log_trace(app, "%s: mlock failed\n", __func__);
+}
+
+__non_realtime static void
+_arena_buf_free(sp_app_t *app)
+{
+	arena_t *arena = &app->arena;
+
+	if(arena->buf)
+	{
+		munlock(arena->buf, arena->size);
+		free(arena->buf);
+		arena->buf = NULL;
+	}
+}
+
+__non_realtime void
+_sp_app_arena_init(sp_app_t *app)
+{
+	arena_t *arena = &app->arena;
+
+	arena->saved = 0;
+	arena->epoch = 0;
+	arena->planning = false;
+	arena->pending = false;
+
+	// snapshot is written by master, thus keep it resident
+	if(posix_memalign((void **)&arena->graph, CACHE_LINE_SIZE, sizeof(arena_graph_t)))
+	{
+		sp_app_log_error(app, "%s: posix_memalign failed\n", __func__);
+		arena->graph = NULL;
+		return;
+	}
+
+	memset(arena->graph, 0x0, sizeof(arena_graph_t));
+
+	if(mlock(arena->graph, sizeof(arena_graph_t)))
+		sp_app_log_trace(app, "%s: mlock failed\n", __func__);
+
+	_arena_buf_alloc(app);
+}
+
+__non_realtime void
+_sp_app_arena_deinit(sp_app_t *app)
+{
+	arena_t *arena = &app->arena;
+
+	_arena_buf_free(app);
+
+	if(arena->graph)
+	{
+		munlock(arena->graph, sizeof(arena_graph_t));
+		free(arena->graph);
+		arena->graph = NULL;
+	}
+}
+
+// resize shared buffers to new block size, ports must point to their pools
+__non_realtime void
+_sp_app_arena_resize(sp_app_t *app)
+{
+	_arena_buf_free(app);
+	_arena_buf_alloc(app);
+
+	// a plan in flight refers to the old slot size, replan at next cycle
+	atomic_store(&app->dsp_master.replan, true);
+}
+
+__realtime bool
+_sp_app_arena_owns(sp_app_t *app, const void *ptr)
+{
+	arena_t *arena = &app->arena;
+
+	return arena->buf
+		&& (ptr >= arena->buf)
+		&& (ptr < arena->buf + arena->size);
+}
+
+// copy audio/CV ports and their connections for the planner, false if too large
+__realtime static bool
+_arena_snapshot(sp_app_t *app)
+{
+	arena_t *arena = &app->arena;
+	arena_graph_t *graph = arena->graph;
+
+	graph->num_mods = app->num_mods;
+	graph->num_links = 0;
+	graph->num_ports = 0;
+	graph->num_edges = 0;
+
+	for(unsigned m=0; m<app->num_mods; m++)
+		app->mods[m]->dsp_client.idx = m;
+
+	for(unsigned m=0; m<app->num_mods; m++)
+	{
+		mod_t *mod = app->mods[m];
+		dsp_client_t *dsp_client = &mod->dsp_client;
+		arena_mod_t *amod = &graph->mods[m];
+
+		if(graph->num_links + dsp_client->num_sinks > ARENA_LINKS)
+			return false;
+
+		amod->links = graph->num_links;
+		amod->num_links = dsp_client->num_sinks;
+
+		for(unsigned j=0; j<dsp_client->num_sinks; j++)
+			graph->links[graph->num_links++] = dsp_client->sinks[j]->idx;
+
+		amod->ports = graph->num_ports;
+
+		for(unsigned p=0; p<mod->num_ports; p++)
+		{
+			port_t *port = &mod->ports[p];
+
+			port->arena_idx = -1;
+
+			if(!_arena_port_candidate(port))
+				continue;
+
+			if(graph->num_ports == ARENA_PORTS)
+				return false;
+
+			port->arena_idx = graph->num_ports;
+
+			arena_port_t *aport = &graph->ports[graph->num_ports++];
+			aport->port = port;
+			aport->mod = m;
+			aport->size = port->size;
+			aport->output = (port->direction == PORT_DIRECTION_OUTPUT);
+			aport->pinned = mod->system_ports // driver accesses buffers outside of graph
+				|| port->subscriptions // ui reads buffer after all modules have run
+				|| port->alias // plugin reads from source buffer anyway
+				|| (port->size > arena->slot_size);
+			aport->sources = 0;
+			aport->num_sources = 0;
+			aport->slot = -1;
+		}
+
+		amod->num_ports = graph->num_ports - amod->ports;
+	}
+
+	for(unsigned i=0; i<graph->num_ports; i++)
+	{
+		arena_port_t *aport = &graph->ports[i];
+
+		if(aport->output)
+			continue;
+
+		connectable_t *conn = _sp_app_port_connectable(aport->port);
+
+		if(graph->num_edges + conn->num_sources > ARENA_EDGES)
+			return false;
+
+		aport->sources = graph->num_edges;
+
+		for(int s=0; s<conn->num_sources; s++)
+		{
+			const int idx = conn->sources[s].port->arena_idx;
+
+			if(idx >= 0)
+				graph->edges[graph->num_edges++] = idx;
+		}
+
+		aport->num_sources = graph->num_edges - aport->sources;
+	}
+
+	return true;
+}
+
+// put all audio/CV ports back onto their pools, as the graph has changed
+__realtime static void
+_arena_release(sp_app_t *app)
+{
+	bool released = false;
+
+	for(unsigned m=0; m<app->num_mods; m++)
+	{
+		mod_t *mod = app->mods[m];
+
+		for(unsigned p=0; p<mod->num_ports; p++)
+		{
+			port_t *port = &mod->ports[p];
+
+			if(!_arena_port_candidate(port) || (port->base == port->pool_base) )
+				continue;
+
+			port->base = port->pool_base;
+			released = true;
+		}
+	}
+
+	if(!released)
+		return;
+
+	// reconnect all, inclusive zero-copy aliases of released sources
+	for(unsigned m=0; m<app->num_mods; m++)
+	{
+		mod_t *mod = app->mods[m];
+
+		for(unsigned p=0; p<mod->num_ports; p++)
+		{
+			port_t *port = &mod->ports[p];
+
+			if(_arena_port_candidate(port))
+				lilv_instance_connect_port(mod->inst, p, PORT_BUFFER(port));
+		}
+	}
+}
+
+// called by master at cycle boundary upon graph changes
+__realtime void
+_sp_app_arena_request(sp_app_t *app)
+{
+	arena_t *arena = &app->arena;
+
+	_arena_release(app);
+	arena->epoch += 1;
+
+	if(!arena->buf || !arena->graph)
+		return;
+
+	if(arena->planning)
+	{
+		arena->pending = true; // worker still owns snapshot, request again on reply
+		return;
+	}
+
+	if(!_arena_snapshot(app))
+	{
+		sp_app_log_trace(app, "%s: graph too large to share buffers\n", __func__);
+		return;
+	}
+
+	job_t *job = _sp_app_to_worker_request(app, sizeof(job_t));
+	if(!job)
+	{
+		sp_app_log_trace(app, "%s: buffer request failed\n", __func__);
+		return;
+	}
+
+	job->request = JOB_TYPE_REQUEST_ARENA_PLAN;
+	job->status = arena->epoch;
+	_sp_app_to_worker_advance(app, sizeof(job_t));
+
+	arena->planning = true;
+}
+
+/*
+ * assign audio/CV port buffers to shared arena slots, a slot may be reused
+ * once all modules reading or writing its previous port are guaranteed to
+ * have run, e.g. when the new writer is a DAG descendant of all of them.
+ * runs on worker and only touches the snapshot taken by master.
+ */
+__non_realtime void
+_sp_app_arena_plan(sp_app_t *app)
+{
+	arena_t *arena = &app->arena;
+	arena_graph_t *graph = arena->graph;
+
+	// derive reachability in reverse topological order
+	for(int m=graph->num_mods - 1; m>=0; m--)
+	{
+		const arena_mod_t *amod = &graph->mods[m];
+		mod_set_t *reach = &graph->reach[m];
+
+		_mod_set_clear(reach);
+
+		for(unsigned l=amod->links; l<amod->links + amod->num_links; l++)
+		{
+			const unsigned sink = graph->links[l];
+
+			_mod_set_add(reach, sink);
+			_mod_set_or(reach, &graph->reach[sink]);
+		}
+	}
+
+	// ports read before being written in a cycle need to keep their contents
+	for(unsigned i=0; i<graph->num_ports; i++)
+	{
+		const arena_port_t *aport = &graph->ports[i];
+
+		for(unsigned e=aport->sources; e<aport->sources + aport->num_sources; e++)
+		{
+			arena_port_t *src = &graph->ports[graph->edges[e]];
+
+			if(src->mod >= aport->mod) // backwards edge
+				src->pinned = true;
+		}
+	}
+
+	unsigned num_slots = 0;
+	size_t shared = 0;
+
+	for(unsigned i=0; i<graph->num_ports; i++)
+	{
+		arena_port_t *aport = &graph->ports[i];
+		const arena_mod_t *amod = &graph->mods[aport->mod];
+
+		aport->slot = -1; // fall back to module pool
+
+		if(aport->pinned)
+			continue;
+
+		// modules which may reuse buffer after this port
+		mod_set_t after = graph->reach[aport->mod];
+
+		if(aport->output)
+		{
+			for(unsigned l=amod->links; l<amod->links + amod->num_links; l++)
+			{
+				const unsigned sink = graph->links[l];
+
+				if(_arena_port_reads(graph, sink, i))
+					_mod_set_and(&after, &graph->reach[sink]);
+			}
+		}
+
+		// find slot whose previous users all precede this module
+		unsigned slot;
+		for(slot=0; slot<num_slots; slot++)
+		{
+			if(_mod_set_has(&graph->after[slot], aport->mod))
+				break;
+		}
+
+		if(slot == num_slots)
+		{
+			if(num_slots == ARENA_SLOTS)
+				continue; // arena exhausted
+
+			num_slots += 1;
+		}
+
+		graph->after[slot] = after;
+		aport->slot = slot;
+		shared += lv2_atom_pad_size(aport->size);
+	}
+
+	graph->saved = shared - num_slots*arena->slot_size;
+}
+
+// called by master upon reply from worker, swaps planned buffers in
+__realtime void
+_sp_app_arena_apply(sp_app_t *app, unsigned epoch)
+{
+	arena_t *arena = &app->arena;
+	arena_graph_t *graph = arena->graph;
+
+	arena->planning = false;
+
+	if(arena->pending)
+	{
+		arena->pending = false;
+		_sp_app_arena_request(app); // plan is stale, graph has changed since
+
+		return;
+	}
+
+	if(  (epoch != arena->epoch)
+		|| atomic_load(&app->dsp_master.replan) // graph has changed this cycle
+		|| !arena->buf )
+	{
+		return;
+	}
+
+	// reconnect all, inclusive zero-copy aliases
+	for(unsigned i=0; i<graph->num_ports; i++)
+	{
+		const arena_port_t *aport = &graph->ports[i];
+		port_t *port = aport->port;
+
+		port->base = (aport->slot >= 0)
+			? arena->buf + aport->slot*arena->slot_size
+			: port->pool_base;
+
+		lilv_instance_connect_port(port->mod->inst, port->index, PORT_BUFFER(port));
+	}
+
+	const int64_t saved = graph->saved;
+	if(saved == arena->saved)
+		return;
+
+	arena->saved = saved;
+
+	// to nk
+	LV2_Atom *answer = _sp_app_to_ui_request_atom(app);
+	if(answer)
+	{
+		LV2_Atom_Forge_Ref ref = synthpod_patcher_set(
+			&app->regs, &app->forge, 0, 0, app->regs.synthpod.buffer_saved.urid,
+			sizeof(int64_t), app->forge.Long, &saved); //TODO subj, seqn
+		if(ref)
+		{
+			_sp_app_to_ui_advance_atom(app, answer);
+		}
+		else
+		{
+			_sp_app_to_ui_overflow(app);
+		}
+	}
+	else
+	{
+		_sp_app_to_ui_overflow(app);
+	}
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <synthpod_app_private.h>
+
+// the index itself is shared with the UI, see synthpod_index.h
+
+void
+_sp_app_index_init(sp_app_t *app)
+{
+	index_t *index = &app->index;
+
+	const int ret = synthpod_index_init(index, app->world, app->dir.home);
+
+	if(ret == 1)
+		sp_app_log_error(app, "%s: failed to write plugin index\n", __func__);
+
+	if(ret == -1)
+		sp_app_log_error(app, "%s: failed to build plugin index\n", __func__);
+	else if(index->lazy)
+		sp_app_log_note(app, "%s: using plugin index with %u plugins\n", __func__, index->num_plugs);
+	else
+		sp_app_log_note(app, "%s: rebuilt plugin index with %u plugins\n", __func__, index->num_plugs);
+}
+
+void
+_sp_app_index_deinit(sp_app_t *app)
+{
+	synthpod_index_deinit(&app->index);
+}
+
+bool
+_sp_app_index_rebuild(sp_app_t *app)
+{
+	index_t *index = &app->index;
+
+	if(!index->lazy)
+		return false; // world is loaded in full already
+
+	sp_app_log_note(app, "%s: not in plugin index, discovering all bundles\n", __func__);
+
+	const int ret = synthpod_index_rebuild(index, app->world, app->dir.home);
+
+	if(ret == 1)
+		sp_app_log_error(app, "%s: failed to write plugin index\n", __func__);
+	else if(ret == -1)
+		sp_app_log_error(app, "%s: failed to build plugin index\n", __func__);
+
+	return true;
+}
+
+const index_plug_t *
+_sp_app_index_plug_get(sp_app_t *app, const char *uri)
+{
+	return synthpod_index_plug_get(&app->index, uri);
+}
+
+void
+_sp_app_index_plug_load(sp_app_t *app, const index_plug_t *plug)
+{
+	synthpod_index_plug_load(&app->index, app->world, plug);
+}
+
+void
+_sp_app_index_preset_load(sp_app_t *app, const char *uri)
+{
+	// preset saved or installed after index was built
+	if(!synthpod_index_preset_load(&app->index, app->world, uri))
+		_sp_app_index_rebuild(app);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <synthpod_app_private.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#	include <immintrin.h>
+#	define MIX_X86
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#	include <arm_neon.h>
+#	define MIX_NEON
+#endif
+
+/*
+ * all kernels compute for up to MIX_MAX sources:
+ *   dst[j] = (clear ? 0 : dst[j]) + sum_k src[k][j] * (g0[k] + dg[k]*j)
+ */
+
+__realtime static inline float
+_mix_sample(const float *const *src, const float *g0, const float *dg,
+	unsigned nsrc, float acc, uint32_t j)
+{
+	for(unsigned k=0; k<nsrc; k++)
+		acc += src[k][j] * (g0[k] + dg[k]*j);
+
+	return acc;
+}
+
+__realtime static void
+_mix_scalar(float *dst, const float *const *src, const float *g0, const float *dg,
+	unsigned nsrc, bool clear, uint32_t nsamples)
+{
+	for(uint32_t j=0; j<nsamples; j++)
+		dst[j] = _mix_sample(src, g0, dg, nsrc, clear ? 0.f : dst[j], j);
+}
+
+#if defined(MIX_X86)
+__realtime static void
+_mix_sse(float *dst, const float *const *src, const float *g0, const float *dg,
+	unsigned nsrc, bool clear, uint32_t nsamples)
+{
+	const __m128 iota = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+	__m128 vg0 [MIX_MAX];
+	__m128 vdg [MIX_MAX];
+
+	for(unsigned k=0; k<nsrc; k++)
+	{
+		vg0[k] = _mm_set1_ps(g0[k]);
+		vdg[k] = _mm_set1_ps(dg[k]);
+	}
+
+	uint32_t j = 0;
+	for( ; j + 4 <= nsamples; j += 4)
+	{
+		const __m128 idx = _mm_add_ps(_mm_set1_ps(j), iota);
+		__m128 acc = clear ? _mm_setzero_ps() : _mm_loadu_ps(&dst[j]);
+
+		for(unsigned k=0; k<nsrc; k++)
+		{
+			const __m128 gain = _mm_add_ps(vg0[k], _mm_mul_ps(vdg[k], idx));
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(&src[k][j]), gain));
+		}
+
+		_mm_storeu_ps(&dst[j], acc);
+	}
+
+	for( ; j<nsamples; j++)
+		dst[j] = _mix_sample(src, g0, dg, nsrc, clear ? 0.f : dst[j], j);
+}
+
+__attribute__((target("avx2,fma")))
+__realtime static void
+_mix_avx2(float *dst, const float *const *src, const float *g0, const float *dg,
+	unsigned nsrc, bool clear, uint32_t nsamples)
+{
+	const __m256 iota = _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+	__m256 vg0 [MIX_MAX];
+	__m256 vdg [MIX_MAX];
+
+	for(unsigned k=0; k<nsrc; k++)
+	{
+		vg0[k] = _mm256_set1_ps(g0[k]);
+		vdg[k] = _mm256_set1_ps(dg[k]);
+	}
+
+	uint32_t j = 0;
+	for( ; j + 8 <= nsamples; j += 8)
+	{
+		const __m256 idx = _mm256_add_ps(_mm256_set1_ps(j), iota);
+		__m256 acc = clear ? _mm256_setzero_ps() : _mm256_loadu_ps(&dst[j]);
+
+		for(unsigned k=0; k<nsrc; k++)
+		{
+			const __m256 gain = _mm256_fmadd_ps(vdg[k], idx, vg0[k]);
+			acc = _mm256_fmadd_ps(_mm256_loadu_ps(&src[k][j]), gain, acc);
+		}
+
+		_mm256_storeu_ps(&dst[j], acc);
+	}
+
+	for( ; j<nsamples; j++)
+		dst[j] = _mix_sample(src, g0, dg, nsrc, clear ? 0.f : dst[j], j);
+}
+#endif
+
+#if defined(MIX_NEON)
+__realtime static void
+_mix_neon(float *dst, const float *const *src, const float *g0, const float *dg,
+	unsigned nsrc, bool clear, uint32_t nsamples)
+{
+	const float iota_f [4] = {0.f, 1.f, 2.f, 3.f};
+	const float32x4_t iota = vld1q_f32(iota_f);
+	float32x4_t vg0 [MIX_MAX];
+	float32x4_t vdg [MIX_MAX];
+
+	for(unsigned k=0; k<nsrc; k++)
+	{
+		vg0[k] = vdupq_n_f32(g0[k]);
+		vdg[k] = vdupq_n_f32(dg[k]);
+	}
+
+	uint32_t j = 0;
+	for( ; j + 4 <= nsamples; j += 4)
+	{
+		const float32x4_t idx = vaddq_f32(vdupq_n_f32(j), iota);
+		float32x4_t acc = clear ? vdupq_n_f32(0.f) : vld1q_f32(&dst[j]);
+
+		for(unsigned k=0; k<nsrc; k++)
+		{
+			const float32x4_t gain = vmlaq_f32(vg0[k], vdg[k], idx);
+			acc = vmlaq_f32(acc, vld1q_f32(&src[k][j]), gain);
+		}
+
+		vst1q_f32(&dst[j], acc);
+	}
+
+	for( ; j<nsamples; j++)
+		dst[j] = _mix_sample(src, g0, dg, nsrc, clear ? 0.f : dst[j], j);
+}
+#endif
+
+__non_realtime mix_cb_t
+_sp_app_mix_dispatch(void)
+{
+#if defined(MIX_X86)
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return _mix_avx2;
+	if(__builtin_cpu_supports("sse"))
+		return _mix_sse;
+#elif defined(MIX_NEON)
+	return _mix_neon;
+#endif
+
+	return _mix_scalar;
+}
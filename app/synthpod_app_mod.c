@@ -17,6 +17,7 @@
 
 #include <inttypes.h>
 #include <unistd.h>
+#include <sched.h>
 
 #include <synthpod_app_private.h>
 
@@ -108,11 +109,12 @@ _schedule_work(LV2_Worker_Schedule_Handle handle, uint32_t size, const void *dat
 	mod_worker_t *mod_worker = &mod->mod_worker;
 
 	void *target;
-	if((target = varchunk_write_request(mod_worker->app_to_worker, size)))
+	if(  mod_worker->app_to_worker
+		&& (target = varchunk_write_request(mod_worker->app_to_worker, size)) )
 	{
 		memcpy(target, data, size);
 		varchunk_write_advance(mod_worker->app_to_worker, size);
-		sem_post(&mod_worker->sem);
+		_sp_app_mod_worker_signal(mod);
 
 		return LV2_WORKER_SUCCESS;
 	}
@@ -151,12 +153,23 @@ _mod_make_path(LV2_State_Make_Path_Handle instance, const char *abstract_path)
 }
 
 static inline int
-_sp_app_mod_alloc_pool(pool_t *pool)
+_sp_app_mod_alloc_pool(sp_app_t *app, pool_t *pool)
 {
 #if defined(_WIN32)
+	(void)app;
 	pool->buf = _aligned_malloc(pool->size, 8);
 #else
-	posix_memalign(&pool->buf, 8, pool->size);
+	size_t align = 8;
+
+	// whole pages on NUMA machines, e.g. binding never moves pages of other modules
+	if(app->dsp_master.num_nodes > 1)
+	{
+		align = sysconf(_SC_PAGESIZE);
+		pool->size = (pool->size + align - 1) & ~(align - 1);
+	}
+
+	if(posix_memalign(&pool->buf, align, pool->size))
+		pool->buf = NULL;
 #endif
 	if(pool->buf)
 	{
@@ -195,6 +208,7 @@ _sp_app_mod_slice_pool(mod_t *mod, port_type_t type)
 
 			// define buffer slice
 			tar->base = ptr;
+			tar->pool_base = ptr;
 
 			// initialize control buffers to default value
 			if(tar->type == PORT_TYPE_CONTROL)
@@ -249,8 +263,13 @@ _sp_app_mod_reinitialize(mod_t *mod)
 		}
 	}
 	
-	_sp_app_mod_alloc_pool(&mod->pools[PORT_TYPE_AUDIO]);
-	_sp_app_mod_alloc_pool(&mod->pools[PORT_TYPE_CV]);
+	_sp_app_mod_alloc_pool(app, &mod->pools[PORT_TYPE_AUDIO]);
+	_sp_app_mod_alloc_pool(app, &mod->pools[PORT_TYPE_CV]);
+
+	// graph is halted, so move all pools to where the module has run most
+	mod->node = mod->node_next;
+	if(app->dsp_master.num_nodes > 1)
+		_sp_app_topo_migrate(app, mod);
 
 	_sp_app_mod_slice_pool(mod, PORT_TYPE_AUDIO);
 	_sp_app_mod_slice_pool(mod, PORT_TYPE_CV);
@@ -343,6 +362,18 @@ _sp_app_mod_features_populate(sp_app_t *app, mod_t *mod)
 	return nfeatures;
 }
 
+static bool
+_sp_app_mod_has_feature(mod_t *mod, int nfeatures, const char *uri)
+{
+	for(int f=0; f<nfeatures; f++)
+	{
+		if(!strcmp(mod->feature_list[f].URI, uri))
+			return true;
+	}
+
+	return false;
+}
+
 static const LilvPlugin *
 _sp_app_mod_is_supported(sp_app_t *app, const char *uri)
 {
@@ -354,54 +385,41 @@ _sp_app_mod_is_supported(sp_app_t *app, const char *uri)
 	}
 
 	const LilvPlugin *plug = lilv_plugins_get_by_uri(app->plugs, uri_node);
-	lilv_node_free(uri_node);
-			
-	if(!plug)
+	const index_plug_t *index_plug = _sp_app_index_plug_get(app, uri);
+	if(!plug && !index_plug && _sp_app_index_rebuild(app)) // installed after index was built
+	{
+		index_plug = _sp_app_index_plug_get(app, uri);
+		plug = lilv_plugins_get_by_uri(app->plugs, uri_node);
+	}
+
+	if(!plug && !index_plug)
 	{
 		sp_app_log_trace(app, "%s: failed to get plugin\n", __func__);
+		lilv_node_free(uri_node);
 		return NULL;
 	}
 
-	const LilvNode *library_uri= lilv_plugin_get_library_uri(plug);
-	if(!library_uri)
+	// checks are done on the index if possible, bundles are loaded only for supported plugins
+	const bool has_library = index_plug
+		? index_plug->library != NULL
+		: lilv_plugin_get_library_uri(plug) != NULL;
+	if(!has_library)
 	{
 		sp_app_log_trace(app, "%s: failed to get library URI\n", __func__);
+		lilv_node_free(uri_node);
 		return NULL;
 	}
 
 	if(!app->driver->bad_plugins)
 	{
-		// check whether DSP and UI code is mixed into same binary
-		bool mixed_binary = false;
-		LilvUIs *all_uis = lilv_plugin_get_uis(plug);
-		if(all_uis)
-		{
-			LILV_FOREACH(uis, ptr, all_uis)
-			{
-				const LilvUI *ui = lilv_uis_get(all_uis, ptr);
-				if(!ui)
-					continue;
-
-				const LilvNode *ui_uri_node = lilv_ui_get_uri(ui);
-				if(!ui_uri_node)
-					continue;
-				
-				// nedded if ui ttl referenced via rdfs#seeAlso
-				lilv_world_load_resource(app->world, ui_uri_node);
-		
-				const LilvNode *ui_library_uri= lilv_ui_get_binary_uri(ui);
-				if(ui_library_uri && lilv_node_equals(library_uri, ui_library_uri))
-					mixed_binary = true; // this is bad, we don't support that
-
-				lilv_world_unload_resource(app->world, ui_uri_node);
-			}
-
-			lilv_uis_free(all_uis);
-		}
+		const bool mixed_binary = index_plug
+			? index_plug->mixed_binary
+			: synthpod_index_mixed_binary(app->world, plug);
 
 		if(mixed_binary)
 		{
 			sp_app_log_error(app, "%s: <%s> NOT supported: mixes DSP and UI code in same binary.\n", __func__, uri);
+			lilv_node_free(uri_node);
 			return NULL;
 		}
 	}
@@ -411,34 +429,53 @@ _sp_app_mod_is_supported(sp_app_t *app, const char *uri)
 	const int nfeatures = _sp_app_mod_features_populate(app, &mod);
 
 	// check for missing features
-	int missing_required_feature = 0;
-	LilvNodes *required_features = lilv_plugin_get_required_features(plug);
-	if(required_features)
+	bool missing_required_feature = false;
+	if(index_plug)
 	{
-		LILV_FOREACH(nodes, i, required_features)
+		for(unsigned i = 0; i < index_plug->num_features; i++)
 		{
-			const LilvNode* required_feature = lilv_nodes_get(required_features, i);
-			const char *required_feature_uri = lilv_node_as_uri(required_feature);
-			missing_required_feature = 1;
+			const char *required_feature_uri = index_plug->features[i];
 
-			for(int f=0; f<nfeatures; f++)
-			{
-				if(!strcmp(mod.feature_list[f].URI, required_feature_uri))
-				{
-					missing_required_feature = 0;
-					break;
-				}
-			}
-
-			if(missing_required_feature)
+			if(!_sp_app_mod_has_feature(&mod, nfeatures, required_feature_uri))
 			{
 				sp_app_log_error(app, "%s: <%s> NOT supported: requires feature <%s>\n",
 					__func__, uri, required_feature_uri);
+				missing_required_feature = true;
 				break;
 			}
 		}
-		lilv_nodes_free(required_features);
 	}
+	else
+	{
+		LilvNodes *required_features = lilv_plugin_get_required_features(plug);
+		if(required_features)
+		{
+			LILV_FOREACH(nodes, i, required_features)
+			{
+				const LilvNode* required_feature = lilv_nodes_get(required_features, i);
+				const char *required_feature_uri = lilv_node_as_uri(required_feature);
+
+				if(!_sp_app_mod_has_feature(&mod, nfeatures, required_feature_uri))
+				{
+					sp_app_log_error(app, "%s: <%s> NOT supported: requires feature <%s>\n",
+						__func__, uri, required_feature_uri);
+					missing_required_feature = true;
+					break;
+				}
+			}
+			lilv_nodes_free(required_features);
+		}
+	}
+
+	if(!missing_required_feature && !plug) // bundles not loaded yet
+	{
+		_sp_app_index_plug_load(app, index_plug);
+		plug = lilv_plugins_get_by_uri(app->plugs, uri_node);
+
+		if(!plug)
+			sp_app_log_trace(app, "%s: failed to get plugin\n", __func__);
+	}
+	lilv_node_free(uri_node);
 
 	if(missing_required_feature)
 		return NULL;
@@ -509,28 +546,115 @@ _sp_app_mod_worker_work_async(mod_t *mod, size_t size, const void *payload)
 	}
 }
 
-__non_realtime static void *
-_mod_worker_thread(void *data)
+// bounded lock-free MPMC queue after D. Vyukov, RT-safe on the producer side
+__realtime static bool
+_worker_pool_push(worker_pool_t *pool, mod_t *mod)
+{
+	unsigned pos = atomic_load_explicit(&pool->tail, memory_order_relaxed);
+	worker_slot_t *slot;
+
+	while(true)
+	{
+		slot = &pool->slots[pos & (MAX_MODS - 1)];
+		const unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+		const int dif = (int)(seq - pos);
+
+		if(dif == 0)
+		{
+			if(atomic_compare_exchange_weak_explicit(&pool->tail, &pos, pos + 1,
+					memory_order_relaxed, memory_order_relaxed))
+				break;
+		}
+		else if(dif < 0)
+		{
+			return false; // full
+		}
+		else
+		{
+			pos = atomic_load_explicit(&pool->tail, memory_order_relaxed);
+		}
+	}
+
+	slot->mod = mod;
+	atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+	return true;
+}
+
+__non_realtime static mod_t *
+_worker_pool_pop(worker_pool_t *pool)
+{
+	unsigned pos = atomic_load_explicit(&pool->head, memory_order_relaxed);
+	worker_slot_t *slot;
+
+	while(true)
+	{
+		slot = &pool->slots[pos & (MAX_MODS - 1)];
+		const unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+		const int dif = (int)(seq - (pos + 1));
+
+		if(dif == 0)
+		{
+			if(atomic_compare_exchange_weak_explicit(&pool->head, &pos, pos + 1,
+					memory_order_relaxed, memory_order_relaxed))
+				break;
+		}
+		else if(dif < 0)
+		{
+			return NULL; // empty
+		}
+		else
+		{
+			pos = atomic_load_explicit(&pool->head, memory_order_relaxed);
+		}
+	}
+
+	mod_t *mod = slot->mod;
+	atomic_store_explicit(&slot->seq, pos + MAX_MODS, memory_order_release);
+
+	return mod;
+}
+
+__realtime void
+_sp_app_mod_worker_signal(mod_t *mod)
 {
-	mod_t *mod = data;
 	mod_worker_t *mod_worker = &mod->mod_worker;
 
-	// will inherit thread priority from main worker thread
-	
-	while(!atomic_load_explicit(&mod_worker->kill, memory_order_acquire))
+	// only the first wakeup queues the module, further ones are picked up by the
+	// pool thread currently serving it
+	if(atomic_fetch_add_explicit(&mod_worker->pending, 1, memory_order_acq_rel) == 0)
 	{
-		sem_wait(&mod_worker->sem);
+		worker_pool_t *pool = &mod->app->worker_pool;
 
+		if(_worker_pool_push(pool, mod))
+			sem_post(&pool->sem);
+		else
+			sp_app_log_trace(mod->app, "%s: worker queue full\n", __func__);
+	}
+}
+
+__non_realtime static void
+_mod_worker_serve(mod_t *mod)
+{
+	mod_worker_t *mod_worker = &mod->mod_worker;
+	unsigned pending = atomic_load_explicit(&mod_worker->pending, memory_order_acquire);
+
+	// only one pool thread serves a module at a time, which keeps its work:work
+	// calls and responses in order, the last decrement hands the module back
+	do
+	{
 		const void *payload;
 		size_t size;
-		while((payload = varchunk_read_request(mod_worker->app_to_worker, &size)))
+		while(mod_worker->app_to_worker
+			&& (payload = varchunk_read_request(mod_worker->app_to_worker, &size)))
 		{
 			_sp_app_mod_worker_work_async(mod, size, payload);
 
 			varchunk_read_advance(mod_worker->app_to_worker);
 		}
 
-		while((payload = varchunk_read_request(mod_worker->state_to_worker, &size)))
+		while(mod_worker->state_to_worker
+			&& (payload = varchunk_read_request(mod_worker->state_to_worker, &size)))
 		{
 			_sp_app_mod_worker_work_async(mod, size, payload);
 
@@ -556,16 +680,120 @@ _mod_worker_thread(void *data)
 				atomic_flag_clear(&mod->idisp.lock);
 			}
 		}
+
+		pending = atomic_fetch_sub_explicit(&mod_worker->pending, pending,
+			memory_order_acq_rel) - pending;
+	} while(pending);
+}
+
+__non_realtime static void *
+_worker_pool_thread(void *data)
+{
+	sp_app_t *app = data;
+	worker_pool_t *pool = &app->worker_pool;
+
+	// will inherit thread priority from main worker thread
+
+	while(true)
+	{
+		sem_wait(&pool->sem);
+
+		if(atomic_load_explicit(&pool->kill, memory_order_acquire))
+			break;
+
+		mod_t *mod;
+		while(!(mod = _worker_pool_pop(pool)))
+		{
+			sched_yield(); // a module is about to publish its slot
+		}
+
+		_mod_worker_serve(mod);
 	}
 
 	return NULL;
 }
 
+void
+_sp_app_mod_worker_pool_init(sp_app_t *app)
+{
+	worker_pool_t *pool = &app->worker_pool;
+
+	sem_init(&pool->sem, 0, 0);
+	atomic_init(&pool->kill, false);
+	atomic_init(&pool->head, 0);
+	atomic_init(&pool->tail, 0);
+
+	for(unsigned i = 0; i < MAX_MODS; i++)
+	{
+		atomic_init(&pool->slots[i].seq, i);
+		pool->slots[i].mod = NULL;
+	}
+
+	pool->num_threads = 0;
+	pool->threads = NULL;
+}
+
+// spawned lazily from the main worker thread, so pool threads inherit its priority
+__non_realtime static void
+_sp_app_mod_worker_pool_spawn(sp_app_t *app)
+{
+	worker_pool_t *pool = &app->worker_pool;
+
+	if(pool->threads)
+		return; // already spawned
+
+	unsigned num_threads = app->driver->num_workers;
+	if(num_threads == 0)
+	{
+		const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = num_cpus > 0 ? num_cpus : 1;
+	}
+
+	pool->threads = calloc(num_threads, sizeof(pthread_t));
+	if(!pool->threads)
+	{
+		sp_app_log_error(app, "%s: failed to allocate threads\n", __func__);
+		return;
+	}
+
+	for(unsigned i = 0; i < num_threads; i++)
+	{
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		if(pthread_create(&pool->threads[pool->num_threads], &attr, _worker_pool_thread, app))
+		{
+			sp_app_log_error(app, "%s: failed to spawn thread\n", __func__);
+			break;
+		}
+
+		pool->num_threads += 1;
+	}
+}
+
+void
+_sp_app_mod_worker_pool_deinit(sp_app_t *app)
+{
+	worker_pool_t *pool = &app->worker_pool;
+
+	atomic_store_explicit(&pool->kill, true, memory_order_release);
+	for(unsigned i = 0; i < pool->num_threads; i++)
+		sem_post(&pool->sem);
+
+	for(unsigned i = 0; i < pool->num_threads; i++)
+	{
+		void *ret;
+		pthread_join(pool->threads[i], &ret);
+	}
+
+	if(pool->threads)
+		free(pool->threads);
+
+	sem_destroy(&pool->sem);
+}
+
 __realtime void
 _sp_app_mod_queue_draw(mod_t *mod)
 {
-	mod_worker_t *mod_worker = &mod->mod_worker;
-
 	if(mod->idisp.iface && mod->idisp.subscribed)
 	{
 		while(mod->idisp.counter >= mod->idisp.threshold)
@@ -573,7 +801,7 @@ _sp_app_mod_queue_draw(mod_t *mod)
 			mod->idisp.counter -= mod->idisp.threshold;
 
 			atomic_store(&mod->idisp.draw_queued, true);
-			sem_post(&mod_worker->sem);
+			_sp_app_mod_worker_signal(mod);
 		}
 	}
 }
@@ -619,7 +847,9 @@ _sp_app_mod_add(sp_app_t *app, const char *uri, LV2_URID urn, uint32_t created,
 
 	mod->needs_bypassing = false; // plugins with control ports only need no bypassing upon preset load
 	mod->bypassed = false;
+	atomic_init(&mod->dirty, true); // not saved anywhere yet
 	atomic_init(&mod->dsp_client.ref_count, 0);
+	atomic_init(&mod->auto_index, &mod->auto_indices[0]); // empty
 
 	// populate worker schedule
 	mod->worker.schedule.handle = mod;
@@ -748,13 +978,16 @@ _sp_app_mod_add(sp_app_t *app, const char *uri, LV2_URID urn, uint32_t created,
 	for(port_type_t pool=0; pool<PORT_TYPE_NUM; pool++)
 		mod->pools[pool].size = 0;
 
-	mod->ports = calloc(mod->num_ports, sizeof(port_t));
+	// ports are followed by the list of subscribed port indices
+	mod->ports = calloc(mod->num_ports, sizeof(port_t) + sizeof(uint32_t));
 	if(!mod->ports)
 	{
 		sp_app_log_error(app, "%s: pool allocation failed\n", __func__);
 		free(mod);
 		return NULL; // failed to alloc ports
 	}
+	mod->subscribed = (uint32_t *)&mod->ports[mod->num_ports];
+	mod->num_subscribed = 0;
 
 	for(unsigned i=0; i<mod->num_ports - 4; i++) // - automation/debug ports
 	{
@@ -908,6 +1141,29 @@ _sp_app_mod_add(sp_app_t *app, const char *uri, LV2_URID urn, uint32_t created,
 		mod->pools[tar->type].size += lv2_atom_pad_size(tar->size);
 	}
 
+	// modules with state need scanning for state changes, those without atom
+	// sequence output cannot notify state:StateChanged and always count as dirty
+	if(mod->state.iface)
+	{
+		bool has_seq_output = false;
+
+		for(unsigned i=0; i<mod->num_ports - 4; i++) // - automation/debug ports
+		{
+			port_t *tar = &mod->ports[i];
+
+			if(  (tar->type == PORT_TYPE_ATOM)
+				&& (tar->atom.buffer_type == PORT_BUFFER_TYPE_SEQUENCE)
+				&& (tar->direction == PORT_DIRECTION_OUTPUT) )
+			{
+				has_seq_output = true;
+				break;
+			}
+		}
+
+		mod->dirty_scan = true;
+		mod->dirty_always = !has_seq_output;
+	}
+
 	// rough guestimate of minimal debug port size
 	const size_t dbg_sz = 8 * (mod->pools[PORT_TYPE_ATOM].size
 		? mod->pools[PORT_TYPE_ATOM].size
@@ -1013,7 +1269,7 @@ _sp_app_mod_add(sp_app_t *app, const char *uri, LV2_URID urn, uint32_t created,
 	int alloc_failed = 0;
 	for(port_type_t pool=0; pool<PORT_TYPE_NUM; pool++)
 	{
-		if(_sp_app_mod_alloc_pool(&mod->pools[pool]))
+		if(_sp_app_mod_alloc_pool(app, &mod->pools[pool]))
 		{
 			alloc_failed = 1;
 			break;
@@ -1034,6 +1290,12 @@ _sp_app_mod_add(sp_app_t *app, const char *uri, LV2_URID urn, uint32_t created,
 		return NULL;
 	}
 
+	// place pools on the node of the DSP thread until we know better
+	mod->node = app->dsp_master.node;
+	mod->node_next = mod->node;
+	if(app->dsp_master.num_nodes > 1)
+		_sp_app_topo_migrate(app, mod);
+
 	// slice plugin buffer into per-port-type-and-direction regions for
 	// efficient dereference in plugin instance
 	for(port_type_t pool=0; pool<PORT_TYPE_NUM; pool++)
@@ -1044,25 +1306,26 @@ _sp_app_mod_add(sp_app_t *app, const char *uri, LV2_URID urn, uint32_t created,
 		port_t *tar = &mod->ports[i];
 
 		// set port buffer
-		lilv_instance_connect_port(mod->inst, i, tar->base);
+		lilv_instance_connect_port(mod->inst, i, PORT_BUFFER(tar));
 	}
 
 	// load presets
 	mod->presets = lilv_plugin_get_related(plug, app->regs.pset.preset.node);
 	
-	// spawn worker thread
+	// set up work queues, served by the shared worker pool
+	atomic_init(&mod->mod_worker.pending, 0);
 	if(mod->worker.iface || mod->idisp.iface)
 	{
 		mod_worker_t *mod_worker = &mod->mod_worker;
 
-		sem_init(&mod_worker->sem, 0, 0);
-		atomic_init(&mod_worker->kill, false);
-		mod_worker->app_to_worker = varchunk_new(2048, true); //FIXME how big
-		mod_worker->state_to_worker = varchunk_new(2048, true); //FIXME how big
-		mod_worker->app_from_worker = varchunk_new(2048, true); //FIXME how big
-		pthread_attr_t attr;
-		pthread_attr_init(&attr);
-		pthread_create(&mod_worker->thread, &attr, _mod_worker_thread, mod);
+		if(mod->worker.iface) // inline display only needs no queues
+		{
+			mod_worker->app_to_worker = varchunk_new(2048, true); //FIXME how big
+			mod_worker->state_to_worker = varchunk_new(2048, true); //FIXME how big
+			mod_worker->app_from_worker = varchunk_new(2048, true); //FIXME how big
+		}
+
+		_sp_app_mod_worker_pool_spawn(app);
 	}
 
 	// activate
@@ -1084,19 +1347,27 @@ _sp_app_mod_add(sp_app_t *app, const char *uri, LV2_URID urn, uint32_t created,
 int
 _sp_app_mod_del(sp_app_t *app, mod_t *mod)
 {
-	// deinit worker thread
+	// deinit work queues
 	if(mod->worker.iface || mod->idisp.iface)
 	{
 		mod_worker_t *mod_worker = &mod->mod_worker;
 
-		atomic_store_explicit(&mod_worker->kill, true, memory_order_release);
-		sem_post(&mod_worker->sem);
-		void *ret;
-		pthread_join(mod_worker->thread, &ret);
-		varchunk_free(mod_worker->app_to_worker);
-		varchunk_free(mod_worker->state_to_worker);
-		varchunk_free(mod_worker->app_from_worker);
-		sem_destroy(&mod_worker->sem);
+		// wait for pool threads to be done with module, the extra wakeup keeps it
+		// from being queued ever again
+		unsigned expected = 0;
+		while(  app->worker_pool.num_threads
+			&& !atomic_compare_exchange_strong(&mod_worker->pending, &expected, 1) )
+		{
+			expected = 0;
+			usleep(1000);
+		}
+
+		if(mod_worker->app_to_worker)
+			varchunk_free(mod_worker->app_to_worker);
+		if(mod_worker->state_to_worker)
+			varchunk_free(mod_worker->state_to_worker);
+		if(mod_worker->app_from_worker)
+			varchunk_free(mod_worker->app_from_worker);
 	}
 
 	// deinit instance
@@ -1126,6 +1397,9 @@ _sp_app_mod_del(sp_app_t *app, mod_t *mod)
 	if(mod->uri_str)
 		free(mod->uri_str);
 
+	if(mod->state_dir)
+		free(mod->state_dir);
+
 	free(mod);
 
 	return 0; //success
@@ -1229,7 +1503,7 @@ _sp_app_mod_reinitialize_soft(mod_t *mod)
 		port_t *tar = &mod->ports[i];
 
 		// set port buffer
-		lilv_instance_connect_port(mod->inst, i, tar->base);
+		lilv_instance_connect_port(mod->inst, i, PORT_BUFFER(tar));
 	}
 }
 
@@ -18,6 +18,7 @@
 #include <inttypes.h>
 
 #include <synthpod_app_private.h>
+#include <synthpod_app_seq.h>
 #include <synthpod_patcher.h>
 
 #include <osc.lv2/util.h>
@@ -98,6 +99,112 @@ _dsp_master_concurrent(sp_app_t *app)
 }
 #endif
 
+// HEFT-style upward rank, e.g. critical path from a client down to the sinks
+__realtime void
+_dsp_master_rank(sp_app_t *app)
+{
+	dsp_master_t *dsp_master = &app->dsp_master;
+
+	// sinks always come after their sources in app->mods, so walk it backwards
+	for(int m=app->num_mods - 1; m>=0; m--)
+	{
+		mod_t *mod = app->mods[m];
+		dsp_client_t *dsp_client = &mod->dsp_client;
+
+		// sort sinks by descending rank (insertion sort, as order rarely changes)
+		for(unsigned j=1; j<dsp_client->num_sinks; j++)
+		{
+			dsp_client_t *sink = dsp_client->sinks[j];
+			unsigned k = j;
+
+			for( ; (k > 0) && (dsp_client->sinks[k-1]->rank < sink->rank); k--)
+				dsp_client->sinks[k] = dsp_client->sinks[k-1];
+
+			dsp_client->sinks[k] = sink;
+		}
+
+		const unsigned gsr = dsp_client->num_sinks
+			? dsp_client->sinks[0]->rank
+			: 0; // greatest sink rank
+
+		dsp_client->rank = gsr + dsp_client->cost + 1; // +1 to rank by hops w/o profiling
+	}
+
+	// sort clients by descending rank, stable to keep topological order on ties
+	for(unsigned m=1; m<app->num_mods; m++)
+	{
+		dsp_client_t *dsp_client = dsp_master->dsp_clients[m];
+		unsigned k = m;
+
+		for( ; (k > 0) && (dsp_master->dsp_clients[k-1]->rank < dsp_client->rank); k--)
+			dsp_master->dsp_clients[k] = dsp_master->dsp_clients[k-1];
+
+		dsp_master->dsp_clients[k] = dsp_client;
+	}
+}
+
+__realtime void
+_sp_app_port_subscribe(port_t *port)
+{
+	mod_t *mod = port->mod;
+
+	if(port->subscriptions++ > 0)
+		return; // already listed
+
+	// insert sorted
+	unsigned i = mod->num_subscribed++;
+	for( ; (i > 0) && (mod->subscribed[i - 1] > port->index); i--)
+		mod->subscribed[i] = mod->subscribed[i - 1];
+	mod->subscribed[i] = port->index;
+}
+
+__realtime void
+_sp_app_port_unsubscribe(port_t *port)
+{
+	mod_t *mod = port->mod;
+
+	if(--port->subscriptions > 0)
+		return; // still subscribed
+
+	unsigned j = 0;
+	for(unsigned i = 0; i < mod->num_subscribed; i++)
+	{
+		if(mod->subscribed[i] != port->index)
+			mod->subscribed[j++] = mod->subscribed[i];
+	}
+	mod->num_subscribed = j;
+}
+
+// connect single unity-gain sources directly to plugin without copying,
+// true if alias has changed and port needs reconnecting
+__realtime static bool
+_sp_app_port_alias(mod_t *mod, port_t *port)
+{
+	port_t *alias = NULL;
+
+	if(  ( (port->type == PORT_TYPE_AUDIO) || (port->type == PORT_TYPE_CV) )
+		&& (port->direction == PORT_DIRECTION_INPUT)
+		&& !mod->system_ports ) // system sinks are read from own buffer by driver
+	{
+		connectable_t *conn = _sp_app_port_connectable(port);
+		source_t *source = &conn->sources[0];
+
+		if(  (conn->num_sources == 1)
+			&& ( (port->type == PORT_TYPE_CV) // CV is never gained nor ramped
+				|| ( (source->gain == 1.f) && (source->ramp.state == RAMP_STATE_NONE) ) ) )
+		{
+			alias = source->port;
+		}
+	}
+
+	if(alias == port->alias)
+		return false;
+
+	port->alias = alias;
+
+	return true;
+}
+
 __realtime void
 _dsp_master_reorder(sp_app_t *app)
 {
@@ -108,6 +215,8 @@ _dsp_master_reorder(sp_app_t *app)
 
 		dsp_client->num_sinks = 0;
 		dsp_client->num_sources = 0;
+
+		app->dsp_master.dsp_clients[m] = dsp_client;
 	}
 
 	for(unsigned m=0; m<app->num_mods; m++)
@@ -166,6 +275,9 @@ _dsp_master_reorder(sp_app_t *app)
 	sp_app_log_trace(app, "\n");
 	*/
 
+	// buffers are rewired and clients reranked at next cycle boundary
+	atomic_store(&app->dsp_master.replan, true);
+
 #if !defined(USE_DYNAMIC_PARALLELIZER)
 	_dsp_master_concurrent(app);
 
@@ -196,6 +308,42 @@ _dsp_master_reorder(sp_app_t *app)
 #endif
 }
 
+// called by master thread before slaves are released
+__realtime void
+_dsp_master_replan(sp_app_t *app)
+{
+	if(atomic_exchange(&app->dsp_master.reorder, false))
+		_dsp_master_reorder(app); // deferred from mid-cycle disconnections
+
+	const bool replan = atomic_exchange(&app->dsp_master.replan, false);
+	const bool realias = atomic_exchange(&app->dsp_master.realias, false);
+
+	if(!replan && !realias)
+		return;
+
+	// sorts sinks and clients in place, thus never while slaves walk them
+	if(replan)
+		_dsp_master_rank(app);
+
+	// rewire zero-copy connections
+	for(unsigned m=0; m<app->num_mods; m++)
+	{
+		mod_t *mod = app->mods[m];
+
+		for(unsigned p=0; p<mod->num_ports; p++)
+		{
+			port_t *port = &mod->ports[p];
+
+			if(_sp_app_port_alias(mod, port))
+				lilv_instance_connect_port(mod->inst, port->index, PORT_BUFFER(port));
+		}
+	}
+
+	// shared buffers are planned by worker and swapped in upon its reply
+	if(replan)
+		_sp_app_arena_request(app);
+}
+
 bool
 _sp_app_port_connected(port_t *src_port, port_t *snk_port, float gain)
 {
@@ -208,6 +356,9 @@ _sp_app_port_connected(port_t *src_port, port_t *snk_port, float gain)
 
 			if(src->port == src_port)
 			{
+				if(src->gain != gain) // zero-copy only for unity gain
+					atomic_store(&snk_port->mod->app->dsp_master.realias, true);
+
 				src->gain = gain;
 				return true;
 			}
@@ -253,12 +404,13 @@ _sp_app_port_connect(sp_app_t *app, port_t *src_port, port_t *snk_port, float ga
 	return 1;
 }
 
-void
-_sp_app_port_disconnect(sp_app_t *app, port_t *src_port, port_t *snk_port)
+// remove source from sink's list, without touching the graph
+__realtime static bool
+_sp_app_port_unlink(port_t *src_port, port_t *snk_port)
 {
 	connectable_t *conn = _sp_app_port_connectable(snk_port);
 	if(!conn)
-		return;
+		return false;
 
 	// update sources list 
 	bool connected = false;
@@ -274,11 +426,18 @@ _sp_app_port_disconnect(sp_app_t *app, port_t *src_port, port_t *snk_port)
 	}
 
 	if(!connected)
-		return;
+		return false;
 
 	conn->num_sources -= 1;
 
-	_dsp_master_reorder(app);
+	return true;
+}
+
+void
+_sp_app_port_disconnect(sp_app_t *app, port_t *src_port, port_t *snk_port)
+{
+	if(_sp_app_port_unlink(src_port, snk_port))
+		_dsp_master_reorder(app);
 }
 
 int
@@ -315,6 +474,7 @@ _sp_app_port_disconnect_request(sp_app_t *app, port_t *src_port, port_t *snk_por
 					source->ramp.samples = app->ramp_samples;
 					source->ramp.state = ramp_state;
 					source->ramp.value = 1.f;
+					atomic_store(&app->dsp_master.realias, true); // ramp needs multiplexing
 				}
 
 				return 1; // needs ramping
@@ -360,6 +520,7 @@ _sp_app_port_desilence(sp_app_t *app, port_t *src_port, port_t *snk_port)
 				source->ramp.samples = app->ramp_samples;
 				source->ramp.state = RAMP_STATE_UP;
 				source->ramp.value = 0.f;
+				atomic_store(&app->dsp_master.realias, true); // ramp needs multiplexing
 
 				return 1; // needs ramping
 			}
@@ -418,6 +579,7 @@ _sp_app_port_silence_request(sp_app_t *app, port_t *src_port, port_t *snk_port,
 				source->ramp.samples = app->ramp_samples;
 				source->ramp.state = ramp_state;
 				source->ramp.value = 1.f;
+				atomic_store(&app->dsp_master.realias, true); // ramp needs multiplexing
 
 				return 1; // needs ramping
 			}
@@ -434,14 +596,18 @@ _update_ramp(sp_app_t *app, source_t *source, port_t *port, uint32_t nsamples)
 	source->ramp.samples -= nsamples; // update remaining samples to ramp over
 	if(source->ramp.samples <= 0)
 	{
+		// runs mid-cycle, other slaves may be walking the graph, so have it
+		// reordered at next cycle boundary
 		if(source->ramp.state == RAMP_STATE_DOWN)
 		{
-			_sp_app_port_disconnect(app, source->port, port);
+			if(_sp_app_port_unlink(source->port, port))
+				atomic_store(&app->dsp_master.reorder, true);
 		}
 		else if(source->ramp.state == RAMP_STATE_DOWN_DEL)
 		{
 			source->port->mod->delete_request = true; // mark module for removal
-			_sp_app_port_disconnect(app, source->port, port);
+			if(_sp_app_port_unlink(source->port, port))
+				atomic_store(&app->dsp_master.reorder, true);
 		}
 		else if(source->ramp.state == RAMP_STATE_DOWN_DRAIN)
 		{
@@ -464,6 +630,7 @@ _update_ramp(sp_app_t *app, source_t *source, port_t *port, uint32_t nsamples)
 		}
 
 		source->ramp.state = RAMP_STATE_NONE; // ramp is complete
+		atomic_store(&app->dsp_master.realias, true); // may be zero-copy again
 	}
 	else
 	{
@@ -480,6 +647,8 @@ _sp_app_port_control_stash(port_t *port)
 	control_port_t *control = &port->control;
 	void *buf = PORT_BASE_ALIGNED(port);
 
+	atomic_store(&port->mod->dirty, true);
+
 	if(_sp_app_port_try_lock(control))
 	{
 		control->stash = *(float *)buf;
@@ -492,69 +661,96 @@ _sp_app_port_control_stash(port_t *port)
 	}
 }
 
+// ramp value at the end of the upcoming block
+static inline float
+_ramp_target(sp_app_t *app, source_t *source, uint32_t nsamples)
+{
+	const int samples = source->ramp.samples - nsamples;
+
+	if(samples <= 0)
+		return source->ramp.state == RAMP_STATE_UP ? 1.f : 0.f;
+
+	const float value = (float)samples / (float)app->ramp_samples;
+
+	return source->ramp.state == RAMP_STATE_UP ? 1.f - value : value;
+}
+
 __realtime static inline void
 _port_audio_multiplex(sp_app_t *app, port_t *port, uint32_t nsamples)
 {
 	float *val = PORT_BASE_ALIGNED(port);
-	memset(val, 0, nsamples * sizeof(float)); // init
+	const float *src [MIX_MAX];
+	float g0 [MIX_MAX];
+	float dg [MIX_MAX];
+	unsigned nsrc = 0;
+	bool clear = true; // fuse init with first pass
 
 	connectable_t *conn = &port->audio.connectable;
 	for(int s=0; s<conn->num_sources; s++)
 	{
 		source_t *source = &conn->sources[s];
 
-		// ramp audio output ports
+		src[nsrc] = PORT_BASE_ALIGNED(source->port);
+
+		// ramp audio output ports per sample
 		if(source->ramp.state != RAMP_STATE_NONE)
 		{
-			const float *src = PORT_BASE_ALIGNED(source->port);
-			const float gain = source->gain * source->ramp.value;
+			const float target = _ramp_target(app, source, nsamples);
 
-			if(gain == 1.f)
-			{
-				for(uint32_t j=0; j<nsamples; j++)
-					val[j] += src[j];
-			}
-			else // gain != 1.f
-			{
-				for(uint32_t j=0; j<nsamples; j++)
-					val[j] += src[j] * gain;
-			}
+			g0[nsrc] = source->gain * source->ramp.value;
+			dg[nsrc] = (source->gain * target - g0[nsrc]) / nsamples;
 
 			_update_ramp(app, source, port, nsamples);
 		}
 		else // RAMP_STATE_NONE
 		{
-			const float *src = PORT_BASE_ALIGNED(source->port);
-			const float gain = source->gain;
-			if(gain == 1.f)
-			{
-				for(uint32_t j=0; j<nsamples; j++)
-					val[j] += src[j];
-			}
-			else // gain != 1.f
-			{
-				for(uint32_t j=0; j<nsamples; j++)
-					val[j] += src[j] * gain;
-			}
+			g0[nsrc] = source->gain;
+			dg[nsrc] = 0.f;
+		}
+
+		if(++nsrc == MIX_MAX)
+		{
+			app->mix(val, src, g0, dg, nsrc, clear, nsamples);
+			clear = false;
+			nsrc = 0;
 		}
 	}
+
+	if(nsrc)
+		app->mix(val, src, g0, dg, nsrc, clear, nsamples);
+	else if(clear)
+		memset(val, 0, nsamples * sizeof(float)); // no sources
 }
 
 __realtime static inline void
 _port_cv_multiplex(sp_app_t *app, port_t *port, uint32_t nsamples)
 {
 	float *val = PORT_BASE_ALIGNED(port);
-	memset(val, 0, nsamples * sizeof(float)); // init
+	const float *src [MIX_MAX];
+	const float g0 [MIX_MAX] = {1.f, 1.f, 1.f, 1.f};
+	const float dg [MIX_MAX] = {0.f, 0.f, 0.f, 0.f};
+	unsigned nsrc = 0;
+	bool clear = true; // fuse init with first pass
 
 	connectable_t *conn = &port->cv.connectable;
 	for(int s=0; s<conn->num_sources; s++)
 	{
 		source_t *source = &conn->sources[s];
 
-		const float *src = PORT_BASE_ALIGNED(source->port);
-		for(uint32_t j=0; j<nsamples; j++)
-			val[j] += src[j];
+		src[nsrc] = PORT_BASE_ALIGNED(source->port);
+
+		if(++nsrc == MIX_MAX)
+		{
+			app->mix(val, src, g0, dg, nsrc, clear, nsamples);
+			clear = false;
+			nsrc = 0;
+		}
 	}
+
+	if(nsrc)
+		app->mix(val, src, g0, dg, nsrc, clear, nsamples);
+	else if(clear)
+		memset(val, 0, nsamples * sizeof(float)); // no sources
 }
 
 __realtime static inline int
@@ -672,10 +868,17 @@ _sp_app_automate_event(sp_app_t *app, mod_t *mod, const LV2_Atom_Event *ev,
 			const uint8_t controller = msg[1];
 			const uint8_t val = msg[2];
 
+			// collect candidate automations
+			const auto_index_t *idx = _automation_index(mod);
+			uint64_t candidates = idx->midi_wild;
+
+			for(unsigned i = idx->midi[channel][controller & 0x7f]; i; i = idx->next_source[i - 1])
+				candidates |= 1ULL << (i - 1);
+
 			// iterate over automations
-			for(unsigned i = 0; i < MAX_AUTOMATIONS; i++)
+			for( ; candidates; candidates &= candidates - 1)
 			{
-				auto_t *automation = &mod->automations[i];
+				auto_t *automation = &mod->automations[__builtin_ctzll(candidates)];
 
 				if(  (automation->type == AUTO_TYPE_MIDI)
 					&& automation->snk_enabled )
@@ -793,10 +996,17 @@ _sp_app_automate_event(sp_app_t *app, mod_t *mod, const LV2_Atom_Event *ev,
 				}
 			}
 
+			// collect candidate automations
+			const auto_index_t *idx = _automation_index(mod);
+			uint64_t candidates = idx->osc_wild;
+
+			for(unsigned i = idx->osc[_automation_hash(path)]; i; i = idx->next_source[i - 1])
+				candidates |= 1ULL << (i - 1);
+
 			// iterate over automations
-			for(unsigned i = 0; i < MAX_AUTOMATIONS; i++)
+			for( ; candidates; candidates &= candidates - 1)
 			{
-				auto_t *automation = &mod->automations[i];
+				auto_t *automation = &mod->automations[__builtin_ctzll(candidates)];
 
 				if(  (automation->type == AUTO_TYPE_OSC)
 					&& automation->snk_enabled )
@@ -864,8 +1074,10 @@ _port_seq_multiplex(sp_app_t *app, port_t *port, uint32_t nsamples)
 	LV2_Atom_Sequence *dst = PORT_BASE_ALIGNED(port);
 
 	connectable_t *conn = &port->atom.connectable;
-	const LV2_Atom_Sequence *seq [MAX_SOURCES];
-	const LV2_Atom_Event *itr [MAX_SOURCES];
+	const LV2_Atom_Sequence *seq [MAX_SOURCES + 1];
+	const LV2_Atom_Event *itr [MAX_SOURCES + 1];
+	seq_heap_t heap = { .num = 0 };
+
 	for(int s=0; s<conn->num_sources; s++)
 	{
 		seq[s] = PORT_BASE_ALIGNED(conn->sources[s].port);
@@ -883,102 +1095,94 @@ _port_seq_multiplex(sp_app_t *app, port_t *port, uint32_t nsamples)
 		num_sources++;
 	}
 
-	while(true)
+	_seq_heap_seed(&heap, seq, itr, num_sources, nsamples);
+
+	// fast path: plain routing of a single non-empty source
+	if(  (heap.num == 1)
+		&& (heap.srcs[0] != conn->num_sources) // not from automation port
+		&& (port != auto_port) ) // no automation to apply
+	{
+		const int s = heap.srcs[0];
+
+		if(_port_seq_bulk_copy(dst, capacity, seq[s], nsamples))
+			return;
+	}
+
+	while(heap.num)
 	{
-		int nxt = -1;
-		int64_t frames = nsamples;
+		const int nxt = heap.srcs[0];
+		const LV2_Atom_Event *ev = itr[nxt];
 
-		// search for next event in timeline accross source ports
-		for(int s=0; s<num_sources; s++)
+		if(nxt == conn->num_sources) // event from automation port
 		{
-			if(lv2_atom_sequence_is_end(&seq[s]->body, seq[s]->atom.size, itr[s]))
-				continue; // reached sequence end
-			
-			if(itr[s]->time.frames < frames)
-			{
-				frames = itr[s]->time.frames;
-				nxt = s;
-			}
+			_sp_app_automate_event(app, mod, ev, false);
 		}
-
-		if(nxt >= 0) // next event found
+		else
 		{
-			const LV2_Atom_Event *ev = itr[nxt];
+			int do_route = 0;
 
-			if(nxt == conn->num_sources) // event from automation port
+			if(port == auto_port)
 			{
-				_sp_app_automate_event(app, mod, ev, false);
+				// directly apply control automation, only route param automation
+				do_route += _sp_app_automate_event(app, mod, ev, true);
 			}
 			else
 			{
-				int do_route = 0;
+				do_route += 1;
+			}
 
-				if(port == auto_port)
-				{
-					// directly apply control automation, only route param automation
-					do_route += _sp_app_automate_event(app, mod, ev, true);
-				}
-				else
+			if(do_route)
+			{
+				LV2_Atom_Event *ev2 = lv2_atom_sequence_append_event(dst, capacity, ev);
+				if(!ev2)
 				{
-					do_route += 1;
-				}
-
-				if(do_route)
-				{
-					LV2_Atom_Event *ev2 = lv2_atom_sequence_append_event(dst, capacity, ev);
-					if(!ev2)
-					{
-						sp_app_log_trace(app, "%s: failed to append\n", __func__);
-					}
+					sp_app_log_trace(app, "%s: failed to append\n", __func__);
 				}
 			}
-
-			// advance iterator
-			itr[nxt] = lv2_atom_sequence_next(ev);
 		}
-		else
-			break; // no more events to process
-	};
+
+		_seq_heap_advance(&heap, seq, itr, nsamples);
+	}
 }
 
 __realtime static LV2_Atom_Forge_Ref
-_patch_notification_internal(sp_app_t *app, port_t *source_port,
+_patch_notification_internal(sp_app_t *app, LV2_Atom_Forge *forge, port_t *source_port,
 	uint32_t size, LV2_URID type, const void *body)
 {
-	LV2_Atom_Forge_Ref ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_module.urid);
+	LV2_Atom_Forge_Ref ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_module.urid);
 	if(ref)
-		ref = lv2_atom_forge_urid(&app->forge, source_port->mod->urn);
+		ref = lv2_atom_forge_urid(forge, source_port->mod->urn);
 
 	if(ref)
-		ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_symbol.urid);
+		ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_symbol.urid);
 	if(ref)
-		ref = lv2_atom_forge_string(&app->forge, source_port->symbol, strlen(source_port->symbol));
+		ref = lv2_atom_forge_string(forge, source_port->symbol, strlen(source_port->symbol));
 
 	if(ref)
-		ref = lv2_atom_forge_key(&app->forge, app->regs.rdf.value.urid);
+		ref = lv2_atom_forge_key(forge, app->regs.rdf.value.urid);
 	if(ref)
-		ref = lv2_atom_forge_atom(&app->forge, size, type);
+		ref = lv2_atom_forge_atom(forge, size, type);
 	if(ref)
-		ref = lv2_atom_forge_write(&app->forge, body, size);
+		ref = lv2_atom_forge_write(forge, body, size);
 
 	return ref;
 }
 
 __realtime static void
-_patch_notification_add(sp_app_t *app, port_t *source_port,
+_patch_notification_add(sp_app_t *app, post_t *post, port_t *source_port,
 	LV2_URID proto, uint32_t size, LV2_URID type, const void *body)
 {
 	LV2_Atom_Forge_Frame frame [3];
 
-	LV2_Atom *answer = _sp_app_to_ui_request_atom(app);
+	LV2_Atom *answer = _sp_app_post_request_atom(app, post);
 	if(answer)
 	{
-		if(synthpod_patcher_add_object(&app->regs, &app->forge, &frame[0],
+		if(synthpod_patcher_add_object(&app->regs, post->forge, &frame[0],
 				0, 0, app->regs.synthpod.notification_list.urid) //TODO subject
-			&& lv2_atom_forge_object(&app->forge, &frame[2], 0, proto)
-			&& _patch_notification_internal(app, source_port, size, type, body) )
+			&& lv2_atom_forge_object(post->forge, &frame[2], 0, proto)
+			&& _patch_notification_internal(app, post->forge, source_port, size, type, body) )
 		{
-			synthpod_patcher_pop(&app->forge, frame, 3);
+			synthpod_patcher_pop(post->forge, frame, 3);
 
 			const LV2_Atom_Object *patch_add = NULL;
 			const LV2_Atom_Object *obj = NULL;
@@ -1016,7 +1220,7 @@ _patch_notification_add(sp_app_t *app, port_t *source_port,
 			}
 			// dsp debug out
 
-			_sp_app_to_ui_advance_atom(app, answer);
+			_sp_app_post_advance_atom(app, post, answer);
 		}
 		else
 		{
@@ -1030,12 +1234,12 @@ _patch_notification_add(sp_app_t *app, port_t *source_port,
 }
 
 __realtime static inline void
-_port_float_protocol_update(sp_app_t *app, port_t *port, uint32_t nsamples)
+_port_float_protocol_update(sp_app_t *app, post_t *post, port_t *port, uint32_t nsamples)
 {
 	bool needs_update = false;
 	float new_val = 0.f;
 
-	const float *val = PORT_BASE_ALIGNED(port);
+	const float *val = PORT_BUFFER_ALIGNED(port);
 	new_val = *val;
 	needs_update = new_val != port->control.last;
 
@@ -1045,15 +1249,15 @@ _port_float_protocol_update(sp_app_t *app, port_t *port, uint32_t nsamples)
 	if(needs_update)
 	{
 		// for nk
-		_patch_notification_add(app, port, app->regs.port.float_protocol.urid,
+		_patch_notification_add(app, post, port, app->regs.port.float_protocol.urid,
 			sizeof(float), app->forge.Float, &new_val);
 	}
 }
 
 __realtime static inline void
-_port_peak_protocol_update(sp_app_t *app, port_t *port, uint32_t nsamples)
+_port_peak_protocol_update(sp_app_t *app, post_t *post, port_t *port, uint32_t nsamples)
 {
-	const float *vec = PORT_BASE_ALIGNED(port);
+	const float *vec = PORT_BUFFER_ALIGNED(port);
 
 	// find peak value in current period
 	float peak = 0.f;
@@ -1113,13 +1317,13 @@ _port_peak_protocol_update(sp_app_t *app, port_t *port, uint32_t nsamples)
 				.body = data.peak
 			}
 		};
-		_patch_notification_add(app, port, app->regs.port.peak_protocol.urid,
+		_patch_notification_add(app, post, port, app->regs.port.peak_protocol.urid,
 			tup.header.atom.size, tup.header.atom.type, &tup.period_start);
 	}
 }
 
 __realtime static inline void
-_port_atom_transfer_update(sp_app_t *app, port_t *port, uint32_t nsamples)
+_port_atom_transfer_update(sp_app_t *app, post_t *post, port_t *port, uint32_t nsamples)
 {
 	const LV2_Atom *atom = PORT_BASE_ALIGNED(port);
 
@@ -1130,12 +1334,12 @@ _port_atom_transfer_update(sp_app_t *app, port_t *port, uint32_t nsamples)
 		return;
 
 	// for nk
-	_patch_notification_add(app, port, app->regs.port.atom_transfer.urid,
+	_patch_notification_add(app, post, port, app->regs.port.atom_transfer.urid,
 		atom->size, atom->type, LV2_ATOM_BODY_CONST(atom));
 }
 
 __realtime static inline void
-_port_event_transfer_update(sp_app_t *app, port_t *port, uint32_t nsamples)
+_port_event_transfer_update(sp_app_t *app, post_t *post, port_t *port, uint32_t nsamples)
 {
 	const LV2_Atom_Sequence *seq = PORT_BASE_ALIGNED(port);
 
@@ -1151,7 +1355,7 @@ _port_event_transfer_update(sp_app_t *app, port_t *port, uint32_t nsamples)
 			const LV2_Atom *atom = &ev->body;
 
 			// for nk
-			_patch_notification_add(app, port, app->regs.port.event_transfer.urid,
+			_patch_notification_add(app, post, port, app->regs.port.event_transfer.urid,
 				atom->size, atom->type, LV2_ATOM_BODY_CONST(atom));
 		}
 	}
@@ -1161,7 +1365,7 @@ _port_event_transfer_update(sp_app_t *app, port_t *port, uint32_t nsamples)
 		{
 			const LV2_Atom_Object *obj = (const LV2_Atom_Object *)&ev->body;
 
-			if(lv2_atom_forge_is_object_type(&app->forge, obj->atom.type))
+			if(lv2_atom_forge_is_object_type(post->forge, obj->atom.type))
 			{ 
 				/*FIXME
 				const LV2_Atom_URID *destination = NULL;
@@ -1183,7 +1387,7 @@ _port_event_transfer_update(sp_app_t *app, port_t *port, uint32_t nsamples)
 					|| (obj->body.otype == app->regs.patch.ack.urid) ) //TODO support more patch messages
 				{
 					// for nk
-					_patch_notification_add(app, port, app->regs.port.event_transfer.urid,
+					_patch_notification_add(app, post, port, app->regs.port.event_transfer.urid,
 						obj->atom.size, obj->atom.type, &obj->body);
 				}
 			}
@@ -26,9 +26,11 @@
 #include <math.h>
 #include <semaphore.h>
 #include <pthread.h>
+#include <stdalign.h>
 
 #include <synthpod_app.h>
 #include <synthpod_private.h>
+#include <synthpod_index.h>
 
 #include <sratom/sratom.h>
 #include <varchunk.h>
@@ -48,9 +50,25 @@
 #define NUM_FEATURES 17
 #define MAX_SOURCES 32 // TODO how many?
 #define MAX_MODS 512 // TODO how many?
-#define MAX_SLAVES 7 // e.g. 8-core machines
-#define MAX_AUTOMATIONS 64
+#define MAX_NODES 8 // NUMA nodes to track module placement on
+#define MIX_MAX 4 // sources summed per pass of mix kernel
+#define CACHE_LINE_SIZE 64
+#define DSP_ACTIVE_BITS 10 // low bits of barrier generation word: slaves taking part
+#define DSP_ACTIVE_MASK ((1U << DSP_ACTIVE_BITS) - 1)
+#define MAX_AUTOMATIONS 64 // must fit into uint64_t slot masks
+#define AUTO_HASH 128 // buckets of automation hash maps, power of two
 #define ALIAS_MAX 32
+#define ARENA_SLOTS 256 // shared audio/CV buffers
+#define ARENA_PORTS 2048 // audio/CV ports considered for sharing
+#define ARENA_LINKS 4096 // module to module connections considered for sharing
+#define ARENA_EDGES 4096 // audio/CV port connections considered for sharing
+#define TRACE_EVENTS 0x4000 // per DSP thread, power of two
+#define TRACE_XRUN_DUMPS 16 // automatic dumps upon xruns per session
+#define TRACE_XRUN_HOLDOFF 10 // seconds between automatic dumps
+#define POST_RING_SIZE 0x100000 // per DSP thread, UI notifications of one cycle
+#define HIST_SUB_BITS 5 // ~3% relative bucket error
+#define HIST_SUB (1U << HIST_SUB_BITS)
+#define HIST_BUCKETS ((32 - HIST_SUB_BITS + 1) * HIST_SUB)
 
 typedef enum _job_type_request_t job_type_request_t;
 typedef enum _job_type_reply_t job_type_reply_t;
@@ -58,16 +76,33 @@ typedef enum _blocking_state_t blocking_state_t;
 typedef enum _silencing_state_t silencing_state_t;
 typedef enum _ramp_state_t ramp_state_t;
 typedef enum _auto_type_t auto_type_t;
+typedef enum _trace_type_t trace_type_t;
 
 typedef char urn_uuid_t [URN_UUID_LENGTH];
 typedef struct _dsp_slave_t dsp_slave_t;
 typedef struct _dsp_client_t dsp_client_t;
+typedef struct _dsp_deque_t dsp_deque_t;
 typedef struct _dsp_master_t dsp_master_t;
+typedef struct _mod_set_t mod_set_t;
+typedef struct _arena_mod_t arena_mod_t;
+typedef struct _arena_port_t arena_port_t;
+typedef struct _arena_graph_t arena_graph_t;
+typedef struct _arena_t arena_t;
+typedef struct _trace_event_t trace_event_t;
+typedef struct _trace_ring_t trace_ring_t;
+typedef struct _trace_name_t trace_name_t;
+typedef struct _trace_t trace_t;
+typedef struct _hist_t hist_t;
+typedef struct _stats_t stats_t;
+typedef struct _post_t post_t;
 
 typedef struct _mod_worker_t mod_worker_t;
+typedef struct _worker_slot_t worker_slot_t;
+typedef struct _worker_pool_t worker_pool_t;
 typedef struct _midi_auto_t midi_auto_t;
 typedef struct _osc_auto_t osc_auto_t;
 typedef struct _auto_t auto_t;
+typedef struct _auto_index_t auto_index_t;
 typedef struct _mod_t mod_t;
 typedef struct _port_t port_t;
 typedef struct _job_t job_t;
@@ -78,7 +113,9 @@ typedef struct _app_prof_t app_prof_t;
 typedef struct _mod_prof_t mod_prof_t;
 
 typedef void (*port_multiplex_cb_t) (sp_app_t *app, port_t *port, uint32_t nsamples);
-typedef void (*port_transfer_cb_t) (sp_app_t *app, port_t *port, uint32_t nsamples);
+typedef void (*port_transfer_cb_t) (sp_app_t *app, post_t *post, port_t *port, uint32_t nsamples);
+typedef void (*mix_cb_t) (float *dst, const float *const *src, const float *g0,
+	const float *dg, unsigned nsrc, bool clear, uint32_t nsamples);
 
 enum _silencing_state_t {
 	SILENCING_STATE_RUN = 0,
@@ -128,7 +165,10 @@ enum _job_type_request_t {
 	JOB_TYPE_REQUEST_BUNDLE_SAVE,
 	JOB_TYPE_REQUEST_BUNDLE_LOAD_STATUS,
 	JOB_TYPE_REQUEST_BUNDLE_SAVE_STATUS,
-	JOB_TYPE_REQUEST_DRAIN
+	JOB_TYPE_REQUEST_DRAIN,
+	JOB_TYPE_REQUEST_TRACE_DUMP,
+	JOB_TYPE_REQUEST_STATS_DUMP,
+	JOB_TYPE_REQUEST_ARENA_PLAN
 };
 
 enum _job_type_reply_t {
@@ -140,13 +180,24 @@ enum _job_type_reply_t {
 	JOB_TYPE_REPLY_PRESET_SAVE,
 	JOB_TYPE_REPLY_BUNDLE_LOAD,
 	JOB_TYPE_REPLY_BUNDLE_SAVE,
-	JOB_TYPE_REPLY_DRAIN
+	JOB_TYPE_REPLY_DRAIN,
+	JOB_TYPE_REPLY_ARENA_PLAN
 };
 
 struct _dsp_slave_t {
 	dsp_master_t *dsp_master;
 	sem_t sem;
 	pthread_t thread;
+	int cpu; // -1: no affinity
+	int node; // NUMA node of cpu
+	uint64_t wake_sum; // wake-to-run latency in ns
+	unsigned wake_max;
+	unsigned wake_count;
+};
+
+// bitset of modules, indexed by position in graph
+struct _mod_set_t {
+	uint64_t bits [MAX_MODS/64];
 };
 
 struct _dsp_client_t {
@@ -154,6 +205,10 @@ struct _dsp_client_t {
 	unsigned num_sinks;
 	unsigned num_sources;
 	dsp_client_t *sinks [64]; //FIXME
+	unsigned cost; // measured run time of last profiling period
+	unsigned node_runs [MAX_NODES]; // runs per NUMA node in last profiling period
+	unsigned rank; // upward rank: longest remaining path to a sink
+	unsigned idx; // position in graph
 
 #if defined(USE_DYNAMIC_PARALLELIZER)
 	unsigned weight;
@@ -163,15 +218,44 @@ struct _dsp_client_t {
 #endif
 };
 
+#if defined(USE_WORK_STEALING)
+// Chase-Lev work-stealing deque of ready clients, one per DSP thread
+struct _dsp_deque_t {
+	alignas(CACHE_LINE_SIZE) atomic_int top; // thieves steal from here
+	alignas(CACHE_LINE_SIZE) atomic_int bottom; // owner pushes/takes here
+	_Atomic(dsp_client_t *) clients [MAX_MODS]; // each client is pushed once per cycle
+};
+#endif
+
 struct _dsp_master_t {
-	dsp_slave_t dsp_slaves [MAX_SLAVES];
+	dsp_slave_t *dsp_slaves; // sized at runtime
+#if defined(USE_WORK_STEALING)
+	dsp_deque_t *dsp_deques; // [0] is owned by master thread
+	alignas(CACHE_LINE_SIZE) atomic_uint pending; // clients left to run in this cycle
+	unsigned num_deques; // deques active in this cycle
+#endif
 	atomic_bool kill;
 	atomic_bool emergency_exit;
 	atomic_bool xrun_report;
+	atomic_bool replan; // ranks, aliases and arena to be redone before next cycle
+	atomic_bool reorder; // graph to be rederived before next cycle
+	atomic_bool realias; // aliases to be redone before next cycle, e.g. upon gain or ramp changes
 	sem_t sem;
 	unsigned concurrent;
 	unsigned num_slaves;
+	int cpu; // of master thread, -1: no affinity
+	int node; // NUMA node of master thread
+	unsigned num_nodes;
 	uint32_t nsamples;
+	bool sparse_update_timeout;
+	dsp_client_t *dsp_clients [MAX_MODS]; // sorted by descending upward rank
+	uint64_t t_post; // time of last slave wakeup in ns
+
+	// hybrid spin/futex barrier
+	uint64_t spin_ns; // spin time before parking on futex, 0: use semaphores
+	alignas(CACHE_LINE_SIZE) atomic_uint generation; // futex word, cycle << DSP_ACTIVE_BITS | slaves taking part
+	atomic_uint sleepers; // slaves parked on futex
+	alignas(CACHE_LINE_SIZE) atomic_uint done; // slaves having finished this cycle
 };
 
 struct _job_t {
@@ -191,6 +275,28 @@ struct _pool_t {
 	void *buf;
 };
 
+// log-bucketed run times in ns, HIST_SUB linear sub-buckets per power of two
+struct _hist_t {
+	uint64_t count;
+	uint64_t over; // runs over period budget
+	uint32_t max;
+	uint32_t buckets [HIST_BUCKETS];
+};
+
+// histogram summary, passed on to worker for the stats file
+struct _stats_t {
+	LV2_URID urn; // 0 for whole cycle
+	LV2_URID uri; // of plugin, worker must not walk app->mods
+	char alias [ALIAS_MAX];
+	uint32_t budget; // period duration in ns
+	uint32_t p50;
+	uint32_t p99;
+	uint32_t p999;
+	uint32_t max;
+	uint64_t count;
+	uint64_t over;
+};
+
 struct _app_prof_t {
 	struct timespec t0;
 	struct timespec t1;
@@ -198,23 +304,40 @@ struct _app_prof_t {
 	unsigned min;
 	unsigned max;
 	unsigned count;
+	uint32_t budget; // period duration in ns
+	hist_t hist; // cumulative, survives xrun resets
 };
 
 struct _mod_prof_t {
 	unsigned sum;
 	unsigned min;
 	unsigned max;
+	unsigned post; // time spent in post processing
+	hist_t hist; // cumulative, survives xrun resets
 };
 
 struct _mod_worker_t {
-	sem_t sem;
-	pthread_t thread;
-	atomic_bool kill;
+	atomic_uint pending; // wakeups not served yet, nonzero while queued or served
 	varchunk_t *app_to_worker;
 	varchunk_t *state_to_worker;
 	varchunk_t *app_from_worker;
 };
 
+struct _worker_slot_t {
+	atomic_uint seq;
+	mod_t *mod;
+};
+
+struct _worker_pool_t {
+	sem_t sem;
+	atomic_bool kill;
+	unsigned num_threads;
+	pthread_t *threads; // sized at runtime, spawned with first module worker
+	alignas(CACHE_LINE_SIZE) atomic_uint head; // pool threads dequeue here
+	alignas(CACHE_LINE_SIZE) atomic_uint tail; // modules enqueue here
+	worker_slot_t slots [MAX_MODS]; // each module is queued at most once
+};
+
 enum _auto_type_t {
 	AUTO_TYPE_NONE = 0,
 	AUTO_TYPE_MIDI,
@@ -257,6 +380,20 @@ struct _auto_t {
 	};
 };
 
+// lookup tables into mod->automations, all chains hold slot + 1 in ascending order
+struct _auto_index_t {
+	bool has_source; // any automation with enabled source
+	uint64_t port_sources; // port automations with enabled source
+	uint64_t property_sources; // property automations with enabled source
+	uint64_t midi_wild; // MIDI automations with wildcards or in learning mode
+	uint64_t osc_wild; // OSC automations with empty path or in learning mode
+	uint8_t midi [0x10][0x80]; // by channel and controller
+	uint8_t osc [AUTO_HASH]; // by hashed path
+	uint8_t property [AUTO_HASH]; // by property URID
+	uint8_t next_source [MAX_AUTOMATIONS]; // chains of midi and osc tables
+	uint8_t next_property [MAX_AUTOMATIONS]; // chains of property table
+};
+
 struct _mod_t {
 	sp_app_t *app;
 	int32_t uid;
@@ -270,6 +407,12 @@ struct _mod_t {
 	bool needs_bypassing;
 	bool bypassed;
 
+	// incremental save
+	atomic_bool dirty; // state changed since it was last saved to or loaded from state_dir
+	bool dirty_scan; // has state:interface, scan its messages for state changes
+	bool dirty_always; // has state:interface, but no atom output to report state changes on
+	char *state_dir;
+
 	// worker
 	struct {
 		const LV2_Worker_Interface *iface;
@@ -328,8 +471,12 @@ struct _mod_t {
 	// ports
 	unsigned num_ports;
 	port_t *ports;
+	unsigned num_subscribed;
+	uint32_t *subscribed; // indices of ports with subscriptions, ascending
 
 	pool_t pools [PORT_TYPE_NUM];
+	int node; // NUMA node port pools are bound to
+	int node_next; // NUMA node to bind port pools to upon next allocation
 	mod_prof_t prof;
 
 	dsp_client_t dsp_client;
@@ -342,6 +489,8 @@ struct _mod_t {
 	char alias [ALIAS_MAX];
 	LV2_URID ui;
 	auto_t automations [MAX_AUTOMATIONS];
+	auto_index_t auto_indices [2]; // double buffered
+	_Atomic(auto_index_t *) auto_index; // currently active one
 };
 
 struct _port_driver_t {
@@ -421,6 +570,9 @@ struct _port_t {
 
 	size_t size;
 	void *base;
+	void *pool_base; // slice of module pool, base may point into shared arena
+	int arena_idx; // position in arena graph snapshot, -1: not considered
+	port_t *alias; // source port connected zero-copy to plugin, NULL: own buffer
 
 	port_type_t type; // audio, CV, control, atom
 	port_direction_t direction; // input, output
@@ -443,6 +595,98 @@ struct _port_t {
 	};
 };
 
+struct _arena_mod_t {
+	unsigned links; // offset into links
+	unsigned num_links;
+	unsigned ports; // offset into ports
+	unsigned num_ports;
+};
+
+struct _arena_port_t {
+	port_t *port; // only ever dereferenced by master
+	unsigned mod; // position of module in graph
+	size_t size;
+	bool output;
+	bool pinned; // needs a private buffer
+	unsigned sources; // offset into edges
+	unsigned num_sources;
+	int slot; // planned arena slot, -1: private buffer
+};
+
+// audio/CV graph as snapshotted by master and planned on by worker
+struct _arena_graph_t {
+	unsigned num_mods;
+	unsigned num_links;
+	unsigned num_ports;
+	unsigned num_edges;
+	arena_mod_t mods [MAX_MODS];
+	unsigned links [ARENA_LINKS]; // positions of sink modules
+	arena_port_t ports [ARENA_PORTS]; // in module order
+	unsigned edges [ARENA_EDGES]; // positions of source ports
+	mod_set_t reach [MAX_MODS]; // all transitive sinks
+	mod_set_t after [ARENA_SLOTS]; // modules allowed to reuse a slot
+	int64_t saved; // bytes saved compared to private module pools
+};
+
+// shared pool of audio/CV buffers, reused once their previous content is dead
+struct _arena_t {
+	void *buf;
+	size_t size;
+	size_t slot_size;
+	int64_t saved; // bytes saved compared to private module pools
+	arena_graph_t *graph; // owned by worker while planning
+	unsigned epoch; // bumped upon each graph change
+	bool planning; // plan requested from worker
+	bool pending; // graph changed while planning
+};
+
+enum _trace_type_t {
+	TRACE_TYPE_RUN = 0,
+	TRACE_TYPE_MULTIPLEX,
+	TRACE_TYPE_WORKER,
+	TRACE_TYPE_WAKE,
+	TRACE_TYPE_BARRIER,
+
+	TRACE_TYPE_NUM
+};
+
+struct _trace_event_t {
+	uint64_t t0; // ns
+	uint32_t dt; // ns
+	trace_type_t type;
+	LV2_URID urn; // module, 0: none
+};
+
+// flight recorder, single writer overwrites oldest events
+struct _trace_ring_t {
+	alignas(CACHE_LINE_SIZE) atomic_uint head; // events written so far
+	trace_event_t events [TRACE_EVENTS];
+};
+
+// module names snapshot, passed on to worker for the trace file
+struct _trace_name_t {
+	LV2_URID urn;
+	LV2_URID uri;
+	char alias [ALIAS_MAX];
+};
+
+struct _trace_t {
+	trace_ring_t *rings; // one per DSP thread, NULL: disabled
+	unsigned num_rings;
+	atomic_bool request; // dump on demand
+	uint32_t countdown; // samples until dump after xrun
+	uint32_t holdoff; // samples until next dump after xrun is allowed
+	unsigned xrun_dumps;
+	unsigned dumps;
+};
+
+// per DSP thread staging of UI notifications, merged by master after barrier
+struct _post_t {
+	LV2_Atom_Forge *forge; // &app->forge or &local
+	varchunk_t *to_ui; // NULL: write to driver directly
+	LV2_Atom_Forge local;
+};
+
 struct _sp_app_t {
 	sp_app_driver_t *driver;
 	void *data;
@@ -463,6 +707,7 @@ struct _sp_app_t {
 	int embedded;
 	LilvWorld *world;
 	const LilvPlugins *plugs;
+	index_t index;
 
 	reg_t regs;
 	LV2_Atom_Forge forge;
@@ -486,6 +731,11 @@ struct _sp_app_t {
 	char *bundle_filename;
 	LV2_URID bundle_urn; //FIXME use this instead of bundle_path
 
+	struct {
+		pthread_t thread;
+		bool active;
+	} writer; // serializes session files in the background
+
 	struct {
 		unsigned period_cnt;
 		unsigned bound;
@@ -493,6 +743,11 @@ struct _sp_app_t {
 	} fps;
 
 	int ramp_samples;
+	mix_cb_t mix; // SIMD kernel picked at runtime
+	arena_t arena;
+	trace_t trace;
+	post_t *posts; // one per DSP thread, NULL: post serially
+	unsigned num_posts;
 
 	Sratom *sratom;
 	app_prof_t prof;
@@ -502,6 +757,7 @@ struct _sp_app_t {
 	float nleft;
 
 	dsp_master_t dsp_master;
+	worker_pool_t worker_pool;
 
 	LV2_OSC_URID osc_urid;
 
@@ -525,6 +781,8 @@ extern const port_driver_t atom_port_driver;
 extern const port_driver_t seq_port_driver;
 
 #define PORT_BASE_ALIGNED(PORT) ASSUME_ALIGNED((PORT)->base)
+#define PORT_BUFFER(PORT) ((PORT)->alias ? (PORT)->alias->base : (PORT)->base)
+#define PORT_BUFFER_ALIGNED(PORT) ASSUME_ALIGNED(PORT_BUFFER(PORT))
 #define PORT_SIZE(PORT) ((PORT)->size)
 
 /*
@@ -594,6 +852,33 @@ _sp_app_to_ui_overflow(sp_app_t *app)
 	sp_app_log_trace(app, "%s: buffer overflow\n", __func__);
 }
 
+static inline LV2_Atom *
+_sp_app_post_request_atom(sp_app_t *app, post_t *post)
+{
+	if(!post->to_ui)
+		return _sp_app_to_ui_request_atom(app);
+
+	size_t maximum;
+	LV2_Atom *atom = varchunk_write_request_max(post->to_ui, 4096, &maximum);
+
+	if(atom)
+		lv2_atom_forge_set_buffer(post->forge, (uint8_t *)atom, maximum);
+	else
+		sp_app_log_trace(app, "%s: failed to request atom\n", __func__);
+
+	return atom;
+}
+
+// staged only, made visible to master once per module
+static inline void
+_sp_app_post_advance_atom(sp_app_t *app, post_t *post, const LV2_Atom *atom)
+{
+	if(!post->to_ui)
+		_sp_app_to_ui_advance_atom(app, atom);
+	else
+		varchunk_write_stage(post->to_ui, lv2_atom_total_size(atom));
+}
+
 static inline LV2_Atom *
 _sp_request_atom(sp_app_t *app, sp_to_request_t req, void *data)
 {
@@ -672,6 +957,9 @@ _sp_app_state_bundle_save(sp_app_t *app, const char *bundle_path);
 int
 _sp_app_state_bundle_load(sp_app_t *app, const char *bundle_path);
 
+void
+_sp_app_state_writer_join(sp_app_t *app);
+
 /*
  * Mod
  */
@@ -694,18 +982,60 @@ _sp_app_mod_reinitialize(mod_t *mod);
 LV2_Worker_Status
 _sp_app_mod_worker_work_sync(mod_t *mod, size_t size, const void *payload);
 
+void
+_sp_app_mod_worker_signal(mod_t *mod);
+
+void
+_sp_app_mod_worker_pool_init(sp_app_t *app);
+
+void
+_sp_app_mod_worker_pool_deinit(sp_app_t *app);
+
 void
 _sp_app_mod_queue_draw(mod_t *mod);
 
 void
 _sp_app_mod_reinstantiate(sp_app_t *app, mod_t *mod);
 
+/*
+ * Index
+ */
+void
+_sp_app_index_init(sp_app_t *app);
+
+void
+_sp_app_index_deinit(sp_app_t *app);
+
+bool
+_sp_app_index_rebuild(sp_app_t *app);
+
+const index_plug_t *
+_sp_app_index_plug_get(sp_app_t *app, const char *uri);
+
+void
+_sp_app_index_plug_load(sp_app_t *app, const index_plug_t *plug);
+
+void
+_sp_app_index_preset_load(sp_app_t *app, const char *uri);
+
 /*
  * Port
  */
 void 
 _dsp_master_reorder(sp_app_t *app);
 
+void
+_dsp_master_replan(sp_app_t *app);
+
+void
+_dsp_master_rank(sp_app_t *app);
+
+void
+_sp_app_port_subscribe(port_t *port);
+
+void
+_sp_app_port_unsubscribe(port_t *port);
+
 void
 _sp_app_port_disconnect(sp_app_t *app, port_t *src_port, port_t *snk_port);
 
@@ -753,6 +1083,127 @@ _sp_app_port_unlock(control_port_t *control)
 	atomic_flag_clear_explicit(&control->lock, memory_order_release);
 }
 
+/*
+ * Mix
+ */
+mix_cb_t
+_sp_app_mix_dispatch(void);
+
+/*
+ * Arena
+ */
+void
+_sp_app_arena_init(sp_app_t *app);
+
+void
+_sp_app_arena_deinit(sp_app_t *app);
+
+void
+_sp_app_arena_resize(sp_app_t *app);
+
+bool
+_sp_app_arena_owns(sp_app_t *app, const void *ptr);
+
+void
+_sp_app_arena_request(sp_app_t *app);
+
+void
+_sp_app_arena_plan(sp_app_t *app);
+
+void
+_sp_app_arena_apply(sp_app_t *app, unsigned epoch);
+
+/*
+ * JSON
+ */
+// write string escaped for a JSON string literal, shared by trace and stats dumps
+static inline void
+_sp_app_json_string(FILE *f, const char *str)
+{
+	for( ; *str; str++)
+	{
+		if( (*str == '"') || (*str == '\\') )
+			fprintf(f, "\\%c", *str);
+		else if((unsigned char)*str < 0x20)
+			fprintf(f, "\\u%04x", *str);
+		else
+			fputc(*str, f);
+	}
+}
+
+/*
+ * Trace
+ */
+void
+_sp_app_trace_init(sp_app_t *app);
+
+void
+_sp_app_trace_deinit(sp_app_t *app);
+
+void
+_sp_app_trace_schedule(sp_app_t *app, uint32_t nsamples, bool xrun);
+
+void
+_sp_app_trace_dump(sp_app_t *app, unsigned num_names, const trace_name_t *names);
+
+static inline void
+_sp_app_trace(sp_app_t *app, unsigned tid, trace_type_t type, LV2_URID urn,
+	uint64_t t0, uint64_t t1)
+{
+	trace_ring_t *ring = &app->trace.rings[tid];
+	const unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	trace_event_t *ev = &ring->events[head & (TRACE_EVENTS - 1)];
+
+	ev->t0 = t0;
+	ev->dt = t1 - t0;
+	ev->type = type;
+	ev->urn = urn;
+
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/*
+ * Stats
+ */
+void
+_sp_app_stats_report(sp_app_t *app);
+
+void
+_sp_app_stats_dump(sp_app_t *app, unsigned num_stats, const stats_t *stats);
+
+static inline unsigned
+_sp_app_hist_bucket(uint32_t v)
+{
+	if(v < HIST_SUB)
+		return v;
+
+	const unsigned e = 31 - __builtin_clz(v);
+
+	return (e - HIST_SUB_BITS + 1)*HIST_SUB + ((v >> (e - HIST_SUB_BITS)) & (HIST_SUB - 1));
+}
+
+// only ever written by the thread running the module, read after the barrier
+static inline void
+_sp_app_hist_add(hist_t *hist, uint32_t v, uint32_t budget)
+{
+	hist->buckets[_sp_app_hist_bucket(v)] += 1;
+	hist->count += 1;
+
+	if(v > budget)
+		hist->over += 1;
+	if(v > hist->max)
+		hist->max = v;
+}
+
+/*
+ * Topo
+ */
+void
+_sp_app_topo_plan(sp_app_t *app);
+
+void
+_sp_app_topo_migrate(sp_app_t *app, mod_t *mod);
+
 /*
  * Ui
  */
@@ -771,12 +1222,36 @@ _automation_refresh_mul_add(auto_t *automation);
 void
 _automation_list_add(sp_app_t *app, const LV2_Atom_Object *obj);
 
+void
+_automation_index_rebuild(mod_t *mod);
+
+// FNV-1a over at most the bytes compared for OSC automation paths
+static inline uint32_t
+_automation_hash(const char *path)
+{
+	uint32_t hash = 0x811c9dc5;
+
+	for(unsigned i = 0; (i < sizeof(((osc_auto_t *)0)->path)) && path[i]; i++)
+	{
+		hash ^= (uint8_t)path[i];
+		hash *= 0x01000193;
+	}
+
+	return hash & (AUTO_HASH - 1);
+}
+
+static inline const auto_index_t *
+_automation_index(mod_t *mod)
+{
+	return atomic_load_explicit(&mod->auto_index, memory_order_acquire);
+}
+
 LV2_Atom_Forge_Ref
-_sp_app_forge_midi_automation(sp_app_t *app, LV2_Atom_Forge_Frame *frame,
+_sp_app_forge_midi_automation(sp_app_t *app, LV2_Atom_Forge *forge, LV2_Atom_Forge_Frame *frame,
 	mod_t *mod, port_t *port, const auto_t *automation);
 
 LV2_Atom_Forge_Ref
-_sp_app_forge_osc_automation(sp_app_t *app, LV2_Atom_Forge_Frame *frame,
+_sp_app_forge_osc_automation(sp_app_t *app, LV2_Atom_Forge *forge, LV2_Atom_Forge_Frame *frame,
 	mod_t *mod, port_t *port, const auto_t *automation);
 
 #endif
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#ifndef _SYNTHPOD_APP_SEQ_H
+#define _SYNTHPOD_APP_SEQ_H
+
+#include <synthpod_app_private.h>
+
+// min-heap of source iterators ordered by time of their next event
+typedef struct _seq_heap_t seq_heap_t;
+
+struct _seq_heap_t {
+	unsigned num;
+	int srcs [MAX_SOURCES + 1];
+	int64_t frames [MAX_SOURCES + 1]; // indexed by source
+};
+
+__realtime static inline bool
+_seq_heap_less(const seq_heap_t *heap, int a, int b)
+{
+	// ties are resolved by source index to keep merge order stable
+	return (heap->frames[a] < heap->frames[b])
+		|| ( (heap->frames[a] == heap->frames[b]) && (a < b) );
+}
+
+__realtime static inline void
+_seq_heap_sift_down(seq_heap_t *heap, unsigned i)
+{
+	const int src = heap->srcs[i];
+
+	while(true)
+	{
+		unsigned c = 2*i + 1;
+		if(c >= heap->num)
+			break;
+
+		if( (c + 1 < heap->num) && _seq_heap_less(heap, heap->srcs[c + 1], heap->srcs[c]) )
+			c += 1;
+
+		if(!_seq_heap_less(heap, heap->srcs[c], src))
+			break;
+
+		heap->srcs[i] = heap->srcs[c];
+		i = c;
+	}
+
+	heap->srcs[i] = src;
+}
+
+__realtime static inline void
+_seq_heap_push(seq_heap_t *heap, int src, int64_t frames)
+{
+	unsigned i = heap->num++;
+
+	heap->frames[src] = frames;
+
+	while(i > 0)
+	{
+		const unsigned parent = (i - 1) / 2;
+
+		if(!_seq_heap_less(heap, src, heap->srcs[parent]))
+			break;
+
+		heap->srcs[i] = heap->srcs[parent];
+		i = parent;
+	}
+
+	heap->srcs[i] = src;
+}
+
+__realtime static inline void
+_seq_heap_pop(seq_heap_t *heap)
+{
+	heap->srcs[0] = heap->srcs[--heap->num];
+	_seq_heap_sift_down(heap, 0);
+}
+
+// replace top with its advanced iterator
+__realtime static inline void
+_seq_heap_replace(seq_heap_t *heap, int64_t frames)
+{
+	heap->frames[heap->srcs[0]] = frames;
+	_seq_heap_sift_down(heap, 0);
+}
+
+// append all events of a single source before nsamples in one go
+__realtime static inline bool
+_port_seq_bulk_copy(LV2_Atom_Sequence *dst, uint32_t capacity,
+	const LV2_Atom_Sequence *seq, uint32_t nsamples)
+{
+	const LV2_Atom_Event *from = lv2_atom_sequence_begin(&seq->body);
+	const LV2_Atom_Event *to = from;
+
+	LV2_ATOM_SEQUENCE_FOREACH(seq, ev)
+	{
+		if(ev->time.frames >= nsamples)
+			break;
+
+		to = lv2_atom_sequence_next(ev);
+	}
+
+	const uint32_t size = (const uint8_t *)to - (const uint8_t *)from;
+
+	if(capacity - sizeof(LV2_Atom) - dst->atom.size < size)
+		return false; // let slow path append as many events as possible
+
+	memcpy(lv2_atom_sequence_end(&dst->body, dst->atom.size), from, size);
+	dst->atom.size += size;
+
+	return true;
+}
+
+// seed heap with first event of each source within this period
+__realtime static inline void
+_seq_heap_seed(seq_heap_t *heap, const LV2_Atom_Sequence *const *seq,
+	const LV2_Atom_Event **itr, int num_sources, uint32_t nsamples)
+{
+	for(int s=0; s<num_sources; s++)
+	{
+		if(lv2_atom_sequence_is_end(&seq[s]->body, seq[s]->atom.size, itr[s]))
+			continue; // empty sequence
+
+		if(itr[s]->time.frames < nsamples)
+			_seq_heap_push(heap, s, itr[s]->time.frames);
+	}
+}
+
+// advance iterator of source on top of heap after its event was processed
+__realtime static inline void
+_seq_heap_advance(seq_heap_t *heap, const LV2_Atom_Sequence *const *seq,
+	const LV2_Atom_Event **itr, uint32_t nsamples)
+{
+	const int nxt = heap->srcs[0];
+
+	itr[nxt] = lv2_atom_sequence_next(itr[nxt]);
+
+	if(  lv2_atom_sequence_is_end(&seq[nxt]->body, seq[nxt]->atom.size, itr[nxt])
+		|| (itr[nxt]->time.frames >= nsamples) )
+	{
+		_seq_heap_pop(heap); // no more events to process for this source
+	}
+	else
+	{
+		_seq_heap_replace(heap, itr[nxt]->time.frames);
+	}
+}
+
+#endif
@@ -16,10 +16,22 @@
  */
 
 #include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if !defined(_WIN32)
+#	include <sys/mman.h>
+#endif
 
 #include <synthpod_app_private.h>
 
+#define MAX_LOADERS 8
+
 typedef struct _atom_ser_t atom_ser_t;
+typedef struct _state_writer_t state_writer_t;
+typedef struct _mod_load_t mod_load_t;
+typedef struct _mod_loader_t mod_loader_t;
+typedef struct _mod_loader_thread_t mod_loader_thread_t;
 
 struct _atom_ser_t {
 	uint32_t size;
@@ -27,6 +39,39 @@ struct _atom_ser_t {
 	uint32_t offset;
 };
 
+struct _state_writer_t {
+	sp_app_t *app;
+	Sratom *sratom; // private one, app->sratom stays with the worker
+	char *manifest_dst;
+	char *state_dst;
+	char *cache_dst;
+	atom_ser_t manifest;
+	atom_ser_t state;
+	LV2_Atom_Forge_Ref state_ref; // state:state object in state buffer
+};
+
+struct _mod_load_t {
+	int32_t mod_uid;
+	LV2_URID mod_urn;
+	LV2_Atom_Object *mod_obj;
+	mod_t *mod;
+	LilvState *state; // pending state for serial restore, parsed in a loader world
+};
+
+struct _mod_loader_t {
+	sp_app_t *app;
+	const LV2_State_Map_Path *map_path;
+	mod_load_t *loads;
+	unsigned num_loads;
+	atomic_uint next;
+};
+
+struct _mod_loader_thread_t {
+	mod_loader_t *loader;
+	LilvWorld *world;
+	pthread_t thread;
+};
+
 __non_realtime static char *
 _abstract_path(LV2_State_Map_Path_Handle instance, const char *absolute_path)
 {
@@ -79,11 +124,12 @@ _preset_schedule_work_async(LV2_Worker_Schedule_Handle instance, uint32_t size,
 	mod_worker_t *mod_worker = &mod->mod_worker;
 
 	void *target;
-	if((target = varchunk_write_request(mod_worker->state_to_worker, size)))
+	if(  mod_worker->state_to_worker
+		&& (target = varchunk_write_request(mod_worker->state_to_worker, size)) )
 	{
 		memcpy(target, data, size);
 		varchunk_write_advance(mod_worker->state_to_worker, size);
-		sem_post(&mod_worker->sem);
+		_sp_app_mod_worker_signal(mod);
 
 		return LV2_WORKER_SUCCESS;
 	}
@@ -152,24 +198,26 @@ _state_set_value(const char *symbol, void *data,
 	mod_t *mod = data;
 	sp_app_t *app = mod->app;
 
-	LilvNode *symbol_uri = lilv_new_string(app->world, symbol);
-	if(!symbol_uri)
+	// look up port by symbol without touching the lilv world, as module states
+	// may be restored from several loader threads concurrently
+	port_t *tar = NULL;
+	for(unsigned p = 0; p < mod->num_ports; p++)
 	{
-		sp_app_log_error(app, "%s: invalid symbol\n", __func__);
-		return;
+		port_t *port = &mod->ports[p];
+
+		if(!strcmp(port->symbol, symbol))
+		{
+			tar = port;
+			break;
+		}
 	}
 
-	const LilvPort *port = lilv_plugin_get_port_by_symbol(mod->plug, symbol_uri);
-	lilv_node_free(symbol_uri);
-	if(!port)
+	if(!tar)
 	{
 		sp_app_log_error(app, "%s: failed to get port by symbol\n", __func__);
 		return;
 	}
 
-	uint32_t index = lilv_port_get_index(mod->plug, port);
-	port_t *tar = &mod->ports[index];
-
 	float val = 0.f;
 
 	if( (type == app->forge.Int) && (size == sizeof(int32_t)) )
@@ -290,6 +338,8 @@ _sp_app_state_preset_restore(sp_app_t *app, mod_t *mod, LilvState *const state,
 {
 	lilv_state_restore(state, mod->inst, _state_set_value, mod,
 		LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE, _preset_features(mod, async));
+
+	atomic_store(&mod->dirty, true);
 }
 
 int
@@ -303,7 +353,8 @@ _sp_app_state_preset_load(sp_app_t *app, mod_t *mod, const char *uri, bool async
 		return -1;
 	}
 
-	// load preset resource
+	// load preset bundle, if not discovered yet, and preset resource
+	_sp_app_index_preset_load(app, uri);
 	lilv_world_load_resource(app->world, preset);
 
 	// load preset
@@ -498,23 +549,45 @@ synthpod_to_turtle(Sratom* sratom, LV2_URID_Unmap* unmap,
 	return NULL;
 }
 
-static inline void
+static inline bool
 _serialize_to_turtle(Sratom *sratom, LV2_URID_Unmap *unmap, const LV2_Atom *atom, const char *path)
 {
-	FILE *f = fopen(path, "wb");
-	if(f)
+	char *ttl = synthpod_to_turtle(sratom, unmap,
+		atom->type, atom->size, LV2_ATOM_BODY_CONST(atom));
+	if(!ttl)
+		return false;
+
+	// write to temporary file first, so an interrupted save never truncates path
+	char *tmp_path = NULL;
+	if(asprintf(&tmp_path, "%s.tmp", path) == -1)
 	{
-		char *ttl = synthpod_to_turtle(sratom, unmap,
-			atom->type, atom->size, LV2_ATOM_BODY_CONST(atom));
+		free(ttl);
+		return false;
+	}
 
-		if(ttl)
+	bool failed = true;
+	FILE *f = fopen(tmp_path, "wb");
+	if(f)
+	{
+		const size_t len = strlen(ttl);
+
+		failed = len && (fwrite(ttl, len, 1, f) != 1);
+		failed |= fclose(f) != 0;
+#if defined(_WIN32)
+		if(!failed)
+			remove(path); // rename does not replace existing files on windows
+#endif
+		if(failed || rename(tmp_path, path))
 		{
-			fprintf(f, "%s", ttl);
-			free(ttl);
+			unlink(tmp_path);
+			failed = true;
 		}
-
-		fclose(f);
 	}
+
+	free(tmp_path);
+	free(ttl);
+
+	return !failed;
 }
 
 static inline LV2_Atom_Object *
@@ -554,6 +627,377 @@ _deserialize_from_turtle(Sratom *sratom, LV2_URID_Unmap *unmap, const char *path
 
 #undef CUINT8
 
+// binary session cache next to state.ttl, laid out as
+//   state_cache_t header
+//   uint32_t urids [num_urids], sorted, 8-byte padded
+//   NUL-terminated URIs in the same order, uris_size bytes, 8-byte padded
+//   LV2_Atom of the state object
+// it is only valid as long as state.ttl has not been touched since
+#define STATE_CACHE_MAGIC "spodatom"
+#define STATE_CACHE_VERSION 1
+#define STATE_CACHE_PAD(size) (((size) + 7U) & (~7U))
+
+typedef struct _state_cache_t state_cache_t;
+typedef struct _state_cache_urids_t state_cache_urids_t;
+typedef bool (*_state_cache_cb_t)(LV2_URID *urid, void *data);
+
+struct _state_cache_t {
+	char magic [8];
+	uint32_t version;
+	uint32_t num_urids;
+	int64_t ttl_mtime_sec;
+	int64_t ttl_mtime_nsec;
+	uint64_t ttl_size;
+	uint64_t uris_size;
+};
+
+struct _state_cache_urids_t {
+	uint32_t num_urids;
+	uint32_t max_urids;
+	LV2_URID *urids;
+	const LV2_URID *keys; // sorted URIDs of cache file
+	const LV2_URID *vals; // mapped URIDs of running session
+};
+
+static bool
+_state_cache_urid(LV2_URID *urid, _state_cache_cb_t cb, void *data)
+{
+	return (*urid == 0) || cb(urid, data);
+}
+
+// calls back for every URID in atom, the atom type is passed first, so callbacks
+// may translate it in place before it is compared to the forge types
+static bool
+_state_cache_walk(const LV2_Atom_Forge *forge, LV2_Atom *atom,
+	_state_cache_cb_t cb, void *data)
+{
+	if(!_state_cache_urid(&atom->type, cb, data))
+		return false;
+
+	if(atom->type == forge->URID)
+	{
+		return _state_cache_urid(&((LV2_Atom_URID *)atom)->body, cb, data);
+	}
+	else if(atom->type == forge->Literal)
+	{
+		LV2_Atom_Literal *lit = (LV2_Atom_Literal *)atom;
+
+		return _state_cache_urid(&lit->body.datatype, cb, data)
+			&& _state_cache_urid(&lit->body.lang, cb, data);
+	}
+	else if(lv2_atom_forge_is_object_type(forge, atom->type))
+	{
+		LV2_Atom_Object *obj = (LV2_Atom_Object *)atom;
+
+		if(  !_state_cache_urid(&obj->body.id, cb, data)
+			|| !_state_cache_urid(&obj->body.otype, cb, data) )
+			return false;
+
+		LV2_ATOM_OBJECT_FOREACH(obj, prop)
+		{
+			if(  !_state_cache_urid(&prop->key, cb, data)
+				|| !_state_cache_urid(&prop->context, cb, data)
+				|| !_state_cache_walk(forge, &prop->value, cb, data) )
+				return false;
+		}
+	}
+	else if(atom->type == forge->Tuple)
+	{
+		LV2_Atom_Tuple *tup = (LV2_Atom_Tuple *)atom;
+
+		LV2_ATOM_TUPLE_FOREACH(tup, item)
+		{
+			if(!_state_cache_walk(forge, item, cb, data))
+				return false;
+		}
+	}
+	else if(atom->type == forge->Sequence)
+	{
+		LV2_Atom_Sequence *seq = (LV2_Atom_Sequence *)atom;
+
+		if(!_state_cache_urid(&seq->body.unit, cb, data))
+			return false;
+
+		LV2_ATOM_SEQUENCE_FOREACH(seq, ev)
+		{
+			if(!_state_cache_walk(forge, &ev->body, cb, data))
+				return false;
+		}
+	}
+	else if(atom->type == forge->Vector)
+	{
+		LV2_Atom_Vector *vec = (LV2_Atom_Vector *)atom;
+
+		if(!_state_cache_urid(&vec->body.child_type, cb, data))
+			return false;
+
+		if( (vec->body.child_type == forge->URID)
+			&& (vec->body.child_size == sizeof(LV2_URID)) )
+		{
+			LV2_URID *urids = LV2_ATOM_CONTENTS(LV2_Atom_Vector, atom);
+			const uint32_t num = (atom->size - sizeof(LV2_Atom_Vector_Body)) / sizeof(LV2_URID);
+
+			for(uint32_t i = 0; i < num; i++)
+			{
+				if(!_state_cache_urid(&urids[i], cb, data))
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool
+_state_cache_collect(LV2_URID *urid, void *data)
+{
+	state_cache_urids_t *cache = data;
+
+	if(cache->num_urids == cache->max_urids)
+	{
+		const uint32_t max_urids = cache->max_urids ? cache->max_urids << 1 : 256;
+		LV2_URID *urids = realloc(cache->urids, max_urids * sizeof(LV2_URID));
+		if(!urids)
+			return false;
+
+		cache->urids = urids;
+		cache->max_urids = max_urids;
+	}
+
+	cache->urids[cache->num_urids++] = *urid;
+
+	return true;
+}
+
+static int
+_state_cache_cmp(const void *a, const void *b)
+{
+	const LV2_URID *urid_a = a;
+	const LV2_URID *urid_b = b;
+
+	return (*urid_a > *urid_b) - (*urid_a < *urid_b);
+}
+
+static bool
+_state_cache_remap(LV2_URID *urid, void *data)
+{
+	state_cache_urids_t *cache = data;
+
+	const LV2_URID *key = bsearch(urid, cache->keys, cache->num_urids,
+		sizeof(LV2_URID), _state_cache_cmp);
+	if(!key)
+		return false;
+
+	*urid = cache->vals[key - cache->keys];
+
+	return true;
+}
+
+static inline void
+_serialize_to_cache(sp_app_t *app, const LV2_Atom *atom, const char *path,
+	const char *ttl_path)
+{
+#if !defined(_WIN32)
+	struct stat st;
+	if(stat(ttl_path, &st) != 0)
+		return;
+
+	// gather unique URIDs
+	state_cache_urids_t cache = { .num_urids = 0 };
+	if(!_state_cache_walk(&app->forge, (LV2_Atom *)atom, _state_cache_collect, &cache))
+	{
+		sp_app_log_error(app, "%s: URID collection failed\n", __func__);
+		free(cache.urids);
+		return;
+	}
+
+	qsort(cache.urids, cache.num_urids, sizeof(LV2_URID), _state_cache_cmp);
+
+	uint32_t num_urids = 0;
+	uint64_t uris_size = 0;
+	for(uint32_t i = 0; i < cache.num_urids; i++)
+	{
+		if(num_urids && (cache.urids[i] == cache.urids[num_urids - 1]) )
+			continue;
+
+		const char *uri = app->driver->unmap->unmap(app->driver->unmap->handle, cache.urids[i]);
+		if(!uri)
+		{
+			sp_app_log_error(app, "%s: failed to unmap URID %"PRIu32"\n", __func__, cache.urids[i]);
+			free(cache.urids);
+			return;
+		}
+
+		cache.urids[num_urids++] = cache.urids[i];
+		uris_size += strlen(uri) + 1;
+	}
+
+	state_cache_t hdr = {
+		.version = STATE_CACHE_VERSION,
+		.num_urids = num_urids,
+		.ttl_mtime_sec = st.st_mtim.tv_sec,
+		.ttl_mtime_nsec = st.st_mtim.tv_nsec,
+		.ttl_size = st.st_size,
+		.uris_size = uris_size
+	};
+	memcpy(hdr.magic, STATE_CACHE_MAGIC, sizeof(hdr.magic));
+
+	// write to temporary file first, so a partial cache is never picked up
+	char *tmp_path = NULL;
+	if(asprintf(&tmp_path, "%s.tmp", path) == -1)
+	{
+		free(cache.urids);
+		return;
+	}
+
+	FILE *f = fopen(tmp_path, "wb");
+	if(f)
+	{
+		static const uint8_t pad [8] = { 0 };
+		const size_t urids_size = num_urids * sizeof(LV2_URID);
+		const size_t urids_pad = STATE_CACHE_PAD(urids_size) - urids_size;
+		const size_t uris_pad = STATE_CACHE_PAD(uris_size) - uris_size;
+		bool failed = false;
+
+		failed |= fwrite(&hdr, sizeof(hdr), 1, f) != 1;
+		failed |= urids_size && (fwrite(cache.urids, urids_size, 1, f) != 1);
+		failed |= urids_pad && (fwrite(pad, urids_pad, 1, f) != 1);
+
+		for(uint32_t i = 0; i < num_urids; i++)
+		{
+			const char *uri = app->driver->unmap->unmap(app->driver->unmap->handle, cache.urids[i]);
+
+			failed |= fwrite(uri, strlen(uri) + 1, 1, f) != 1;
+		}
+
+		failed |= uris_pad && (fwrite(pad, uris_pad, 1, f) != 1);
+		failed |= fwrite(atom, lv2_atom_total_size(atom), 1, f) != 1;
+		failed |= fclose(f) != 0;
+
+		if(failed || rename(tmp_path, path))
+		{
+			sp_app_log_error(app, "%s: failed to write cache\n", __func__);
+			unlink(tmp_path);
+		}
+	}
+
+	free(tmp_path);
+	free(cache.urids);
+#else
+	(void)app;
+	(void)atom;
+	(void)path;
+	(void)ttl_path;
+#endif
+}
+
+static inline LV2_Atom_Object *
+_deserialize_from_cache(sp_app_t *app, const char *path, const char *ttl_path)
+{
+	LV2_Atom_Object *obj = NULL;
+
+#if !defined(_WIN32)
+	struct stat ttl_st;
+	if(stat(ttl_path, &ttl_st) != 0)
+		return NULL;
+
+	const int fd = open(path, O_RDONLY);
+	if(fd == -1)
+		return NULL; // no cache
+
+	struct stat st;
+	if( (fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(state_cache_t)) )
+	{
+		close(fd);
+		return NULL;
+	}
+
+	const size_t size = st.st_size;
+	const uint8_t *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED)
+		return NULL;
+
+	const state_cache_t *hdr = (const state_cache_t *)base;
+	const size_t urids_size = STATE_CACHE_PAD(hdr->num_urids * sizeof(LV2_URID));
+	const size_t offset = sizeof(state_cache_t) + urids_size + STATE_CACHE_PAD(hdr->uris_size);
+
+	// invalidate cache when state.ttl has been modified since
+	if(  memcmp(hdr->magic, STATE_CACHE_MAGIC, sizeof(hdr->magic))
+		|| (hdr->version != STATE_CACHE_VERSION)
+		|| (hdr->ttl_mtime_sec != ttl_st.st_mtim.tv_sec)
+		|| (hdr->ttl_mtime_nsec != ttl_st.st_mtim.tv_nsec)
+		|| (hdr->ttl_size != (uint64_t)ttl_st.st_size)
+		|| (hdr->uris_size > size)
+		|| (offset + sizeof(LV2_Atom) > size) )
+	{
+		sp_app_log_note(app, "%s: stale cache\n", __func__);
+		goto unmap;
+	}
+
+	const LV2_Atom *atom = (const LV2_Atom *)(base + offset);
+	const size_t atom_size = lv2_atom_total_size(atom);
+
+	if(offset + atom_size > size)
+	{
+		sp_app_log_error(app, "%s: corrupt cache\n", __func__);
+		goto unmap;
+	}
+
+	// map URIs of cache file into running session
+	state_cache_urids_t cache = {
+		.num_urids = hdr->num_urids,
+		.keys = (const LV2_URID *)(base + sizeof(state_cache_t))
+	};
+	LV2_URID *vals = calloc(hdr->num_urids + 1, sizeof(LV2_URID));
+	if(!vals)
+		goto unmap;
+
+	const char *uri = (const char *)(base + sizeof(state_cache_t) + urids_size);
+	const char *end = uri + hdr->uris_size;
+	for(uint32_t i = 0; i < hdr->num_urids; i++)
+	{
+		const char *nul = memchr(uri, '\0', end - uri);
+		if(!nul)
+		{
+			sp_app_log_error(app, "%s: corrupt cache\n", __func__);
+			goto free_vals;
+		}
+
+		vals[i] = app->driver->map->map(app->driver->map->handle, uri);
+		uri = nul + 1;
+	}
+	cache.vals = vals;
+
+	// remap in one pass on a private copy, which is freed by the caller
+	obj = malloc(atom_size);
+	if(obj)
+	{
+		memcpy(obj, atom, atom_size);
+
+		if(  !_state_cache_walk(&app->forge, &obj->atom, _state_cache_remap, &cache)
+			|| !lv2_atom_forge_is_object_type(&app->forge, obj->atom.type) )
+		{
+			sp_app_log_error(app, "%s: invalid cache\n", __func__);
+			free(obj);
+			obj = NULL;
+		}
+	}
+
+free_vals:
+	free(vals);
+
+unmap:
+	munmap((void *)base, size);
+#else
+	(void)app;
+	(void)path;
+	(void)ttl_path;
+#endif
+
+	return obj;
+}
+
 // non-rt / rt
 __non_realtime static LV2_State_Status
 _state_store(LV2_State_Handle state, uint32_t key, const void *value,
@@ -617,6 +1061,9 @@ _sp_app_state_bundle_load(sp_app_t *app, const char *bundle_path)
 {
 	//printf("_bundle_load: %s\n", bundle_path);
 
+	// files of a pending save may be the very ones we are about to load
+	_sp_app_state_writer_join(app);
+
 	if(!app->sratom)
 	{
 		sp_app_log_error(app, "%s: invalid sratom\n", __func__);
@@ -640,7 +1087,17 @@ _sp_app_state_bundle_load(sp_app_t *app, const char *bundle_path)
 		return -1;
 	}
 
-	LV2_Atom_Object *obj = _deserialize_from_turtle(app->sratom, app->driver->unmap, state_dst);
+	char *cache_dst = _make_path(app->bundle_path, "state.atom");
+
+	LV2_Atom_Object *obj = cache_dst
+		? _deserialize_from_cache(app, cache_dst, state_dst)
+		: NULL;
+	if(!obj) // fall back to portable but slower turtle
+		obj = _deserialize_from_turtle(app->sratom, app->driver->unmap, state_dst);
+
+	if(cache_dst)
+		free(cache_dst);
+
 	if(obj) // existing project
 	{
 		// restore state
@@ -702,11 +1159,95 @@ _deref(LV2_Atom_Forge_Sink_Handle handle, LV2_Atom_Forge_Ref ref)
 	return (LV2_Atom *)(ser->buf + offset);
 }
 
+__non_realtime static void
+_state_writer_free(state_writer_t *writer)
+{
+	if(writer->sratom)
+		sratom_free(writer->sratom);
+	if(writer->manifest_dst)
+		free(writer->manifest_dst);
+	if(writer->state_dst)
+		free(writer->state_dst);
+	if(writer->cache_dst)
+		free(writer->cache_dst);
+	if(writer->manifest.buf)
+		free(writer->manifest.buf);
+	if(writer->state.buf)
+		free(writer->state.buf);
+
+	free(writer);
+}
+
+__non_realtime static void
+_state_writer_run(state_writer_t *writer)
+{
+	sp_app_t *app = writer->app;
+
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+
+	if(writer->manifest.buf)
+	{
+		const LV2_Atom *atom = (const LV2_Atom *)writer->manifest.buf;
+
+		if(!_serialize_to_turtle(writer->sratom, app->driver->unmap, atom, writer->manifest_dst))
+			sp_app_log_error(app, "%s: failed to write %s\n", __func__, writer->manifest_dst);
+	}
+
+	if(writer->state.buf)
+	{
+		const LV2_Atom *atom = (const LV2_Atom *)writer->state.buf;
+
+		if(_serialize_to_turtle(writer->sratom, app->driver->unmap, atom, writer->state_dst))
+		{
+			// cache state:state object for faster loading
+			if(writer->cache_dst)
+			{
+				_serialize_to_cache(app, _deref(&writer->state, writer->state_ref),
+					writer->cache_dst, writer->state_dst);
+			}
+		}
+		else
+		{
+			sp_app_log_error(app, "%s: failed to write %s\n", __func__, writer->state_dst);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	const double ms = (t1.tv_sec - t0.tv_sec)*1e3 + (t1.tv_nsec - t0.tv_nsec)*1e-6;
+
+	sp_app_log_note(app, "%s: wrote session in %.1f ms\n", __func__, ms);
+}
+
+__non_realtime static void *
+_state_writer_thread(void *data)
+{
+	state_writer_t *writer = data;
+
+	_state_writer_run(writer);
+	_state_writer_free(writer);
+
+	return NULL;
+}
+
+void
+_sp_app_state_writer_join(sp_app_t *app)
+{
+	if(!app->writer.active)
+		return;
+
+	pthread_join(app->writer.thread, NULL);
+	app->writer.active = false;
+}
+
 int
 _sp_app_state_bundle_save(sp_app_t *app, const char *bundle_path)
 {
 	//printf("_bundle_save: %s\n", bundle_path);
 
+	// previous save must have hit the disk before we overwrite its files
+	_sp_app_state_writer_join(app);
+
 	if(app->bundle_path)
 		free(app->bundle_path);
 
@@ -717,120 +1258,237 @@ _sp_app_state_bundle_save(sp_app_t *app, const char *bundle_path)
 		return -1;
 	}
 
-	char *manifest_dst = _make_path(app->bundle_path, "manifest.ttl");
-	char *state_dst = _make_path(app->bundle_path, "state.ttl");
-	if(manifest_dst && state_dst)
+	if(!app->sratom)
+	{
+		sp_app_log_error(app, "%s: invalid sratom\n", __func__);
+		return LV2_STATE_SUCCESS;
+	}
+
+	state_writer_t *writer = calloc(1, sizeof(state_writer_t));
+	if(!writer)
+	{
+		sp_app_log_error(app, "%s: writer allocation failed\n", __func__);
+		return LV2_STATE_ERR_UNKNOWN;
+	}
+
+	writer->app = app;
+	writer->manifest_dst = _make_path(app->bundle_path, "manifest.ttl");
+	writer->state_dst = _make_path(app->bundle_path, "state.ttl");
+	writer->cache_dst = _make_path(app->bundle_path, "state.atom");
+	writer->sratom = sratom_new(app->driver->map);
+	if(!writer->manifest_dst || !writer->state_dst)
+	{
+		sp_app_log_error(app, "%s: _make_path failed\n", __func__);
+		_state_writer_free(writer);
+		return LV2_STATE_ERR_UNKNOWN;
+	}
+	if(!writer->sratom)
 	{
-		// create temporary forge
-		LV2_Atom_Forge _forge;
-		LV2_Atom_Forge *forge = &_forge;
-		memcpy(forge, &app->forge, sizeof(LV2_Atom_Forge));
+		sp_app_log_error(app, "%s: invalid sratom\n", __func__);
+		_state_writer_free(writer);
+		return LV2_STATE_ERR_UNKNOWN;
+	}
+	sratom_set_pretty_numbers(writer->sratom, false);
+
+	// create temporary forge
+	LV2_Atom_Forge _forge;
+	LV2_Atom_Forge *forge = &_forge;
+	memcpy(forge, &app->forge, sizeof(LV2_Atom_Forge));
 
-		LV2_Atom_Forge_Frame pset_frame;
-		LV2_Atom_Forge_Frame state_frame;
+	LV2_Atom_Forge_Frame pset_frame;
+	LV2_Atom_Forge_Frame state_frame;
+
+	atom_ser_t *ser = &writer->manifest;
+	ser->size = 1024;
+	ser->offset = 0;
+	ser->buf = malloc(ser->size);
+	lv2_atom_forge_set_sink(forge, _sink, _deref, ser);
+
+	if(  ser->buf
+		&& lv2_atom_forge_object(forge, &pset_frame, app->regs.synthpod.state.urid, app->regs.pset.preset.urid)
+		&& lv2_atom_forge_key(forge, app->regs.core.applies_to.urid)
+		&& lv2_atom_forge_urid(forge, app->regs.synthpod.stereo.urid)
+		&& lv2_atom_forge_key(forge, app->regs.core.applies_to.urid)
+		&& lv2_atom_forge_urid(forge, app->regs.synthpod.monoatom.urid)
+		&& lv2_atom_forge_key(forge, app->regs.rdfs.see_also.urid)
+		&& lv2_atom_forge_urid(forge, app->regs.synthpod.state.urid) )
+	{
+		lv2_atom_forge_pop(forge, &pset_frame);
+	}
+	else
+	{
+		sp_app_log_error(app, "%s: forge failed\n", __func__);
+		free(ser->buf);
+		ser->buf = NULL;
+	}
 
-		if(app->sratom)
+	ser = &writer->state;
+	ser->size = 4096;
+	ser->offset = 0;
+	ser->buf = malloc(ser->size);
+	lv2_atom_forge_set_sink(forge, _sink, _deref, ser);
+
+	// try to extract label from bundle path
+	char *rdfs_label = NULL;
+	const char *from = strstr(app->bundle_path, "Synthpod_Stereo");
+	const char *to = strstr(app->bundle_path, ".preset.lv2");
+	if(from && to)
+	{
+		from += 15 + 1;
+		const size_t sz = to - from;
+		rdfs_label = malloc(sz + 1);
+		if(rdfs_label)
 		{
-			atom_ser_t ser = { .size = 1024, .offset = 0 };
-			ser.buf = malloc(ser.size);
-			lv2_atom_forge_set_sink(forge, _sink, _deref, &ser);
-
-			if(  ser.buf
-				&& lv2_atom_forge_object(forge, &pset_frame, app->regs.synthpod.state.urid, app->regs.pset.preset.urid)
-				&& lv2_atom_forge_key(forge, app->regs.core.applies_to.urid)
-				&& lv2_atom_forge_urid(forge, app->regs.synthpod.stereo.urid)
-				&& lv2_atom_forge_key(forge, app->regs.core.applies_to.urid)
-				&& lv2_atom_forge_urid(forge, app->regs.synthpod.monoatom.urid)
-				&& lv2_atom_forge_key(forge, app->regs.rdfs.see_also.urid)
-				&& lv2_atom_forge_urid(forge, app->regs.synthpod.state.urid) )
-			{
-				lv2_atom_forge_pop(forge, &pset_frame);
+			strncpy(rdfs_label, from, sz);
+			rdfs_label[sz] = '\0';
+		}
+	}
 
-				const LV2_Atom *atom = (const LV2_Atom *)ser.buf;
-				_serialize_to_turtle(app->sratom, app->driver->unmap, atom, manifest_dst);
-				free(ser.buf);
-			}
-			else
-			{
-				sp_app_log_error(app, "%s: forge failed\n", __func__);
-			}
+	if(  ser->buf
+		&& lv2_atom_forge_object(forge, &pset_frame, app->regs.synthpod.null.urid, app->regs.pset.preset.urid)
+		&& lv2_atom_forge_key(forge, app->regs.core.applies_to.urid)
+		&& lv2_atom_forge_urid(forge, app->regs.synthpod.stereo.urid)
+		&& lv2_atom_forge_key(forge, app->regs.core.applies_to.urid)
+		&& lv2_atom_forge_urid(forge, app->regs.synthpod.monoatom.urid)
 
-			ser.size = 4096;
-			ser.offset = 0;
-			ser.buf = malloc(ser.size);
-			lv2_atom_forge_set_sink(forge, _sink, _deref, &ser);
+		&& lv2_atom_forge_key(forge, app->regs.rdfs.label.urid)
+		&& lv2_atom_forge_string(forge, rdfs_label ? rdfs_label : app->bundle_path,
+			rdfs_label ? strlen(rdfs_label) : strlen(app->bundle_path) )
 
-			// try to extract label from bundle path
-			char *rdfs_label = NULL;
-			const char *from = strstr(app->bundle_path, "Synthpod_Stereo");
-			const char *to = strstr(app->bundle_path, ".preset.lv2");
-			if(from && to)
-			{
-				from += 15 + 1;
-				const size_t sz = to - from;
-				rdfs_label = malloc(sz + 1);
-				if(rdfs_label)
-				{
-					strncpy(rdfs_label, from, sz);
-					rdfs_label[sz] = '\0';
-				}
-			}
+		&& lv2_atom_forge_key(forge, app->regs.state.state.urid)
+		&& lv2_atom_forge_object(forge, &state_frame, 0, 0) )
+	{
+		// store state, module states are written right away, as they need lilv
+		sp_app_save(app, _state_store, forge,
+			LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE,
+			sp_app_state_features(app, app->bundle_path));
 
-			if(  ser.buf
-				&& lv2_atom_forge_object(forge, &pset_frame, app->regs.synthpod.null.urid, app->regs.pset.preset.urid)
-				&& lv2_atom_forge_key(forge, app->regs.core.applies_to.urid)
-				&& lv2_atom_forge_urid(forge, app->regs.synthpod.stereo.urid)
-				&& lv2_atom_forge_key(forge, app->regs.core.applies_to.urid)
-				&& lv2_atom_forge_urid(forge, app->regs.synthpod.monoatom.urid)
+		lv2_atom_forge_pop(forge, &state_frame);
+		lv2_atom_forge_pop(forge, &pset_frame);
 
-				&& lv2_atom_forge_key(forge, app->regs.rdfs.label.urid)
-				&& lv2_atom_forge_string(forge, rdfs_label ? rdfs_label : app->bundle_path,
-					rdfs_label ? strlen(rdfs_label) : strlen(app->bundle_path) )
+		writer->state_ref = state_frame.ref;
+	}
+	else
+	{
+		sp_app_log_error(app, "%s: forge failed\n", __func__);
+		free(ser->buf);
+		ser->buf = NULL;
+	}
 
-				&& lv2_atom_forge_key(forge, app->regs.state.state.urid)
-				&& lv2_atom_forge_object(forge, &state_frame, 0, 0) )
-			{
-				// store state
-				sp_app_save(app, _state_store, forge,
-					LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE,
-					sp_app_state_features(app, app->bundle_path));
+	if(rdfs_label)
+		free(rdfs_label);
 
-				lv2_atom_forge_pop(forge, &state_frame);
-				lv2_atom_forge_pop(forge, &pset_frame);
+	// serialize session files in the background, so we can reply right away
+	if(!pthread_create(&app->writer.thread, NULL, _state_writer_thread, writer))
+	{
+		app->writer.active = true;
+	}
+	else
+	{
+		sp_app_log_warning(app, "%s: writer thread creation failed\n", __func__);
+		_state_writer_thread(writer);
+	}
 
-				const LV2_Atom *atom = (const LV2_Atom *)ser.buf;
-				_serialize_to_turtle(app->sratom, app->driver->unmap, atom, state_dst);
-				free(ser.buf);
-			}
-			else
-			{
-				sp_app_log_error(app, "%s: forge failed\n", __func__);
-			}
+	return LV2_STATE_SUCCESS;
+}
 
-			if(rdfs_label)
-				free(rdfs_label);
-		}
-		else
-		{
-			sp_app_log_error(app, "%s: invalid sratom\n", __func__);
-		}
+__non_realtime static void
+_mod_state_dir_set(mod_t *mod, const char *dir)
+{
+	if(mod->state_dir && !strcmp(mod->state_dir, dir))
+		return; // unchanged
 
-		free(manifest_dst);
-		free(state_dst);
+	if(mod->state_dir)
+		free(mod->state_dir);
 
-		return LV2_STATE_SUCCESS;
+	mod->state_dir = strdup(dir);
+}
+
+__non_realtime static bool
+_mod_state_is_clean(mod_t *mod, const char *dir)
+{
+	if(mod->dirty_always || atomic_load(&mod->dirty))
+		return false; // changed since last save or load, or cannot tell
+
+	if(!mod->state_dir || strcmp(mod->state_dir, dir))
+		return false; // never saved to or loaded from this directory
+
+	char *path = NULL;
+	if(asprintf(&path, "%sstate.ttl", dir) == -1)
+		return false;
+
+	const bool exists = access(path, F_OK) == 0;
+	free(path);
+
+	return exists;
+}
+
+__non_realtime static int
+_mod_state_save(sp_app_t *app, mod_t *mod, const char *dir)
+{
+	// clear before capturing, so changes made meanwhile are not lost
+	atomic_store(&mod->dirty, false);
+
+	LilvState *const state = lilv_state_new_from_instance(mod->plug, mod->inst,
+		app->driver->map, dir, dir, dir, dir,
+		_state_get_value, mod, LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE, NULL);
+	if(!state)
+	{
+		sp_app_log_error(app, "%s: invalid state\n", __func__);
+		atomic_store(&mod->dirty, true);
+		return -1;
+	}
+
+	lilv_state_set_label(state, "state"); //TODO use path prefix?
+
+	// write to temporary file first, so an interrupted save never truncates state.ttl
+	int status = lilv_state_save(app->world, app->driver->map, app->driver->unmap,
+		state, NULL, dir, "state.ttl.tmp");
+	lilv_state_free(state);
+
+	char *tmp_path = NULL;
+	char *state_path = NULL;
+	char *manifest_path = NULL;
+	if(  (asprintf(&tmp_path, "%sstate.ttl.tmp", dir) == -1)
+		|| (asprintf(&state_path, "%sstate.ttl", dir) == -1)
+		|| (asprintf(&manifest_path, "%smanifest.ttl", dir) == -1) )
+	{
+		status = -1;
 	}
 	else
 	{
-		sp_app_log_error(app, "%s: _make_path failed\n", __func__);
+#if defined(_WIN32)
+		if(!status)
+			remove(state_path); // rename does not replace existing files on windows
+#endif
+		if(status || rename(tmp_path, state_path))
+		{
+			unlink(tmp_path);
+			status = -1;
+		}
+
+		// lilv's manifest refers to the temporary file, module states are loaded
+		// from their state.ttl directly anyway
+		unlink(manifest_path);
 	}
-	
-	if(manifest_dst)
-		free(manifest_dst);
-	if(state_dst)
-		free(state_dst);
 
-	return LV2_STATE_ERR_UNKNOWN;
+	if(tmp_path)
+		free(tmp_path);
+	if(state_path)
+		free(state_path);
+	if(manifest_path)
+		free(manifest_path);
+
+	if(status)
+	{
+		sp_app_log_error(app, "%s: failed to save state\n", __func__);
+		atomic_store(&mod->dirty, true);
+		return -1;
+	}
+
+	_mod_state_dir_set(mod, dir);
+
+	return 0;
 }
 
 LV2_State_Status
@@ -939,6 +1597,7 @@ sp_app_save(sp_app_t *app, LV2_State_Store_Function store,
 		{
 			LV2_Atom_Forge_Ref ref;
 			LV2_Atom_Forge_Frame mod_list_frame;
+			unsigned num_saved = 0;
 
 			if( (ref = lv2_atom_forge_object(forge, &mod_list_frame, 0, 0)) )
 			{
@@ -952,19 +1611,12 @@ sp_app_save(sp_app_t *app, LV2_State_Store_Function store,
 					char *path = make_path->path(make_path->handle, dir);
 					if(path)
 					{
-						LilvState *const state = lilv_state_new_from_instance(mod->plug, mod->inst,
-							app->driver->map, path, path, path, path,
-							_state_get_value, mod, LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE, NULL);
-
-						if(state)
+						// reuse state.ttl of modules unchanged since their last save or load
+						if(!_mod_state_is_clean(mod, path))
 						{
-							lilv_state_set_label(state, "state"); //TODO use path prefix?
-							lilv_state_save(app->world, app->driver->map, app->driver->unmap,
-								state, NULL, path, "state.ttl");
-							lilv_state_free(state);
+							_mod_state_save(app, mod, path);
+							num_saved += 1;
 						}
-						else
-							sp_app_log_error(app, "%s: invalid state\n", __func__);
 
 						free(path);
 					}
@@ -1030,6 +1682,9 @@ sp_app_save(sp_app_t *app, LV2_State_Store_Function store,
 			else
 				sp_app_log_error(app, "%s: invalid spod:moduleList\n", __func__);
 
+			sp_app_log_note(app, "%s: saved %u of %u module states\n",
+				__func__, num_saved, app->num_mods);
+
 			const LV2_Atom *atom = (const LV2_Atom *)ser.buf;
 			if(ref && atom)
 			{
@@ -1377,8 +2032,7 @@ sp_app_save(sp_app_t *app, LV2_State_Store_Function store,
 }
 
 static mod_t *
-_mod_inject(sp_app_t *app, int32_t mod_uid, LV2_URID mod_urn, const LV2_Atom_Object *mod_obj,
-	const LV2_State_Map_Path *map_path)
+_mod_inject(sp_app_t *app, int32_t mod_uid, LV2_URID mod_urn, const LV2_Atom_Object *mod_obj)
 {
 	if(  !lv2_atom_forge_is_object_type(&app->forge, mod_obj->atom.type)
 		|| !mod_obj->body.otype)
@@ -1414,10 +2068,6 @@ _mod_inject(sp_app_t *app, int32_t mod_uid, LV2_URID mod_urn, const LV2_Atom_Obj
 		return NULL;
 	}
 
-	// inject module into module graph
-	app->mods[app->num_mods] = mod;
-	app->num_mods += 1;
-
 	mod->pos.x = mod_pos_x && (mod_pos_x->atom.type == app->forge.Float)
 		? mod_pos_x->body : 0.f;
 	mod->pos.y = mod_pos_y && (mod_pos_y->atom.type == app->forge.Float)
@@ -1431,6 +2081,33 @@ _mod_inject(sp_app_t *app, int32_t mod_uid, LV2_URID mod_urn, const LV2_Atom_Obj
 
 	mod->uid = mod_uid;
 
+	return mod;
+}
+
+static void
+_mod_state_loaded(mod_t *mod, const LV2_State_Map_Path *map_path)
+{
+	char dir [128];
+	if(mod->uid) // support for old foramt
+		snprintf(dir, sizeof(dir), "%"PRIi32"/", mod->uid);
+	else
+		snprintf(dir, sizeof(dir), "%s/", mod->urn_uri);
+
+	// module state now matches the one in the bundle
+	char *path = map_path->absolute_path(map_path->handle, dir);
+	if(path)
+	{
+		_mod_state_dir_set(mod, path);
+		atomic_store(&mod->dirty, false);
+
+		free(path);
+	}
+}
+
+static LilvState *
+_mod_state_load(sp_app_t *app, mod_t *mod, const LV2_State_Map_Path *map_path,
+	LilvWorld *world)
+{
 	char dir [128];
 	if(mod->uid) // support for old foramt
 		snprintf(dir, sizeof(dir), "%"PRIi32"/state.ttl", mod->uid);
@@ -1441,7 +2118,6 @@ _mod_inject(sp_app_t *app, int32_t mod_uid, LV2_URID mod_urn, const LV2_Atom_Obj
 	if(!path)
 	{
 		sp_app_log_error(app, "%s: invaild path\n", __func__);
-		//TODO free mod
 		return NULL;
 	}
 
@@ -1450,20 +2126,169 @@ _mod_inject(sp_app_t *app, int32_t mod_uid, LV2_URID mod_urn, const LV2_Atom_Obj
 		? path + 7
 		: path;
 
-	LilvState *state = lilv_state_new_from_file(app->world,
+	LilvState *state = lilv_state_new_from_file(world,
 		app->driver->map, NULL, tmp);
 
-	if(state)
+	if(!state)
+		sp_app_log_error(app, "%s: failed to load state from file\n", __func__);
+
+	free(path);
+
+	return state;
+}
+
+__non_realtime static void *
+_mod_loader_thread(void *data)
+{
+	mod_loader_thread_t *thread = data;
+	mod_loader_t *loader = thread->loader;
+	sp_app_t *app = loader->app;
+
+	while(true)
 	{
+		const unsigned idx = atomic_fetch_add(&loader->next, 1);
+		if(idx >= loader->num_loads)
+			break;
+
+		mod_load_t *load = &loader->loads[idx];
+		mod_t *mod = load->mod;
+
+		if(!mod)
+			continue;
+
+		LilvState *state = _mod_state_load(app, mod, loader->map_path, thread->world);
+		if(!state)
+			continue;
+
+		if(mod->needs_bypassing)
+		{
+			// restore later on the calling thread, one module after another
+			load->state = state;
+			continue;
+		}
+
+		// plugins with state:threadSafeRestore or without state:interface
 		_sp_app_state_preset_restore(app, mod, state, false);
 		lilv_state_free(state);
+		_mod_state_loaded(mod, loader->map_path);
 	}
-	else
-		sp_app_log_error(app, "%s: failed to load state from file\n", __func__);
 
-	free(path);
+	return NULL;
+}
 
-	return mod;
+static void
+_mod_load_all(sp_app_t *app, mod_load_t *loads, unsigned num_loads,
+	const LV2_State_Map_Path *map_path)
+{
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+
+	// instantiate serially, as neither lilv world nor LV2 instantiation is thread-safe
+	for(unsigned i = 0; i < num_loads; i++)
+	{
+		mod_load_t *load = &loads[i];
+
+		load->mod = _mod_inject(app, load->mod_uid, load->mod_urn, load->mod_obj);
+		if(!load->mod)
+		{
+			load->mod_obj->body.otype = app->regs.synthpod.placeholder.urid;
+			load->mod = _mod_inject(app, load->mod_uid, load->mod_urn, load->mod_obj);
+			if(!load->mod)
+				continue;
+
+			snprintf(load->mod->alias, sizeof(load->mod->alias), "%s", "!!! Failed to load !!!");
+		}
+
+		if(load->mod->created > app->created)
+		{
+			app->created = load->mod->created;
+		}
+	}
+
+	// parse and restore module states on a bounded pool of loader threads,
+	// each with a private lilv world, the calling thread being the first one
+	mod_loader_t loader = {
+		.app = app,
+		.map_path = map_path,
+		.loads = loads,
+		.num_loads = num_loads
+	};
+	atomic_init(&loader.next, 0);
+
+	const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned num_threads = num_cpus > 0 ? num_cpus : 1;
+	if(num_threads > MAX_LOADERS)
+		num_threads = MAX_LOADERS;
+	if(num_threads > num_loads)
+		num_threads = num_loads;
+
+	mod_loader_thread_t threads [MAX_LOADERS];
+	unsigned num_spawned = 1;
+
+	threads[0].loader = &loader;
+	threads[0].world = app->world;
+
+	for(unsigned t = 1; t < num_threads; t++)
+	{
+		mod_loader_thread_t *thread = &threads[num_spawned];
+
+		thread->loader = &loader;
+		thread->world = lilv_world_new();
+		if(!thread->world)
+			break;
+
+		if(pthread_create(&thread->thread, NULL, _mod_loader_thread, thread))
+		{
+			lilv_world_free(thread->world);
+			break;
+		}
+
+		num_spawned += 1;
+	}
+
+	_mod_loader_thread(&threads[0]);
+
+	for(unsigned t = 1; t < num_spawned; t++)
+	{
+		pthread_join(threads[t].thread, NULL);
+	}
+
+	// restore remaining module states serially, in graph order
+	for(unsigned i = 0; i < num_loads; i++)
+	{
+		mod_load_t *load = &loads[i];
+
+		if(!load->state)
+			continue;
+
+		_sp_app_state_preset_restore(app, load->mod, load->state, false);
+		lilv_state_free(load->state);
+		load->state = NULL;
+		_mod_state_loaded(load->mod, map_path);
+	}
+
+	// pending states reference nodes of their loader world, free them first
+	for(unsigned t = 1; t < num_spawned; t++)
+	{
+		lilv_world_free(threads[t].world);
+	}
+
+	// inject modules into module graph at once
+	unsigned num_mods = app->num_mods;
+	for(unsigned i = 0; i < num_loads; i++)
+	{
+		mod_load_t *load = &loads[i];
+
+		if(load->mod)
+			app->mods[num_mods++] = load->mod;
+	}
+	app->num_mods = num_mods;
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	const double ms = (t1.tv_sec - t0.tv_sec)*1e3 + (t1.tv_nsec - t0.tv_nsec)*1e-6;
+
+	sp_app_log_note(app, "%s: restored %u modules in %.1f ms with %u threads\n",
+		__func__, num_loads, ms, num_spawned);
 }
 
 LV2_Atom_Object *
@@ -1577,29 +2402,28 @@ sp_app_restore(sp_app_t *app, LV2_State_Retrieve_Function retrieve,
 	{
 		_sp_app_reset(app);
 
-		LV2_ATOM_OBJECT_BODY_FOREACH(mod_list_body, size, prop)
+		mod_load_t *loads = calloc(MAX_MODS, sizeof(mod_load_t));
+		if(loads)
 		{
-			const int32_t mod_index = 0;
-			const LV2_URID mod_urn = prop->key;
-			LV2_Atom_Object *mod_obj = (LV2_Atom_Object *)&prop->value;
+			unsigned num_loads = 0;
 
-			mod_t *mod = _mod_inject(app, mod_index, mod_urn, mod_obj, map_path);
-			if(!mod)
+			LV2_ATOM_OBJECT_BODY_FOREACH(mod_list_body, size, prop)
 			{
-				mod_obj->body.otype = app->regs.synthpod.placeholder.urid;
-				mod = _mod_inject(app, mod_index, mod_urn, mod_obj, map_path);
-				if(!mod)
-				{
-					snprintf(mod->alias, sizeof(mod->alias), "%s", "!!! Failed to load !!!");
-					continue;
-				}
-			}
+				if(num_loads >= MAX_MODS)
+					break;
 
-			if(mod->created > app->created)
-			{
-				app->created = mod->created;
+				mod_load_t *load = &loads[num_loads++];
+
+				load->mod_uid = 0;
+				load->mod_urn = prop->key;
+				load->mod_obj = (LV2_Atom_Object *)&prop->value;
 			}
+
+			_mod_load_all(app, loads, num_loads, map_path);
+			free(loads);
 		}
+		else
+			sp_app_log_error(app, "%s: allocation failed\n", __func__);
 
 		_sp_app_order(app);
 	}
@@ -1723,34 +2547,42 @@ sp_app_restore(sp_app_t *app, LV2_State_Retrieve_Function retrieve,
 	{
 		_sp_app_reset(app);
 
-		LV2_ATOM_TUPLE_BODY_FOREACH(graph_body, size, mod_item)
+		mod_load_t *loads = calloc(MAX_MODS, sizeof(mod_load_t));
+		if(loads)
 		{
-			LV2_Atom_Object *mod_obj = (LV2_Atom_Object *)mod_item;
+			unsigned num_loads = 0;
 
-			if(  !lv2_atom_forge_is_object_type(&app->forge, mod_obj->atom.type)
-				|| !mod_obj->body.otype)
-				continue;
+			LV2_ATOM_TUPLE_BODY_FOREACH(graph_body, size, mod_item)
+			{
+				LV2_Atom_Object *mod_obj = (LV2_Atom_Object *)mod_item;
 
-			const LV2_Atom_Int *mod_index = NULL;
-			lv2_atom_object_get(mod_obj,
-				app->regs.core.index.urid, &mod_index,
-				0);
-		
-			if(!mod_index || (mod_index->atom.type != app->forge.Int) )
-				continue;
+				if(  !lv2_atom_forge_is_object_type(&app->forge, mod_obj->atom.type)
+					|| !mod_obj->body.otype)
+					continue;
 
-			const LV2_URID mod_urn = 0;
-			mod_t *mod = _mod_inject(app, mod_index->body, mod_urn, mod_obj, map_path);
-			if(!mod)
-			{
-				mod_obj->body.otype = app->regs.synthpod.placeholder.urid;
-				mod = _mod_inject(app, mod_index->body, mod_urn, mod_obj, map_path);
-				if(mod)
-				{
-					snprintf(mod->alias, sizeof(mod->alias), "%s", "!!! Failed to load !!!");
-				}
+				const LV2_Atom_Int *mod_index = NULL;
+				lv2_atom_object_get(mod_obj,
+					app->regs.core.index.urid, &mod_index,
+					0);
+			
+				if(!mod_index || (mod_index->atom.type != app->forge.Int) )
+					continue;
+
+				if(num_loads >= MAX_MODS)
+					break;
+
+				mod_load_t *load = &loads[num_loads++];
+
+				load->mod_uid = mod_index->body;
+				load->mod_urn = 0;
+				load->mod_obj = mod_obj;
 			}
+
+			_mod_load_all(app, loads, num_loads, map_path);
+			free(loads);
 		}
+		else
+			sp_app_log_error(app, "%s: allocation failed\n", __func__);
 
 		_sp_app_order(app);
 
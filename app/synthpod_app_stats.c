@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <synthpod_app_private.h>
+#include <synthpod_patcher.h>
+
+// upper bound of bucket, e.g. percentiles are never underestimated
+static inline uint32_t
+_hist_bucket_upper(unsigned b)
+{
+	if(b < HIST_SUB)
+		return b;
+
+	const unsigned e = b/HIST_SUB + HIST_SUB_BITS - 1;
+	const uint64_t lower = (uint64_t)(HIST_SUB + b%HIST_SUB) << (e - HIST_SUB_BITS);
+	const uint64_t upper = lower + (1ULL << (e - HIST_SUB_BITS)) - 1;
+
+	return upper > UINT32_MAX ? UINT32_MAX : upper;
+}
+
+// p50, p99 and p99.9 in one sweep over the buckets
+__realtime static void
+_hist_summary(const hist_t *hist, LV2_URID urn, uint32_t budget, stats_t *stats)
+{
+	const uint64_t ranks [3] = {
+		(hist->count*500 + 999) / 1000,
+		(hist->count*990 + 999) / 1000,
+		(hist->count*999 + 999) / 1000
+	};
+	uint32_t *dst [3] = {
+		&stats->p50, &stats->p99, &stats->p999
+	};
+
+	stats->urn = urn;
+	stats->budget = budget;
+	stats->p50 = 0;
+	stats->p99 = 0;
+	stats->p999 = 0;
+	stats->max = hist->max;
+	stats->count = hist->count;
+	stats->over = hist->over;
+
+	uint64_t sum = 0;
+	unsigned r = 0;
+
+	for(unsigned b=0; (b<HIST_BUCKETS) && (r<3); b++)
+	{
+		sum += hist->buckets[b];
+
+		for( ; (r<3) && ranks[r] && (sum >= ranks[r]); r++)
+		{
+			const uint32_t upper = _hist_bucket_upper(b);
+
+			*dst[r] = upper < hist->max ? upper : hist->max;
+		}
+	}
+}
+
+__realtime static void
+_stats_to_ui(sp_app_t *app, const stats_t *stats, LV2_URID prop)
+{
+	const float budget_1 = stats->budget ? 100.f / stats->budget : 0.f;
+
+	// to nk
+	LV2_Atom *answer = _sp_app_to_ui_request_atom(app);
+	if(answer)
+	{
+		const float vec [] = {
+			stats->p50 * budget_1,
+			stats->p99 * budget_1,
+			stats->p999 * budget_1,
+			stats->max * budget_1,
+			stats->over,
+			stats->count ? stats->over * 100.f / stats->count : 0.f
+		};
+
+		LV2_Atom_Forge_Frame frame [1];
+		LV2_Atom_Forge_Ref ref = synthpod_patcher_set_object(
+			&app->regs, &app->forge, &frame[0], stats->urn, 0, prop); //TODO seqn
+		if(ref)
+			ref = lv2_atom_forge_vector(&app->forge, sizeof(float), app->forge.Float, 6, vec);
+		if(ref)
+		{
+			synthpod_patcher_pop(&app->forge, frame, 1);
+			_sp_app_to_ui_advance_atom(app, answer);
+		}
+		else
+		{
+			_sp_app_to_ui_overflow(app);
+		}
+	}
+	else
+	{
+		_sp_app_to_ui_overflow(app);
+	}
+}
+
+// called once per second from sp_app_run_post
+__realtime void
+_sp_app_stats_report(sp_app_t *app)
+{
+	const uint32_t budget = app->prof.budget;
+	const unsigned num_stats = app->num_mods + 1;
+	stats_t *stats = NULL;
+
+	// records trail the job in the same chunk, the worker writes them out
+	const size_t job_size = sizeof(job_t) + num_stats*sizeof(stats_t);
+	job_t *job = app->driver->stats_path
+		? _sp_app_to_worker_request(app, job_size)
+		: NULL;
+	stats_t tmp;
+
+	if(job)
+	{
+		job->request = JOB_TYPE_REQUEST_STATS_DUMP;
+		job->status = num_stats;
+		stats = (void *)job + sizeof(job_t);
+	}
+	else if(app->driver->stats_path)
+	{
+		sp_app_log_trace(app, "%s: buffer request failed\n", __func__);
+	}
+
+	for(unsigned m=0; m<app->num_mods; m++)
+	{
+		mod_t *mod = app->mods[m];
+		stats_t *dst = stats ? &stats[m + 1] : &tmp;
+
+		_hist_summary(&mod->prof.hist, mod->urn, budget, dst);
+		_stats_to_ui(app, dst, app->regs.synthpod.module_percentiles.urid);
+
+		if(stats)
+		{
+			dst->uri = mod->plug_urid;
+			strncpy(dst->alias, mod->alias, ALIAS_MAX - 1);
+			dst->alias[ALIAS_MAX - 1] = '\0';
+		}
+	}
+
+	{
+		stats_t *dst = stats ? &stats[0] : &tmp;
+
+		_hist_summary(&app->prof.hist, 0, budget, dst);
+		_stats_to_ui(app, dst, app->regs.synthpod.dsp_percentiles.urid);
+	}
+
+	if(job)
+		_sp_app_to_worker_advance(app, job_size);
+}
+
+__non_realtime static void
+_stats_json_entry(FILE *f, const stats_t *stats)
+{
+	fprintf(f, "\"p50\":%"PRIu32",\"p99\":%"PRIu32",\"p99.9\":%"PRIu32
+		",\"max\":%"PRIu32",\"count\":%"PRIu64",\"over\":%"PRIu64",\"miss\":%.6f",
+		stats->p50, stats->p99, stats->p999, stats->max, stats->count, stats->over,
+		stats->count ? (double)stats->over / stats->count : 0.0);
+}
+
+// write JSON to temporary file and rename, e.g. readers never see partial files
+__non_realtime void
+_sp_app_stats_dump(sp_app_t *app, unsigned num_stats, const stats_t *stats)
+{
+	const char *path = app->driver->stats_path;
+	LV2_URID_Unmap *unmap = app->driver->unmap;
+
+	if(!path || !num_stats)
+		return;
+
+	char tmp [PATH_MAX];
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+	FILE *f = fopen(tmp, "w");
+	if(!f)
+	{
+		sp_app_log_error(app, "%s: failed to open '%s'\n", __func__, tmp);
+		return;
+	}
+
+	fprintf(f, "{\"unit\":\"ns\",\"budget\":%"PRIu32",\"rate\":%.0f,\n\"dsp\":{",
+		stats[0].budget, app->driver->sample_rate);
+	_stats_json_entry(f, &stats[0]);
+	fprintf(f, "},\n\"modules\":[");
+
+	for(unsigned i=1; i<num_stats; i++)
+	{
+		const stats_t *entry = &stats[i];
+		const char *urn = unmap->unmap(unmap->handle, entry->urn);
+		const char *uri = unmap->unmap(unmap->handle, entry->uri);
+
+		fprintf(f, "%s\n{\"urn\":\"", (i > 1) ? "," : "");
+		_sp_app_json_string(f, urn ? urn : "");
+		fprintf(f, "\",\"uri\":\"");
+		_sp_app_json_string(f, uri ? uri : "");
+		fprintf(f, "\",\"alias\":\"");
+		_sp_app_json_string(f, entry->alias);
+		fprintf(f, "\",");
+		_stats_json_entry(f, entry);
+		fprintf(f, "}");
+	}
+
+	fprintf(f, "\n]}\n");
+
+	if(fclose(f) || rename(tmp, path))
+	{
+		sp_app_log_error(app, "%s: failed to write '%s'\n", __func__, path);
+		unlink(tmp);
+	}
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <synthpod_app_private.h>
+
+#if defined(__linux__)
+#	include <linux/mempolicy.h>
+#	include <sys/syscall.h>
+#endif
+
+#define SYSFS_CPU "/sys/devices/system/cpu"
+#define MAX_CPUS 1024
+
+__non_realtime static int
+_topo_read(const char *path, char *buf, size_t len)
+{
+	FILE *f = fopen(path, "r");
+	if(!f)
+		return -1;
+
+	const bool ok = fgets(buf, len, f) != NULL;
+	fclose(f);
+
+	return ok ? 0 : -1;
+}
+
+// parses lists of the form "0-3,8,10-11"
+__non_realtime static unsigned
+_topo_cpulist_parse(const char *str, int *cpus, unsigned max)
+{
+	unsigned num = 0;
+
+	while(*str && (num < max))
+	{
+		char *end;
+		const long from = strtol(str, &end, 10);
+		if(end == str)
+			break;
+
+		long to = from;
+		if(*end == '-')
+		{
+			str = end + 1;
+			to = strtol(str, &end, 10);
+			if(end == str)
+				break;
+		}
+
+		for(long cpu = from; (cpu <= to) && (num < max); cpu++)
+			cpus[num++] = cpu;
+
+		str = end;
+		if(*str == ',')
+			str++;
+	}
+
+	return num;
+}
+
+__non_realtime static int
+_topo_cpu_node(int cpu)
+{
+	char path [PATH_MAX];
+	snprintf(path, sizeof(path), SYSFS_CPU"/cpu%i", cpu);
+
+	DIR *dir = opendir(path);
+	if(!dir)
+		return 0;
+
+	int node = 0;
+	struct dirent *itm;
+	while( (itm = readdir(dir)) )
+	{
+		if(sscanf(itm->d_name, "node%i", &node) == 1)
+			break;
+	}
+	closedir(dir);
+
+	return node;
+}
+
+// first SMT sibling of given cpu, e.g. identifies its physical core
+__non_realtime static int
+_topo_cpu_core(int cpu)
+{
+	char path [PATH_MAX];
+	snprintf(path, sizeof(path), SYSFS_CPU"/cpu%i/topology/thread_siblings_list", cpu);
+
+	char buf [256];
+	int sibling;
+	if(  _topo_read(path, buf, sizeof(buf))
+		|| (_topo_cpulist_parse(buf, &sibling, 1) != 1) )
+	{
+		return cpu;
+	}
+
+	return sibling;
+}
+
+__non_realtime void
+_sp_app_topo_plan(sp_app_t *app)
+{
+	dsp_master_t *dsp_master = &app->dsp_master;
+	const sp_app_driver_t *driver = app->driver;
+
+	int cpus [MAX_CPUS];
+	unsigned num_cpus = 0;
+
+	dsp_master->cpu = -1;
+	dsp_master->node = 0;
+	dsp_master->num_nodes = 1;
+
+	for(unsigned i=0; i<dsp_master->num_slaves; i++)
+	{
+		dsp_slave_t *dsp_slave = &dsp_master->dsp_slaves[i];
+
+		dsp_slave->cpu = -1;
+		dsp_slave->node = 0;
+	}
+
+	if(!driver->cpu_affinity)
+		return; // let the scheduler decide
+
+	if(driver->cpu_list) // explicit list, master comes first
+	{
+		num_cpus = _topo_cpulist_parse(driver->cpu_list, cpus, MAX_CPUS);
+	}
+	else
+	{
+		char buf [256];
+		if(_topo_read(SYSFS_CPU"/online", buf, sizeof(buf)) == 0)
+			num_cpus = _topo_cpulist_parse(buf, cpus, MAX_CPUS);
+
+		if(num_cpus == 0) // no sysfs, fall back to numbering
+		{
+			const long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+			for(long cpu = 0; (cpu < nprocs) && (num_cpus < MAX_CPUS); cpu++)
+				cpus[num_cpus++] = cpu;
+		}
+	}
+
+	if(num_cpus == 0)
+	{
+		sp_app_log_error(app, "%s: no CPUs to run on\n", __func__);
+		return;
+	}
+
+	dsp_master->cpu = cpus[0];
+	dsp_master->node = _topo_cpu_node(dsp_master->cpu);
+
+	const int master_core = _topo_cpu_core(dsp_master->cpu);
+	int max_node = dsp_master->node;
+	unsigned num_slaves = 0;
+
+	for(unsigned c=1; (c<num_cpus) && (num_slaves<dsp_master->num_slaves); c++)
+	{
+		const int cpu = cpus[c];
+		const int node = _topo_cpu_node(cpu);
+
+		if(driver->cpu_single_node && (node != dsp_master->node))
+			continue; // skip foreign node
+
+		if(driver->cpu_exclusive && !driver->cpu_list)
+		{
+			const int core = _topo_cpu_core(cpu);
+			bool taken = (core == master_core);
+
+			for(unsigned i=0; !taken && (i<num_slaves); i++)
+				taken = (_topo_cpu_core(dsp_master->dsp_slaves[i].cpu) == core);
+
+			if(taken)
+				continue; // skip SMT sibling
+		}
+
+		dsp_slave_t *dsp_slave = &dsp_master->dsp_slaves[num_slaves++];
+		dsp_slave->cpu = cpu;
+		dsp_slave->node = node;
+
+		if(node > max_node)
+			max_node = node;
+	}
+
+	if(num_slaves < dsp_master->num_slaves)
+	{
+		sp_app_log_trace(app, "%s: only %u of %u slave cores available\n", __func__,
+			num_slaves, dsp_master->num_slaves);
+
+		dsp_master->num_slaves = num_slaves;
+	}
+
+	if(max_node >= MAX_NODES)
+	{
+		sp_app_log_note(app, "%s: NUMA node %i beyond %i, disabling migration\n", __func__,
+			max_node, MAX_NODES);
+
+		return; // keep num_nodes at 1
+	}
+
+	dsp_master->num_nodes = max_node + 1;
+}
+
+__non_realtime void
+_sp_app_topo_migrate(sp_app_t *app, mod_t *mod)
+{
+#if defined(__linux__)
+	const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+
+	if( (mod->node < 0) || (mod->node >= MAX_NODES) )
+		return;
+
+	const unsigned long nodemask = 1UL << mod->node;
+
+	for(port_type_t type=0; type<PORT_TYPE_NUM; type++)
+	{
+		pool_t *pool = &mod->pools[type];
+
+		if(!pool->buf || !pool->size)
+			continue;
+
+		// pools are allocated in whole pages, e.g. are not shared with others
+		if( ((uintptr_t)pool->buf | pool->size) & (page_size - 1) )
+			continue;
+
+		if(syscall(SYS_mbind, pool->buf, pool->size, MPOL_PREFERRED, &nodemask,
+			sizeof(nodemask)*8, MPOL_MF_MOVE))
+		{
+			sp_app_log_trace(app, "%s: mbind failed <%s>\n", __func__, mod->urn_uri);
+		}
+	}
+#else
+	(void)app;
+	(void)mod;
+#endif
+}
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <inttypes.h>
+#include <sys/mman.h>
+
+#include <synthpod_app_private.h>
+
+static const char *trace_names [TRACE_TYPE_NUM] = {
+	[TRACE_TYPE_RUN] = "run",
+	[TRACE_TYPE_MULTIPLEX] = "multiplex",
+	[TRACE_TYPE_WORKER] = "worker response",
+	[TRACE_TYPE_WAKE] = "wake",
+	[TRACE_TYPE_BARRIER] = "barrier"
+};
+
+__non_realtime void
+_sp_app_trace_init(sp_app_t *app)
+{
+	trace_t *trace = &app->trace;
+
+	atomic_init(&trace->request, false);
+	trace->countdown = 0;
+	trace->holdoff = 0;
+	trace->xrun_dumps = 0;
+	trace->dumps = 0;
+	trace->rings = NULL;
+
+	if(!app->driver->trace_path)
+		return; // tracing disabled
+
+	// one ring for master and each slave thread
+	trace->num_rings = app->dsp_master.num_slaves + 1;
+	const size_t size = trace->num_rings * sizeof(trace_ring_t);
+
+	if(posix_memalign((void **)&trace->rings, CACHE_LINE_SIZE, size))
+	{
+		sp_app_log_error(app, "%s: posix_memalign failed\n", __func__);
+		trace->rings = NULL;
+		return;
+	}
+
+	memset(trace->rings, 0x0, size);
+
+	for(unsigned i=0; i<trace->num_rings; i++)
+		atomic_init(&trace->rings[i].head, 0);
+
+	if(mlock(trace->rings, size))
+		sp_app_log_trace(app, "%s: mlock failed\n", __func__);
+}
+
+__non_realtime void
+_sp_app_trace_deinit(sp_app_t *app)
+{
+	trace_t *trace = &app->trace;
+
+	if(trace->rings)
+	{
+		munlock(trace->rings, trace->num_rings * sizeof(trace_ring_t));
+		free(trace->rings);
+		trace->rings = NULL;
+	}
+}
+
+// schedule a dump for xruns (after some more cycles) and explicit requests,
+// overloaded systems xrun continuously, thus limit rate and number of the former
+__realtime void
+_sp_app_trace_schedule(sp_app_t *app, uint32_t nsamples, bool xrun)
+{
+	trace_t *trace = &app->trace;
+
+	if(!trace->rings)
+		return;
+
+	trace->holdoff = (trace->holdoff > nsamples) ? trace->holdoff - nsamples : 0;
+
+	if(  xrun && !trace->countdown && !trace->holdoff
+		&& (trace->xrun_dumps < TRACE_XRUN_DUMPS) )
+	{
+		trace->countdown = app->driver->sample_rate / 10; // record what follows, too
+		trace->holdoff = app->driver->sample_rate * TRACE_XRUN_HOLDOFF;
+
+		if(++trace->xrun_dumps == TRACE_XRUN_DUMPS)
+			sp_app_log_note(app, "%s: last dump upon xrun, request further ones explicitly\n", __func__);
+	}
+
+	bool dump = atomic_exchange(&trace->request, false);
+
+	if(trace->countdown)
+	{
+		if(trace->countdown <= nsamples)
+		{
+			trace->countdown = 0;
+			dump = true;
+		}
+		else
+		{
+			trace->countdown -= nsamples;
+		}
+	}
+
+	if(!dump)
+		return;
+
+	// names trail the job in the same chunk, worker must not walk app->mods
+	const size_t job_size = sizeof(job_t) + app->num_mods*sizeof(trace_name_t);
+	job_t *job = _sp_app_to_worker_request(app, job_size);
+	if(job)
+	{
+		trace_name_t *names = (void *)job + sizeof(job_t);
+
+		job->request = JOB_TYPE_REQUEST_TRACE_DUMP;
+		job->status = app->num_mods;
+
+		for(unsigned m=0; m<app->num_mods; m++)
+		{
+			mod_t *mod = app->mods[m];
+
+			names[m].urn = mod->urn;
+			names[m].uri = mod->plug_urid;
+			strncpy(names[m].alias, mod->alias, ALIAS_MAX - 1);
+			names[m].alias[ALIAS_MAX - 1] = '\0';
+		}
+
+		_sp_app_to_worker_advance(app, job_size);
+	}
+	else
+	{
+		sp_app_log_trace(app, "%s: buffer request failed\n", __func__);
+	}
+}
+
+__non_realtime static const char *
+_trace_module_name(sp_app_t *app, unsigned num_names, const trace_name_t *names,
+	LV2_URID urn)
+{
+	LV2_URID_Unmap *unmap = app->driver->unmap;
+
+	if(!urn)
+		return NULL;
+
+	for(unsigned m=0; m<num_names; m++)
+	{
+		const trace_name_t *name = &names[m];
+
+		if(name->urn != urn)
+			continue;
+
+		if(strlen(name->alias))
+			return name->alias;
+
+		const char *uri = unmap->unmap(unmap->handle, name->uri);
+		if(uri)
+			return uri;
+
+		break;
+	}
+
+	return unmap->unmap(unmap->handle, urn);
+}
+
+__non_realtime static void
+_trace_dump_ring(sp_app_t *app, FILE *f, unsigned tid, bool *first,
+	unsigned num_names, const trace_name_t *names)
+{
+	trace_ring_t *ring = &app->trace.rings[tid];
+	trace_event_t *events = malloc(TRACE_EVENTS * sizeof(trace_event_t));
+
+	if(!events)
+		return;
+
+	// copy, then drop what the writer may have overwritten meanwhile
+	const unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	memcpy(events, ring->events, TRACE_EVENTS * sizeof(trace_event_t));
+	const unsigned tail = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	// the slot at tail may be half-written, too
+	unsigned from = head > TRACE_EVENTS ? head - TRACE_EVENTS : 0;
+	if(tail - from >= TRACE_EVENTS)
+		from = tail - TRACE_EVENTS + 1;
+
+	for(unsigned i=from; i<head; i++)
+	{
+		const trace_event_t *ev = &events[i & (TRACE_EVENTS - 1)];
+		const char *module = _trace_module_name(app, num_names, names, ev->urn);
+
+		fprintf(f, "%s\n{\"name\":\"", *first ? "" : ",");
+		_sp_app_json_string(f, module ? module : trace_names[ev->type]);
+		fprintf(f, "\",\"cat\":\"dsp\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+			"\"ts\":%"PRIu64".%03"PRIu64",\"dur\":%"PRIu32".%03"PRIu32, tid,
+			ev->t0 / 1000, ev->t0 % 1000, ev->dt / 1000, ev->dt % 1000);
+
+		if(module)
+			fprintf(f, ",\"args\":{\"phase\":\"%s\"}", trace_names[ev->type]);
+
+		fprintf(f, "}");
+		*first = false;
+	}
+
+	free(events);
+}
+
+// dump all rings as Chrome trace event JSON, which Perfetto reads, too
+__non_realtime void
+_sp_app_trace_dump(sp_app_t *app, unsigned num_names, const trace_name_t *names)
+{
+	trace_t *trace = &app->trace;
+
+	if(!trace->rings)
+		return;
+
+	char path [PATH_MAX];
+	snprintf(path, sizeof(path), "%s-%u.json", app->driver->trace_path, trace->dumps++);
+
+	FILE *f = fopen(path, "w");
+	if(!f)
+	{
+		sp_app_log_error(app, "%s: failed to open '%s'\n", __func__, path);
+		return;
+	}
+
+	bool first = true;
+
+	fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+	for(unsigned tid=0; tid<trace->num_rings; tid++)
+	{
+		fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+			"\"args\":{\"name\":\"%s %u\"}}",
+			first ? "" : ",", tid, tid ? "slave" : "master", tid);
+		first = false;
+
+		_trace_dump_ring(app, f, tid, &first, num_names, names);
+	}
+
+	fprintf(f, "\n]}\n");
+	fclose(f);
+
+	sp_app_log_note(app, "%s: wrote '%s'\n", __func__, path);
+}
+
+__non_realtime void
+sp_app_trace_request(sp_app_t *app)
+{
+	atomic_store(&app->trace.request, true);
+}
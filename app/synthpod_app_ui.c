@@ -129,156 +129,156 @@ _sp_app_ui_set_modlist(sp_app_t *app, LV2_URID subj, int32_t seqn)
 }
 
 __realtime LV2_Atom_Forge_Ref
-_sp_app_forge_midi_automation(sp_app_t *app, LV2_Atom_Forge_Frame *frame,
+_sp_app_forge_midi_automation(sp_app_t *app, LV2_Atom_Forge *forge, LV2_Atom_Forge_Frame *frame,
 	mod_t *mod, port_t *port, const auto_t *automation)
 {
 	const midi_auto_t *mauto = &automation->midi;
 	LV2_Atom_Forge_Ref ref;
 	
-	ref = lv2_atom_forge_object(&app->forge, frame, 0, app->regs.midi.Controller.urid);
+	ref = lv2_atom_forge_object(forge, frame, 0, app->regs.midi.Controller.urid);
 	if(ref)
 	{
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_module.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_module.urid);
 		if(ref)
-			ref = lv2_atom_forge_urid(&app->forge, mod->urn);
+			ref = lv2_atom_forge_urid(forge, mod->urn);
 
 		if(automation->property)
 		{
 			if(ref)
-				ref = lv2_atom_forge_key(&app->forge, app->regs.patch.property.urid);
+				ref = lv2_atom_forge_key(forge, app->regs.patch.property.urid);
 			if(ref)
-				ref = lv2_atom_forge_urid(&app->forge, automation->property);
+				ref = lv2_atom_forge_urid(forge, automation->property);
 			if(ref)
-				ref = lv2_atom_forge_key(&app->forge, app->regs.rdfs.range.urid);
+				ref = lv2_atom_forge_key(forge, app->regs.rdfs.range.urid);
 			if(ref)
-				ref = lv2_atom_forge_urid(&app->forge, automation->range);
+				ref = lv2_atom_forge_urid(forge, automation->range);
 		}
 		else
 		{
 			if(ref)
-				ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_symbol.urid);
+				ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_symbol.urid);
 			if(ref)
-				ref = lv2_atom_forge_string(&app->forge, port->symbol, strlen(port->symbol));
+				ref = lv2_atom_forge_string(forge, port->symbol, strlen(port->symbol));
 		}
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.midi.channel.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.midi.channel.urid);
 		if(ref)
-			ref = lv2_atom_forge_int(&app->forge, mauto->channel);
+			ref = lv2_atom_forge_int(forge, mauto->channel);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.midi.controller_number.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.midi.controller_number.urid);
 		if(ref)
-			ref = lv2_atom_forge_int(&app->forge, mauto->controller);
+			ref = lv2_atom_forge_int(forge, mauto->controller);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.source_min.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.source_min.urid);
 		if(ref)
-			ref = lv2_atom_forge_double(&app->forge, automation->a);
+			ref = lv2_atom_forge_double(forge, automation->a);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.source_max.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.source_max.urid);
 		if(ref)
-			ref = lv2_atom_forge_double(&app->forge, automation->b);
+			ref = lv2_atom_forge_double(forge, automation->b);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_min.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_min.urid);
 		if(ref)
-			ref = lv2_atom_forge_double(&app->forge, automation->c);
+			ref = lv2_atom_forge_double(forge, automation->c);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_max.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_max.urid);
 		if(ref)
-			ref = lv2_atom_forge_double(&app->forge, automation->d);
+			ref = lv2_atom_forge_double(forge, automation->d);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.source_enabled.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.source_enabled.urid);
 		if(ref)
-			ref = lv2_atom_forge_bool(&app->forge, automation->src_enabled);
+			ref = lv2_atom_forge_bool(forge, automation->src_enabled);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_enabled.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_enabled.urid);
 		if(ref)
-			ref = lv2_atom_forge_bool(&app->forge, automation->snk_enabled);
+			ref = lv2_atom_forge_bool(forge, automation->snk_enabled);
 	}
 	if(ref)
-		lv2_atom_forge_pop(&app->forge, frame);
+		lv2_atom_forge_pop(forge, frame);
 
 	return ref;
 }
 
 __realtime LV2_Atom_Forge_Ref
-_sp_app_forge_osc_automation(sp_app_t *app, LV2_Atom_Forge_Frame *frame,
+_sp_app_forge_osc_automation(sp_app_t *app, LV2_Atom_Forge *forge, LV2_Atom_Forge_Frame *frame,
 	mod_t *mod, port_t *port, const auto_t *automation)
 {
 	const osc_auto_t *oauto = &automation->osc;
 	LV2_Atom_Forge_Ref ref;
 	
-	ref = lv2_atom_forge_object(&app->forge, frame, 0, app->regs.osc.message.urid);
+	ref = lv2_atom_forge_object(forge, frame, 0, app->regs.osc.message.urid);
 	if(ref)
 	{
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_module.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_module.urid);
 		if(ref)
-			ref = lv2_atom_forge_urid(&app->forge, mod->urn);
+			ref = lv2_atom_forge_urid(forge, mod->urn);
 
 		if(automation->property)
 		{
 			if(ref)
-				ref = lv2_atom_forge_key(&app->forge, app->regs.patch.property.urid);
+				ref = lv2_atom_forge_key(forge, app->regs.patch.property.urid);
 			if(ref)
-				ref = lv2_atom_forge_urid(&app->forge, automation->property);
+				ref = lv2_atom_forge_urid(forge, automation->property);
 			if(ref)
-				ref = lv2_atom_forge_key(&app->forge, app->regs.rdfs.range.urid);
+				ref = lv2_atom_forge_key(forge, app->regs.rdfs.range.urid);
 			if(ref)
-				ref = lv2_atom_forge_urid(&app->forge, automation->range);
+				ref = lv2_atom_forge_urid(forge, automation->range);
 		}
 		else
 		{
 			if(ref)
-				ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_symbol.urid);
+				ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_symbol.urid);
 			if(ref)
-				ref = lv2_atom_forge_string(&app->forge, port->symbol, strlen(port->symbol));
+				ref = lv2_atom_forge_string(forge, port->symbol, strlen(port->symbol));
 		}
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.osc.path.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.osc.path.urid);
 		if(ref)
-			ref = lv2_atom_forge_string(&app->forge, oauto->path, strlen(oauto->path));
+			ref = lv2_atom_forge_string(forge, oauto->path, strlen(oauto->path));
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.source_min.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.source_min.urid);
 		if(ref)
-			ref = lv2_atom_forge_double(&app->forge, automation->a);
+			ref = lv2_atom_forge_double(forge, automation->a);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.source_max.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.source_max.urid);
 		if(ref)
-			ref = lv2_atom_forge_double(&app->forge, automation->b);
+			ref = lv2_atom_forge_double(forge, automation->b);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_min.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_min.urid);
 		if(ref)
-			ref = lv2_atom_forge_double(&app->forge, automation->c);
+			ref = lv2_atom_forge_double(forge, automation->c);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_max.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_max.urid);
 		if(ref)
-			ref = lv2_atom_forge_double(&app->forge, automation->d);
+			ref = lv2_atom_forge_double(forge, automation->d);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.source_enabled.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.source_enabled.urid);
 		if(ref)
-			ref = lv2_atom_forge_bool(&app->forge, automation->src_enabled);
+			ref = lv2_atom_forge_bool(forge, automation->src_enabled);
 
 		if(ref)
-			ref = lv2_atom_forge_key(&app->forge, app->regs.synthpod.sink_enabled.urid);
+			ref = lv2_atom_forge_key(forge, app->regs.synthpod.sink_enabled.urid);
 		if(ref)
-			ref = lv2_atom_forge_bool(&app->forge, automation->snk_enabled);
+			ref = lv2_atom_forge_bool(forge, automation->snk_enabled);
 	}
 	if(ref)
-		lv2_atom_forge_pop(&app->forge, frame);
+		lv2_atom_forge_pop(forge, frame);
 
 	return ref;
 }
@@ -530,12 +530,12 @@ _sp_app_from_ui_patch_get(sp_app_t *app, const LV2_Atom *atom)
 						if(automation->type == AUTO_TYPE_MIDI)
 						{
 							if(ref)
-								ref = _sp_app_forge_midi_automation(app, &frame[2], mod, port, automation);
+								ref = _sp_app_forge_midi_automation(app, &app->forge, &frame[2], mod, port, automation);
 						}
 						else if(automation->type == AUTO_TYPE_OSC)
 						{
 							if(ref)
-								ref = _sp_app_forge_osc_automation(app, &frame[2], mod, port, automation);
+								ref = _sp_app_forge_osc_automation(app, &app->forge, &frame[2], mod, port, automation);
 						}
 					}
 				}
@@ -697,6 +697,28 @@ _sp_app_from_ui_patch_get(sp_app_t *app, const LV2_Atom *atom)
 				_sp_app_to_ui_overflow(app);
 			}
 		}
+		else if(prop == app->regs.synthpod.buffer_saved.urid)
+		{
+			LV2_Atom *answer = _sp_app_to_ui_request_atom(app);
+			if(answer)
+			{
+				LV2_Atom_Forge_Ref ref = synthpod_patcher_set(
+					&app->regs, &app->forge, subj, sn, prop,
+					sizeof(int64_t), app->forge.Long, &app->arena.saved);
+				if(ref)
+				{
+					_sp_app_to_ui_advance_atom(app, answer);
+				}
+				else
+				{
+					_sp_app_to_ui_overflow(app);
+				}
+			}
+			else
+			{
+				_sp_app_to_ui_overflow(app);
+			}
+		}
 		else if(prop == app->regs.synthpod.period_size.urid)
 		{
 			LV2_Atom *answer = _sp_app_to_ui_request_atom(app);
@@ -1397,13 +1419,18 @@ _subscription_list_add(sp_app_t *app, const LV2_Atom_Object *obj)
 
 		if(src_port)
 		{
-			src_port->subscriptions += 1;
+			_sp_app_port_subscribe(src_port);
 
 			if(src_port->type == PORT_TYPE_CONTROL)
 			{
 				const float *buf_ptr = PORT_BASE_ALIGNED(src_port);
 				src_port->control.last = *buf_ptr - 0.1; // will force notification
 			}
+			else if( (src_port->subscriptions == 1)
+				&& ( (src_port->type == PORT_TYPE_AUDIO) || (src_port->type == PORT_TYPE_CV) ) )
+			{
+				atomic_store(&app->dsp_master.replan, true); // ui needs buffer to survive whole cycle
+			}
 		}
 	}
 }
@@ -1433,7 +1460,15 @@ _subscription_list_rem(sp_app_t *app, const LV2_Atom_Object *obj)
 		if(src_port)
 		{
 			if(src_port->subscriptions > 0)
-				src_port->subscriptions -= 1;
+			{
+				_sp_app_port_unsubscribe(src_port);
+
+				if(  (src_port->subscriptions == 0)
+					&& ( (src_port->type == PORT_TYPE_AUDIO) || (src_port->type == PORT_TYPE_CV) ) )
+				{
+					atomic_store(&app->dsp_master.replan, true); // buffer may be shared again
+				}
+			}
 		}
 	}
 }
@@ -1558,6 +1593,84 @@ _automation_list_rem_internal(port_t *port, LV2_URID prop)
 	}
 }
 
+// rebuild lookup tables into inactive buffer and publish it
+__realtime void
+_automation_index_rebuild(mod_t *mod)
+{
+	const auto_index_t *cur = _automation_index(mod);
+	auto_index_t *idx = (cur == &mod->auto_indices[0])
+		? &mod->auto_indices[1]
+		: &mod->auto_indices[0];
+
+	memset(idx, 0x0, sizeof(auto_index_t));
+
+	// prepend in reverse to get chains in ascending slot order
+	for(int i = MAX_AUTOMATIONS - 1; i >= 0; i--)
+	{
+		auto_t *automation = &mod->automations[i];
+		uint8_t *head = NULL;
+
+		if(automation->type == AUTO_TYPE_NONE)
+			continue; // skip empty slot
+
+		if(automation->src_enabled)
+		{
+			idx->has_source = true;
+
+			if(automation->property)
+				idx->property_sources |= 1ULL << i;
+			else
+				idx->port_sources |= 1ULL << i;
+		}
+
+		if(automation->property)
+		{
+			head = &idx->property[automation->property & (AUTO_HASH - 1)];
+
+			idx->next_property[i] = *head;
+			*head = i + 1;
+		}
+
+		if(!automation->snk_enabled)
+			continue; // not reachable from automation input
+
+		head = NULL;
+
+		if(automation->type == AUTO_TYPE_MIDI)
+		{
+			const midi_auto_t *mauto = &automation->midi;
+
+			if(  automation->learning
+				|| (mauto->channel < 0) || (mauto->channel >= 0x10)
+				|| (mauto->controller < 0) )
+			{
+				idx->midi_wild |= 1ULL << i;
+			}
+			else
+			{
+				head = &idx->midi[mauto->channel][mauto->controller];
+			}
+		}
+		else if(automation->type == AUTO_TYPE_OSC)
+		{
+			const osc_auto_t *oauto = &automation->osc;
+
+			if(automation->learning || (oauto->path[0] == '\0') )
+				idx->osc_wild |= 1ULL << i;
+			else
+				head = &idx->osc[_automation_hash(oauto->path)];
+		}
+
+		if(head)
+		{
+			idx->next_source[i] = *head;
+			*head = i + 1;
+		}
+	}
+
+	atomic_store_explicit(&mod->auto_index, idx, memory_order_release);
+}
+
 __realtime static port_t *
 _automation_port_find(mod_t *mod, const char *src_sym, LV2_URID src_prop)
 {
@@ -1609,6 +1722,7 @@ _automation_list_rem(sp_app_t *app, const LV2_Atom_Object *obj)
 		if(port)
 		{
 			_automation_list_rem_internal(port, src_prop);
+			_automation_index_rebuild(mod);
 		}
 	}
 }
@@ -1711,13 +1825,19 @@ _automation_list_add(sp_app_t *app, const LV2_Atom_Object *obj)
 				{
 					automation->type = AUTO_TYPE_OSC;
 					if(src_path)
-						strncpy(automation->osc.path, LV2_ATOM_BODY_CONST(src_path), 256);
+					{
+						strncpy(automation->osc.path, LV2_ATOM_BODY_CONST(src_path),
+							sizeof(automation->osc.path) - 1);
+						automation->osc.path[sizeof(automation->osc.path) - 1] = '\0';
+					}
 					else
 						automation->osc.path[0] = '\0';
 				}
 
 				break;
 			}
+
+			_automation_index_rebuild(mod);
 		}
 	}
 }
@@ -193,6 +193,7 @@ sp_app_from_worker(sp_app_t *app, uint32_t len, const void *data)
 			assert(app->block_state == BLOCKING_STATE_WAIT);
 			app->block_state = BLOCKING_STATE_RUN; // release block
 			mod->bypassed = false;
+			atomic_store(&mod->dirty, true); // preset state differs from last save
 
 			if(app->silence_state == SILENCING_STATE_WAIT)
 			{
@@ -331,6 +332,12 @@ sp_app_from_worker(sp_app_t *app, uint32_t len, const void *data)
 
 			break;
 		}
+		case JOB_TYPE_REPLY_ARENA_PLAN:
+		{
+			_sp_app_arena_apply(app, job->status);
+
+			break;
+		}
 		case JOB_TYPE_REPLY_DRAIN:
 		{
 			assert(app->block_state == BLOCKING_STATE_DRAIN);
@@ -433,6 +440,41 @@ sp_worker_from_app(sp_app_t *app, uint32_t len, const void *data)
 
 			break;
 		}
+		case JOB_TYPE_REQUEST_TRACE_DUMP:
+		{
+			const trace_name_t *names = (const void *)job + sizeof(job_t);
+
+			_sp_app_trace_dump(app, job->status, names);
+
+			break;
+		}
+		case JOB_TYPE_REQUEST_STATS_DUMP:
+		{
+			const stats_t *stats = (const void *)job + sizeof(job_t);
+
+			_sp_app_stats_dump(app, job->status, stats);
+
+			break;
+		}
+		case JOB_TYPE_REQUEST_ARENA_PLAN:
+		{
+			_sp_app_arena_plan(app);
+
+			// signal to app
+			job_t *job1 = _sp_worker_to_app_request(app, sizeof(job_t));
+			if(job1)
+			{
+				job1->reply = JOB_TYPE_REPLY_ARENA_PLAN;
+				job1->status = job->status; // epoch
+				_sp_worker_to_app_advance(app, sizeof(job_t));
+			}
+			else
+			{
+				sp_app_log_error(app, "%s: buffer request failed\n", __func__);
+			}
+
+			break;
+		}
 		case JOB_TYPE_REQUEST_MODULE_SYSTEM_PORTS_UPDATE:
 		{
 			mod_t *mod = job->mod;
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <synthpod_app_private.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <math.h>
+#include <time.h>
+
+#define MAX_SRCS 32
+#define MAX_SAMPLES 8192
+
+static float srcs [MAX_SRCS][MAX_SAMPLES] __attribute__((aligned(64)));
+static float gains [MAX_SRCS];
+static float dst_old [MAX_SAMPLES] __attribute__((aligned(64)));
+static float dst_new [MAX_SAMPLES] __attribute__((aligned(64)));
+
+static uint64_t
+_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+// former _port_audio_multiplex: clear, then one scalar pass per source
+static void
+_mix_old(float *val, unsigned nsrc, uint32_t nsamples)
+{
+	memset(val, 0, nsamples * sizeof(float)); // init
+
+	for(unsigned s=0; s<nsrc; s++)
+	{
+		const float *src = srcs[s];
+		const float gain = gains[s];
+
+		if(gain == 1.f)
+		{
+			for(uint32_t j=0; j<nsamples; j++)
+				val[j] += src[j];
+		}
+		else // gain != 1.f
+		{
+			for(uint32_t j=0; j<nsamples; j++)
+				val[j] += src[j] * gain;
+		}
+	}
+}
+
+// current _port_audio_multiplex: MIX_MAX sources per pass of the SIMD kernel
+static void
+_mix_new(mix_cb_t mix, float *val, unsigned nsrc, uint32_t nsamples)
+{
+	const float *src [MIX_MAX];
+	float g0 [MIX_MAX];
+	float dg [MIX_MAX];
+	unsigned n = 0;
+	bool clear = true;
+
+	for(unsigned s=0; s<nsrc; s++)
+	{
+		src[n] = srcs[s];
+		g0[n] = gains[s];
+		dg[n] = 0.f;
+
+		if(++n == MIX_MAX)
+		{
+			mix(val, src, g0, dg, n, clear, nsamples);
+			clear = false;
+			n = 0;
+		}
+	}
+
+	if(n)
+		mix(val, src, g0, dg, n, clear, nsamples);
+	else if(clear)
+		memset(val, 0, nsamples * sizeof(float)); // no sources
+}
+
+int
+main(int argc, char **argv)
+{
+	const unsigned nsrc = argc > 1 ? atoi(argv[1]) : 4;
+	const uint32_t nsamples = argc > 2 ? atoi(argv[2]) : 256;
+	const unsigned ncycles = argc > 3 ? atoi(argv[3]) : 100000;
+
+	assert(nsrc <= MAX_SRCS);
+	assert(nsamples <= MAX_SAMPLES);
+	assert(ncycles > 0);
+
+	srand(1234567890);
+	for(unsigned s=0; s<nsrc; s++)
+	{
+		for(uint32_t j=0; j<nsamples; j++)
+			srcs[s][j] = (float)rand() / RAND_MAX * 2.f - 1.f;
+
+		gains[s] = (s % 2) ? 0.5f : 1.f; // exercise both paths of the old loop
+	}
+
+	const mix_cb_t mix = _sp_app_mix_dispatch();
+
+	// results must agree up to rounding
+	_mix_old(dst_old, nsrc, nsamples);
+	_mix_new(mix, dst_new, nsrc, nsamples);
+	for(uint32_t j=0; j<nsamples; j++)
+		assert(fabsf(dst_old[j] - dst_new[j]) <= 1e-5f * (nsrc + 1));
+
+	const uint64_t t0 = _now();
+	for(unsigned i=0; i<ncycles; i++)
+	{
+		_mix_old(dst_old, nsrc, nsamples);
+		__asm__ volatile("" : : "r"(dst_old) : "memory");
+	}
+	const uint64_t t1 = _now();
+	for(unsigned i=0; i<ncycles; i++)
+	{
+		_mix_new(mix, dst_new, nsrc, nsamples);
+		__asm__ volatile("" : : "r"(dst_new) : "memory");
+	}
+	const uint64_t t2 = _now();
+
+	const double old_ns = (double)(t1 - t0) / ncycles;
+	const double new_ns = (double)(t2 - t1) / ncycles;
+
+	printf("%2u sources, %4"PRIu32" samples: old %9.1f ns, simd %9.1f ns, speedup %5.2fx\n",
+		nsrc, nsamples, old_ns, new_ns, old_ns / new_ns);
+
+	return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <synthpod_app_seq.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <time.h>
+
+#define MAX_EVENTS 1024 // per source and cycle
+#define OSC_SIZE 32 // typical body size of a small OSC message
+#define SRC_CAPACITY (sizeof(LV2_Atom_Sequence) + MAX_EVENTS*(sizeof(LV2_Atom_Event) + OSC_SIZE))
+#define DST_CAPACITY (MAX_SOURCES * SRC_CAPACITY)
+
+// arbitrary URIDs, the multiplexer does not look at event types
+#define MIDI_EVENT 1
+#define OSC_EVENT 2
+
+static LV2_Atom_Sequence *seq [MAX_SOURCES];
+static LV2_Atom_Sequence *dst_old;
+static LV2_Atom_Sequence *dst_new;
+
+static uint64_t
+_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static int
+_cmp_frames(const void *a, const void *b)
+{
+	const int64_t *A = a;
+	const int64_t *B = b;
+
+	return (*A > *B) - (*A < *B);
+}
+
+// even sources carry MIDI, odd sources carry OSC
+static void
+_fill(LV2_Atom_Sequence *src, unsigned s, unsigned nev, uint32_t nsamples)
+{
+	int64_t frames [MAX_EVENTS];
+	struct {
+		LV2_Atom_Event ev;
+		uint8_t body [OSC_SIZE];
+	} buf;
+
+	for(unsigned i=0; i<nev; i++)
+		frames[i] = rand() % nsamples;
+	qsort(frames, nev, sizeof(int64_t), _cmp_frames);
+
+	src->atom.type = 0;
+	src->atom.size = sizeof(LV2_Atom_Sequence_Body);
+	src->body.unit = 0;
+	src->body.pad = 0;
+
+	for(unsigned i=0; i<nev; i++)
+	{
+		buf.ev.time.frames = frames[i];
+		buf.ev.body.type = (s % 2) ? OSC_EVENT : MIDI_EVENT;
+		buf.ev.body.size = (s % 2) ? OSC_SIZE : 3;
+		memset(buf.body, s + i, sizeof(buf.body));
+
+		LV2_Atom_Event *ev = lv2_atom_sequence_append_event(src, SRC_CAPACITY, &buf.ev);
+		assert(ev);
+		(void)ev;
+	}
+}
+
+static void
+_clear(LV2_Atom_Sequence *dst)
+{
+	dst->atom.size = sizeof(LV2_Atom_Sequence_Body);
+}
+
+// former _port_seq_multiplex: linear scan over all sources per event
+static void
+_merge_old(LV2_Atom_Sequence *dst, unsigned nsrc, uint32_t nsamples)
+{
+	const LV2_Atom_Event *itr [MAX_SOURCES];
+
+	for(unsigned s=0; s<nsrc; s++)
+		itr[s] = lv2_atom_sequence_begin(&seq[s]->body);
+
+	while(true)
+	{
+		int nxt = -1;
+		int64_t frames = nsamples;
+
+		for(unsigned s=0; s<nsrc; s++)
+		{
+			if(lv2_atom_sequence_is_end(&seq[s]->body, seq[s]->atom.size, itr[s]))
+				continue; // reached sequence end
+
+			if(itr[s]->time.frames < frames)
+			{
+				frames = itr[s]->time.frames;
+				nxt = s;
+			}
+		}
+
+		if(nxt < 0)
+			break; // no more events to process
+
+		const LV2_Atom_Event *ev = itr[nxt];
+
+		lv2_atom_sequence_append_event(dst, DST_CAPACITY, ev);
+
+		itr[nxt] = lv2_atom_sequence_next(ev);
+	}
+}
+
+// current _port_seq_multiplex: heap of source iterators, bulk copy fast path
+static void
+_merge_new(LV2_Atom_Sequence *dst, unsigned nsrc, uint32_t nsamples)
+{
+	const LV2_Atom_Event *itr [MAX_SOURCES];
+	seq_heap_t heap = { .num = 0 };
+
+	for(unsigned s=0; s<nsrc; s++)
+		itr[s] = lv2_atom_sequence_begin(&seq[s]->body);
+
+	_seq_heap_seed(&heap, (const LV2_Atom_Sequence *const *)seq, itr, nsrc, nsamples);
+
+	if(heap.num == 1)
+	{
+		if(_port_seq_bulk_copy(dst, DST_CAPACITY, seq[heap.srcs[0]], nsamples))
+			return;
+	}
+
+	while(heap.num)
+	{
+		const LV2_Atom_Event *ev = itr[heap.srcs[0]];
+
+		lv2_atom_sequence_append_event(dst, DST_CAPACITY, ev);
+
+		_seq_heap_advance(&heap, (const LV2_Atom_Sequence *const *)seq, itr, nsamples);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	const unsigned nsrc = argc > 1 ? atoi(argv[1]) : 8;
+	const unsigned nev = argc > 2 ? atoi(argv[2]) : 64;
+	const uint32_t nsamples = argc > 3 ? atoi(argv[3]) : 256;
+	const unsigned ncycles = argc > 4 ? atoi(argv[4]) : 10000;
+
+	assert( (nsrc > 0) && (nsrc <= MAX_SOURCES) );
+	assert(nev <= MAX_EVENTS);
+	assert(nsamples > 0);
+	assert(ncycles > 0);
+
+	srand(1234567890);
+	for(unsigned s=0; s<nsrc; s++)
+	{
+		seq[s] = malloc(SRC_CAPACITY);
+		assert(seq[s]);
+
+		_fill(seq[s], s, nev, nsamples);
+	}
+
+	dst_old = malloc(DST_CAPACITY);
+	dst_new = malloc(DST_CAPACITY);
+	assert(dst_old && dst_new);
+
+	// merged sequences must be identical, ties keep source order in both
+	_clear(dst_old);
+	_merge_old(dst_old, nsrc, nsamples);
+	_clear(dst_new);
+	_merge_new(dst_new, nsrc, nsamples);
+	assert(dst_old->atom.size == dst_new->atom.size);
+	assert(!memcmp(dst_old, dst_new, sizeof(LV2_Atom) + dst_old->atom.size));
+
+	const uint64_t t0 = _now();
+	for(unsigned i=0; i<ncycles; i++)
+	{
+		_clear(dst_old);
+		_merge_old(dst_old, nsrc, nsamples);
+	}
+	const uint64_t t1 = _now();
+	for(unsigned i=0; i<ncycles; i++)
+	{
+		_clear(dst_new);
+		_merge_new(dst_new, nsrc, nsamples);
+	}
+	const uint64_t t2 = _now();
+
+	const double old_ns = (double)(t1 - t0) / ncycles;
+	const double new_ns = (double)(t2 - t1) / ncycles;
+
+	printf("%2u sources, %4u events/source, %4"PRIu32" samples: scan %9.1f ns, heap %9.1f ns, speedup %5.2fx\n",
+		nsrc, nev, nsamples, old_ns, new_ns, old_ns / new_ns);
+
+	for(unsigned s=0; s<nsrc; s++)
+		free(seq[s]);
+	free(dst_old);
+	free(dst_new);
+
+	return 0;
+}
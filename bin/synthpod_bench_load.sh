@@ -0,0 +1,111 @@
+#!/bin/sh
+#
+# Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+#
+# This is free software: you can redistribute it and/or modify
+# it under the terms of the Artistic License 2.0 as published by
+# The Perl Foundation.
+#
+# This source is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# Artistic License 2.0 for more details.
+#
+# You should have received a copy of the Artistic License 2.0
+# along the source as a COPYING file. If not, obtain it from
+# http://www.perlfoundation.org/artistic_license_2_0.
+
+# generate a synthetic N-module bundle and report the wall time needed to
+# instantiate and restore its modules with synthpod_dummy
+#
+# usage: synthpod_bench_load.sh [NUM_MODULES] [PLUGIN_URI] [SYNTHPOD_DUMMY]
+
+set -e
+
+NUM=${1:-120}
+PLUGIN=${2:-http://open-music-kontrollers.ch/lv2/synthpod#heavyload}
+DUMMY=${3:-synthpod_dummy}
+
+BUNDLE=$(mktemp -d /tmp/synthpod_bench_XXXXXX.preset.lv2)
+LOG=${BUNDLE}.log
+trap 'rm -rf "${BUNDLE}" "${LOG}"' EXIT
+
+cat > "${BUNDLE}/manifest.ttl" <<EOF
+@prefix lv2:  <http://lv2plug.in/ns/lv2core#> .
+@prefix pset: <http://lv2plug.in/ns/ext/presets#> .
+@prefix rdfs: <http://www.w3.org/2000/01/rdf-schema#> .
+
+<state.ttl>
+	a pset:Preset ;
+	lv2:appliesTo <http://open-music-kontrollers.ch/lv2/synthpod#stereo> ;
+	rdfs:seeAlso <state.ttl> .
+EOF
+
+{
+	cat <<EOF
+@prefix lv2:   <http://lv2plug.in/ns/lv2core#> .
+@prefix pset:  <http://lv2plug.in/ns/ext/presets#> .
+@prefix state: <http://lv2plug.in/ns/ext/state#> .
+@prefix xsd:   <http://www.w3.org/2001/XMLSchema#> .
+@prefix spod:  <http://open-music-kontrollers.ch/lv2/synthpod#> .
+
+<>
+	a pset:Preset ;
+	lv2:appliesTo spod:stereo ;
+	state:state [
+		spod:moduleList [
+EOF
+
+	i=0
+	while [ ${i} -lt ${NUM} ]; do
+		URN=$(printf "urn:uuid:00000000-0000-4000-8000-%012x" ${i})
+
+		printf "\t\t\t<%s> [\n\t\t\t\ta <%s> ;\n" "${URN}" "${PLUGIN}"
+		printf "\t\t\t\tspod:moduleCreated \"%d\"^^xsd:int ;\n" $((i + 1))
+		printf "\t\t\t\tspod:modulePositionX \"%d.0\"^^xsd:float ;\n" $((i % 16 * 100))
+		printf "\t\t\t\tspod:modulePositionY \"%d.0\"^^xsd:float\n" $((i / 16 * 100))
+		printf "\t\t\t] ;\n"
+
+		mkdir -p "${BUNDLE}/${URN}"
+		cat > "${BUNDLE}/${URN}/state.ttl" <<EOF
+@prefix lv2:  <http://lv2plug.in/ns/lv2core#> .
+@prefix pset: <http://lv2plug.in/ns/ext/presets#> .
+
+<>
+	a pset:Preset ;
+	lv2:appliesTo <${PLUGIN}> ;
+	lv2:port [
+		lv2:symbol "load" ;
+		pset:value 0.0
+	] .
+EOF
+
+		i=$((i + 1))
+	done
+
+	cat <<EOF
+		]
+	] .
+EOF
+} > "${BUNDLE}/state.ttl"
+
+# the dummy driver keeps running, stop it once the bundle has been restored
+"${DUMMY}" "${BUNDLE}" > "${LOG}" 2>&1 &
+PID=$!
+
+t=0
+while ! grep -q "_mod_load_all: restored" "${LOG}"; do
+	if [ ${t} -ge 600 ] || ! kill -0 ${PID} 2>/dev/null; then
+		kill ${PID} 2>/dev/null || true
+		cat "${LOG}" >&2
+		echo "bundle failed to load" >&2
+		exit 1
+	fi
+	sleep 0.1
+	t=$((t + 1))
+done
+
+kill ${PID} 2>/dev/null || true
+wait ${PID} 2>/dev/null || true
+
+grep "_mod_load_all: restored" "${LOG}"
@@ -0,0 +1,259 @@
+#!/bin/sh
+#
+# Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+#
+# This is free software: you can redistribute it and/or modify
+# it under the terms of the Artistic License 2.0 as published by
+# The Perl Foundation.
+#
+# This source is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# Artistic License 2.0 for more details.
+#
+# You should have received a copy of the Artistic License 2.0
+# along the source as a COPYING file. If not, obtain it from
+# http://www.perlfoundation.org/artistic_license_2_0.
+
+# generate synthetic graphs of 10, 100 and 500 idle heavyload modules, wired
+# up as WIDTH parallel chains, run them with synthpod_dummy and report the
+# per-cycle scheduling time, i.e. the time DSP threads spend outside of any
+# module: fetching and stealing between modules, slave wake-up latencies and
+# the master's barrier wait, as recorded by the DSP trace (-R)
+#
+# cycles are delimited by the master's barrier, thus at least one slave core is
+# needed, extra driver arguments (e.g. '-c 4' for slave cores) are taken from
+# DUMMY_ARGS, compare schedulers by pointing SYNTHPOD_DUMMY at different builds
+#
+# usage: synthpod_bench_sched.sh [WIDTH] [DURATION] [SYNTHPOD_DUMMY]
+
+set -e
+
+WIDTH=${1:-4}
+DURATION=${2:-5}
+DUMMY=${3:-synthpod_dummy}
+PLUGIN=http://open-music-kontrollers.ch/lv2/synthpod#heavyload
+
+DUMPS=10 # trace dumps per graph, each covers the last few cycles only
+
+BUNDLE=$(mktemp -d /tmp/synthpod_bench_XXXXXX.preset.lv2)
+LOG=${BUNDLE}.log
+TRACE=${BUNDLE}.trace
+EVENTS=${BUNDLE}.events
+CYCLES=${BUNDLE}.cycles
+trap 'rm -rf "${BUNDLE}" "${LOG}" "${TRACE}"-*.json "${EVENTS}" "${CYCLES}"' EXIT
+
+urn()
+{
+	printf "urn:uuid:00000000-0000-4000-8000-%012x" ${1}
+}
+
+bench()
+{
+	NUM=${1}
+
+	rm -rf "${BUNDLE}"/* "${TRACE}"-*.json "${CYCLES}"
+
+	cat > "${BUNDLE}/manifest.ttl" <<EOF
+@prefix lv2:  <http://lv2plug.in/ns/lv2core#> .
+@prefix pset: <http://lv2plug.in/ns/ext/presets#> .
+@prefix rdfs: <http://www.w3.org/2000/01/rdf-schema#> .
+
+<state.ttl>
+	a pset:Preset ;
+	lv2:appliesTo <http://open-music-kontrollers.ch/lv2/synthpod#stereo> ;
+	rdfs:seeAlso <state.ttl> .
+EOF
+
+	{
+		cat <<EOF
+@prefix lv2:   <http://lv2plug.in/ns/lv2core#> .
+@prefix pset:  <http://lv2plug.in/ns/ext/presets#> .
+@prefix state: <http://lv2plug.in/ns/ext/state#> .
+@prefix xsd:   <http://www.w3.org/2001/XMLSchema#> .
+@prefix param: <http://lv2plug.in/ns/ext/parameters#> .
+@prefix spod:  <http://open-music-kontrollers.ch/lv2/synthpod#> .
+
+<>
+	a pset:Preset ;
+	lv2:appliesTo spod:stereo ;
+	state:state [
+		spod:moduleList [
+EOF
+
+		i=0
+		while [ ${i} -lt ${NUM} ]; do
+			URN=$(urn ${i})
+
+			printf "\t\t\t<%s> [\n\t\t\t\ta <%s> ;\n" "${URN}" "${PLUGIN}"
+			printf "\t\t\t\tspod:moduleCreated \"%d\"^^xsd:int ;\n" $((i + 1))
+			printf "\t\t\t\tspod:modulePositionX \"%d.0\"^^xsd:float ;\n" $((i / WIDTH * 100))
+			printf "\t\t\t\tspod:modulePositionY \"%d.0\"^^xsd:float\n" $((i % WIDTH * 100))
+			printf "\t\t\t] ;\n"
+
+			mkdir -p "${BUNDLE}/${URN}"
+			cat > "${BUNDLE}/${URN}/state.ttl" <<EOF
+@prefix lv2:  <http://lv2plug.in/ns/lv2core#> .
+@prefix pset: <http://lv2plug.in/ns/ext/presets#> .
+
+<>
+	a pset:Preset ;
+	lv2:appliesTo <${PLUGIN}> ;
+	lv2:port [
+		lv2:symbol "load" ;
+		pset:value 0.0
+	] .
+EOF
+
+			i=$((i + 1))
+		done
+
+		printf "\t\t] ;\n\t\tspod:connectionList (\n"
+
+		# module i feeds module i+WIDTH, e.g. WIDTH independent chains
+		i=${WIDTH}
+		while [ ${i} -lt ${NUM} ]; do
+			printf "\t\t\t[\n"
+			printf "\t\t\t\tspod:sourceModule <%s> ;\n" "$(urn $((i - WIDTH)))"
+			printf "\t\t\t\tspod:sourceSymbol \"audio_out\" ;\n"
+			printf "\t\t\t\tspod:sinkModule <%s> ;\n" "$(urn ${i})"
+			printf "\t\t\t\tspod:sinkSymbol \"audio_in\" ;\n"
+			printf "\t\t\t\tparam:gain \"1.0\"^^xsd:float\n"
+			printf "\t\t\t]\n"
+
+			i=$((i + 1))
+		done
+
+		cat <<EOF
+		)
+	] .
+EOF
+	} > "${BUNDLE}/state.ttl"
+
+	"${DUMMY}" ${DUMMY_ARGS} -R "${TRACE}" "${BUNDLE}" > "${LOG}" 2>&1 &
+	PID=$!
+
+	t=0
+	while ! grep -q "_mod_load_all: restored" "${LOG}"; do
+		if [ ${t} -ge 600 ] || ! kill -0 ${PID} 2>/dev/null; then
+			kill ${PID} 2>/dev/null || true
+			cat "${LOG}" >&2
+			echo "bundle failed to load" >&2
+			exit 1
+		fi
+		sleep 0.1
+		t=$((t + 1))
+	done
+
+	# let the graph settle, then dump the trace rings repeatedly
+	sleep ${DURATION}
+
+	i=0
+	while [ ${i} -lt ${DUMPS} ]; do
+		kill -USR1 ${PID}
+		sleep 0.5
+		i=$((i + 1))
+	done
+
+	t=0
+	while [ $(grep -c "_sp_app_trace_dump: wrote" "${LOG}") -lt ${DUMPS} ]; do
+		if [ ${t} -ge 100 ]; then
+			break # take what has been written
+		fi
+		sleep 0.1
+		t=$((t + 1))
+	done
+
+	kill ${PID} 2>/dev/null || true
+	wait ${PID} 2>/dev/null || true
+
+	for DUMP in "${TRACE}"-*.json; do
+		[ -f "${DUMP}" ] || continue
+
+		# one line per event: tid, start and duration in ns, phase
+		awk '
+			/"ph":"X"/ {
+				match($0, /"tid":[0-9]+/)
+				tid = substr($0, RSTART + 6, RLENGTH - 6)
+				match($0, /"ts":[0-9.]+/)
+				ts = substr($0, RSTART + 5, RLENGTH - 5) * 1000
+				match($0, /"dur":[0-9.]+/)
+				dur = substr($0, RSTART + 6, RLENGTH - 6) * 1000
+				if(match($0, /"phase":"[^"]+"/))
+					phase = substr($0, RSTART + 9, RLENGTH - 10)
+				else if(match($0, /"name":"[^"]+"/))
+					phase = substr($0, RSTART + 8, RLENGTH - 9)
+				printf("%s %.0f %.0f %s\n", tid, ts, dur, phase)
+			}' "${DUMP}" | sort -k1,1n -k2,2n > "${EVENTS}"
+
+		# first pass: cycle ends from master barriers and earliest event per
+		# thread, second pass: sum per cycle the gaps between consecutive events
+		# of each thread, plus wake-up and barrier durations, skip cycles which
+		# are not fully covered by all rings
+		awk '
+			NR == FNR {
+				if( ($1 == 0) && ($4 == "barrier") )
+					end[nend++] = $2 + $3
+				if( !($1 in first) || ($2 < first[$1]) )
+					first[$1] = $2
+				next
+			}
+			FNR == 1 {
+				for(tid in first)
+					if(first[tid] > start)
+						start = first[tid]
+				cur = -1
+			}
+			{
+				if($1 != cur)
+				{
+					cur = $1
+					k = 0
+					pk = -1
+				}
+
+				while( (k < nend) && ($2 >= end[k]) )
+					k++
+
+				if( (k == 0) || (k == nend) || (end[k-1] < start) )
+					next # partial cycle
+
+				if(k != pk)
+					prev = -1
+
+				if( ($4 == "wake") || ($4 == "barrier") )
+					sched[k] += $3
+				if( (prev >= 0) && ($2 > prev) )
+					sched[k] += $2 - prev
+
+				prev = $2 + $3
+				pk = k
+				seen[k] = 1
+			}
+			END {
+				for(k in seen)
+					printf("%.0f\n", sched[k])
+			}' "${EVENTS}" "${EVENTS}" >> "${CYCLES}"
+	done
+
+	if [ ! -s "${CYCLES}" ]; then
+		cat "${LOG}" >&2
+		echo "no complete cycles traced, are there slave cores?" >&2
+		exit 1
+	fi
+
+	sort -n "${CYCLES}" | awk -v num=${NUM} '
+		{
+			v[n++] = $1
+		}
+		END {
+			p50 = v[int(n * 0.5)]
+			p99 = v[int(n * 0.99)]
+			printf("modules: %4d, cycles: %5d, scheduling p50: %8d ns, p99: %8d ns (%.1f / %.1f ns/module)\n",
+				num, n, p50, p99, p50 / num, p99 / num)
+		}'
+}
+
+for NUM in 10 100 500; do
+	bench ${NUM}
+done
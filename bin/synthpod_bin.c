@@ -23,6 +23,7 @@
 #include <signal.h>
 
 #include <synthpod_bin.h>
+#include <synthpod_static_uris.h>
 #include <sandbox_slave.h>
 #include <synthpod_sandbox_x11_driver.h>
 
@@ -121,8 +122,6 @@ _app_to_ui_advance(size_t written, void *data)
 
 	if(sandbox_master_send(bin->sb, NOTIFY_PORT_INDEX, written, bin->atom_eventTransfer, ui_buf) == -1)
 		bin_log_trace(bin, "%s: buffer overflow\n", __func__);
-
-	sandbox_master_signal_tx(bin->sb);
 }
 
 __realtime static void *
@@ -163,83 +162,58 @@ _worker_to_app_advance(size_t written, void *data)
 	varchunk_write_advance(bin->app_from_worker, written);
 }
 
-static inline void
-_atomic_spin_lock(atomic_flag *flag)
-{
-	while(atomic_flag_test_and_set_explicit(flag, memory_order_acquire))
-	{
-		// spin
-	}
-}
-
 static inline bool
-_atomic_try_lock(atomic_flag *flag)
+_is_dsp_thread(bin_t *bin)
 {
-	return !atomic_flag_test_and_set_explicit(flag, memory_order_acquire);
-}
+	const pthread_t this = pthread_self();
 
-static inline void
-_atomic_unlock(atomic_flag *flag)
-{
-	atomic_flag_clear_explicit(flag, memory_order_release);
+	return pthread_equal(this, bin->dsp_thread);
 }
 
-static inline bool
-_is_dsp_thread(bin_t *bin)
+__non_realtime static void
+_log_print(bin_t *bin, LV2_URID type, const char *line)
 {
-	const pthread_t this = pthread_self();
+	int idx = COLOR_LOG;
+	if(type == bin->log_trace)
+		idx = COLOR_TRACE;
+	else if(type == bin->log_error)
+		idx = COLOR_ERROR;
+	else if(type == bin->log_note)
+		idx = COLOR_NOTE;
+	else if(type == bin->log_warning)
+		idx = COLOR_WARNING;
 
-	return pthread_equal(this, bin->dsp_thread);
+	//TODO send to UI?
+
+	const int istty = isatty(STDERR_FILENO);
+	fprintf(stderr, "%s %s %s", prefix[istty][COLOR_DSP], prefix[istty][idx], line);
 }
 
-__non_realtime static int
+__realtime static int
 _log_vprintf(void *data, LV2_URID type, const char *fmt, va_list args)
 {
 	bin_t *bin = data;
 
-	const bool is_worker_thread = !_is_dsp_thread(bin);
-
-	// check for trace mode AND DSP thread ID
-	if(!is_worker_thread)
+	// defer formatting of all threads but the worker to the latter
+	if(!pthread_equal(pthread_self(), bin->worker_thread))
 	{
-		size_t written = -1;
-		if(_atomic_try_lock(&bin->trace_lock)) //FIXME use per-dsp-thread ringbuffer
-		{
-			size_t sz = 0;
-			char *trace;
-			if((trace = varchunk_write_request_max(bin->app_to_log, 512, &sz)))
-			{
-				vsnprintf(trace, sz, fmt, args);
+		va_list copy;
+		va_copy(copy, args);
+		const int written = bin_log_record(bin, type, fmt, copy);
+		va_end(copy);
 
-				written = strlen(trace) + 1;
-				varchunk_write_advance(bin->app_to_log, written);
-				sem_post(&bin->sem);
-			}
-		}
-		_atomic_unlock(&bin->trace_lock);
-		return written;
-	}
-	else
-	{
-		// !log_trace OR not DSP thread ID
-		int idx = COLOR_LOG;
-		if(type == bin->log_trace)
-			idx = COLOR_TRACE;
-		else if(type == bin->log_error)
-			idx = COLOR_ERROR;
-		else if(type == bin->log_note)
-			idx = COLOR_NOTE;
-		else if(type == bin->log_warning)
-			idx = COLOR_WARNING;
-
-		//TODO send to UI?
-
-		const int istty = isatty(STDERR_FILENO);
-		fprintf(stderr, "%s %s ", prefix[istty][COLOR_DSP], prefix[istty][idx]);
-		return vfprintf(stderr, fmt, args);
+		if(written >= 0)
+			return written;
+
+		if(_is_dsp_thread(bin))
+			return -1; // out of log rings, never block the DSP thread
 	}
 
-	return 0;
+	char line [LOG_LINE_MAX];
+	const int written = vsnprintf(line, sizeof(line), fmt, args);
+	_log_print(bin, type, line);
+
+	return written;
 }
 
 __non_realtime static int __attribute__((format(printf, 3, 4)))
@@ -297,6 +271,13 @@ _sig(int sig)
 		sem_post(&bin_ptr->sem);
 }
 
+__non_realtime static void
+_sig_trace(int sig)
+{
+	if(bin_ptr && bin_ptr->app)
+		sp_app_trace_request(bin_ptr->app);
+}
+
 __realtime static char *
 _mapper_alloc_rt(void *data, size_t size)
 {
@@ -360,16 +341,19 @@ bin_init(bin_t *bin, uint32_t sample_rate)
 
 	bin->sample_rate = sample_rate;
 
+	cross_clock_init(&bin->clk_mono, CROSS_CLOCK_MONOTONIC);
+	cross_clock_init(&bin->clk_real, CROSS_CLOCK_REALTIME);
+
 	// varchunk init
 	sem_init(&bin->sem, 0, 0);
 	bin->app_to_worker = varchunk_new(CHUNK_SIZE, true);
 	bin->app_from_worker = varchunk_new(CHUNK_SIZE, true);
-	bin->app_to_log = varchunk_new(CHUNK_SIZE, true);
 	bin->app_from_com = varchunk_new(CHUNK_SIZE, false);
 	bin->app_from_app = varchunk_new(CHUNK_SIZE, false);
 
 	bin->lfrtm = lfrtm_new(512, 0x100000); // 1M
-	bin->mapper = mapper_new(0x20000, 0, NULL, _mapper_alloc_rt, _mapper_free_rt, bin); // 128K
+	bin->mapper = mapper_new(0x20000, SYNTHPOD_NSTATIC_URIS, synthpod_static_uris,
+		_mapper_alloc_rt, _mapper_free_rt, bin); // 128K
 
 	bin->map = mapper_get_map(bin->mapper);
 	bin->unmap = mapper_get_unmap(bin->mapper);
@@ -388,7 +372,7 @@ bin_init(bin_t *bin, uint32_t sample_rate)
 	bin->log.handle = bin;
 	bin->log.printf = _log_printf;
 	bin->log.vprintf = _log_vprintf;
-	bin->trace_lock = (atomic_flag)ATOMIC_FLAG_INIT;
+	bin_log_init(bin);
 	
 	bin->app_driver.map = bin->map;
 	bin->app_driver.unmap = bin->unmap;
@@ -401,10 +385,17 @@ bin_init(bin_t *bin, uint32_t sample_rate)
 	bin->app_driver.to_app_request = _worker_to_app_request;
 	bin->app_driver.to_app_advance = _worker_to_app_advance;
 	bin->app_driver.num_slaves = bin->num_slaves;
+	bin->app_driver.slave_spin = bin->slave_spin;
+	bin->app_driver.num_workers = bin->num_workers > 0 ? bin->num_workers : 0;
 
 	bin->app_driver.audio_prio = bin->audio_prio;
 	bin->app_driver.bad_plugins = bin->bad_plugins;
 	bin->app_driver.cpu_affinity = bin->cpu_affinity;
+	bin->app_driver.cpu_exclusive = bin->cpu_exclusive;
+	bin->app_driver.cpu_single_node = bin->cpu_single_node;
+	bin->app_driver.cpu_list = bin->cpu_list;
+	bin->app_driver.trace_path = bin->trace_path;
+	bin->app_driver.stats_path = bin->stats_path;
 	bin->app_driver.close_request = _close_request;
 	bin->app_driver.opened = _opened;
 	bin->app_driver.saved = _saved;
@@ -419,12 +410,14 @@ bin_init(bin_t *bin, uint32_t sample_rate)
 	bin->sb_driver.unmap = bin->unmap;
 	bin->sb_driver.recv_cb = _sb_recv_cb;
 	bin->sb_driver.subscribe_cb = _sb_subscribe_cb;
+	bin->sb_driver.update_rate = bin->update_rate;
 
 	bin->sb = sandbox_master_new(&bin->sb_driver, bin, SBOX_BUF_SIZE);
 
 	signal(SIGTERM, _sig);
 	signal(SIGQUIT, _sig);
 	signal(SIGINT, _sig);
+	signal(SIGUSR1, _sig_trace);
 
 	if(!nsmc_managed())
 	{
@@ -433,9 +426,6 @@ bin_init(bin_t *bin, uint32_t sample_rate)
 			bin_show(bin);
 		}
 	}
-
-	cross_clock_init(&bin->clk_mono, CROSS_CLOCK_MONOTONIC);
-	cross_clock_init(&bin->clk_real, CROSS_CLOCK_REALTIME);
 }
 
 static bool
@@ -590,10 +580,18 @@ bin_run(bin_t *bin, const char *name, char **argv, nsmc_callback_t callback)
 			}
 		}
 
+		// grow URID table before probing gets slow or it runs full
+		if(mapper_grow(bin->mapper))
+		{
+			bin_log_trace(bin, "%s: URID table grown (%"PRIu32" URIDs)\n", __func__,
+				mapper_get_usage(bin->mapper));
+		}
+
 		// read events from worker
 		{
 			size_t size;
 			const void *body;
+			// free space for DSP thread after each job, some take long (e.g. module deletion)
 			while((body = varchunk_read_request(bin->app_to_worker, &size)))
 			{
 				sp_worker_from_app(bin->app, size, body);
@@ -602,17 +600,7 @@ bin_run(bin_t *bin, const char *name, char **argv, nsmc_callback_t callback)
 		}
 
 		// read events from logger
-		{
-			size_t size;
-			const char *trace;
-			while((trace = varchunk_read_request(bin->app_to_log, &size)))
-			{
-				const int istty = isatty(STDERR_FILENO);
-				fprintf(stderr, "%s %s %s", prefix[istty][COLOR_DSP], prefix[istty][COLOR_TRACE], trace);
-
-				varchunk_read_advance(bin->app_to_log);
-			}
-		}
+		bin_log_drain(bin, _log_print);
 
 		// run NSM
 		if(nsmc_managed())
@@ -814,13 +802,14 @@ bin_deinit(bin_t *bin)
 
 	// varchunk deinit
 	sem_destroy(&bin->sem);
-	varchunk_free(bin->app_to_log);
 	varchunk_free(bin->app_to_worker);
 	varchunk_free(bin->app_from_worker);
 	varchunk_free(bin->app_from_com);
 	varchunk_free(bin->app_from_app);
 
+	bin_log_drain(bin, _log_print);
 	bin_log_note(bin, "bye\n");
+	bin_log_deinit(bin);
 
 	cross_clock_deinit(&bin->clk_mono);
 	cross_clock_deinit(&bin->clk_real);
@@ -885,7 +874,8 @@ bin_process_pre(bin_t *bin, uint32_t nsamples, bool bypassed)
 __realtime void
 bin_process_post(bin_t *bin)
 {
-	// nothing
+	// publish all messages of this cycle to UI at once
+	sandbox_master_signal_tx(bin->sb);
 }
 
 __non_realtime int
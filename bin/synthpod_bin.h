@@ -22,6 +22,8 @@
 #include <pthread.h>
 #include <stdatomic.h>
 #include <limits.h>
+#include <stdalign.h>
+#include <stdarg.h>
 
 #include <synthpod_app.h>
 
@@ -52,9 +54,34 @@
 
 #define SEQ_SIZE 0x2000
 #define JAN_1970 (uint64_t)0x83aa7e80
+#define LOG_THREADS 16 // threads besides DSP slaves and worker pool with their own binary log ring
+#define LOG_RING_SIZE 0x10000 // 64K
+#define LOG_RECORD_MAX 512
+#define LOG_LINE_MAX 1024
 
+typedef struct _bin_log_t bin_log_t;
 typedef struct _bin_t bin_t;
 
+typedef void (*bin_log_print_t)(bin_t *bin, LV2_URID type, const char *line);
+
+struct _bin_log_t {
+	varchunk_t *rb;
+	atomic_bool used;
+	atomic_uint_fast64_t repeats; // sequence number of last record << 32 | repeats
+	atomic_uint dropped;
+
+	// owned by writer thread
+	uint32_t seq;
+	uint32_t tokens;
+	uint64_t t0;
+	size_t last_size;
+	alignas(uint64_t) uint8_t last [LOG_RECORD_MAX];
+
+	// owned by worker thread
+	uint32_t drained;
+	LV2_URID drained_type;
+};
+
 struct _bin_t {
 	atomic_bool inject;
 	lfrtm_t *lfrtm;
@@ -70,7 +97,9 @@ struct _bin_t {
 	sem_t sem;
 	varchunk_t *app_to_worker;
 	varchunk_t *app_from_worker;
-	varchunk_t *app_to_log;
+	pthread_key_t log_key;
+	bin_log_t *logs; // one ring per thread, sized by bin_log_init
+	unsigned num_logs;
 
 	varchunk_t *app_from_com;
 
@@ -94,7 +123,6 @@ struct _bin_t {
 	pthread_t gui_thread;
 	pthread_t worker_thread;
 	pthread_t dsp_thread;
-	atomic_flag trace_lock;
 
 	bool d2tk_gui;
 	bool has_gui;
@@ -103,10 +131,17 @@ struct _bin_t {
 	int audio_prio;
 	int worker_prio;
 	int num_slaves;
+	int slave_spin;
+	int num_workers;
 	bool bad_plugins;
 	char socket_path [NAME_MAX];
 	int update_rate;
 	bool cpu_affinity;
+	bool cpu_exclusive;
+	bool cpu_single_node;
+	const char *cpu_list;
+	const char *trace_path;
+	const char *stats_path;
 
 	sandbox_master_driver_t sb_driver;
 	sandbox_master_t *sb;
@@ -157,6 +192,18 @@ bin_bundle_save(bin_t *bin, const char *bundle_path);
 void
 bin_quit(bin_t *bin);
 
+void
+bin_log_init(bin_t *bin);
+
+void
+bin_log_deinit(bin_t *bin);
+
+int
+bin_log_record(bin_t *bin, LV2_URID type, const char *fmt, va_list args);
+
+void
+bin_log_drain(bin_t *bin, bin_log_print_t print);
+
 int __attribute__((format(printf, 2, 3)))
 bin_log_error(bin_t *bin, const char *fmt, ...);
 
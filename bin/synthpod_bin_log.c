@@ -0,0 +1,689 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include <stdalign.h>
+
+#include <synthpod_bin.h>
+
+/*
+ * binary log channel: threads other than the worker record raw argument
+ * words and a copy of the format into their own SPSC ring, the worker
+ * formats them later on. the format is copied as it may live in a plugin
+ * library which is unloaded before the worker gets to drain the ring.
+ */
+
+#define LOG_SLOT sizeof(uint64_t)
+#define LOG_STRING_MAX 128 // bytes of %s arguments copied into record
+#define LOG_FORMAT_MAX 256 // bytes of format copied into record
+#define LOG_RATE 64 // sustained messages per second per thread
+#define LOG_BURST 64 // messages per thread until rate limiting kicks in
+
+typedef enum _log_arg_t log_arg_t;
+typedef struct _log_spec_t log_spec_t;
+typedef struct _log_record_t log_record_t;
+
+enum _log_arg_t {
+	LOG_ARG_NONE = 0, // %%
+	LOG_ARG_INT,
+	LOG_ARG_LONG,
+	LOG_ARG_LLONG,
+	LOG_ARG_INTMAX,
+	LOG_ARG_SIZE,
+	LOG_ARG_PTRDIFF,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_LDOUBLE,
+	LOG_ARG_PTR,
+	LOG_ARG_STR,
+	LOG_ARG_COUNT, // %n, argument is skipped
+	LOG_ARG_INVALID
+};
+
+struct _log_spec_t {
+	const char *from;
+	const char *to;
+	unsigned stars; // width and precision given as arguments
+	log_arg_t arg;
+};
+
+struct _log_record_t {
+	LV2_URID type;
+	uint32_t seq;
+	uint32_t repeats; // of previous record, coalesced by writer
+	uint32_t size; // of argument words following
+	uint32_t fmt_size; // of format following argument words, padded
+	uint32_t pad;
+};
+
+// ring is free again once its owner thread exits
+static void
+_log_release(void *data)
+{
+	bin_log_t *ring = data;
+
+	atomic_store_explicit(&ring->used, false, memory_order_release);
+}
+
+static inline bool
+_log_digit(char c)
+{
+	return (c >= '0') && (c <= '9');
+}
+
+// advance to next conversion specification, false at end of format
+static bool
+_log_spec_next(const char **fmt, log_spec_t *spec)
+{
+	const char *p = strchr(*fmt, '%');
+
+	if(!p)
+		return false;
+
+	spec->from = p++;
+	spec->stars = 0;
+
+	if(*p == '%')
+	{
+		spec->arg = LOG_ARG_NONE;
+		spec->to = ++p;
+		*fmt = p;
+		return true;
+	}
+
+	while(*p && strchr("-+ #0'", *p))
+		p++;
+
+	if(*p == '*')
+	{
+		spec->stars += 1;
+		p++;
+	}
+	else while(_log_digit(*p))
+		p++;
+
+	if(*p == '.')
+	{
+		p++;
+
+		if(*p == '*')
+		{
+			spec->stars += 1;
+			p++;
+		}
+		else while(_log_digit(*p))
+			p++;
+	}
+
+	log_arg_t integer = LOG_ARG_INT;
+	bool ldouble = false;
+
+	switch(*p)
+	{
+		case 'h':
+			p += (p[1] == 'h') ? 2 : 1; // promoted to int anyway
+			break;
+		case 'l':
+			integer = (p[1] == 'l') ? LOG_ARG_LLONG : LOG_ARG_LONG;
+			p += (p[1] == 'l') ? 2 : 1;
+			break;
+		case 'q':
+			integer = LOG_ARG_LLONG;
+			p++;
+			break;
+		case 'j':
+			integer = LOG_ARG_INTMAX;
+			p++;
+			break;
+		case 'z':
+			integer = LOG_ARG_SIZE;
+			p++;
+			break;
+		case 't':
+			integer = LOG_ARG_PTRDIFF;
+			p++;
+			break;
+		case 'L':
+			ldouble = true;
+			p++;
+			break;
+	}
+
+	switch(*p)
+	{
+		case 'c':
+			spec->arg = LOG_ARG_INT; // wint_t for %lc, promoted all the same
+			break;
+		case 'd':
+		case 'i':
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			spec->arg = integer;
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			spec->arg = ldouble ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+			break;
+		case 's':
+			spec->arg = (integer == LOG_ARG_INT) ? LOG_ARG_STR : LOG_ARG_INVALID; // no %ls
+			break;
+		case 'p':
+			spec->arg = LOG_ARG_PTR;
+			break;
+		case 'n':
+			spec->arg = LOG_ARG_COUNT;
+			break;
+		default:
+			spec->arg = LOG_ARG_INVALID;
+			spec->to = p;
+			*fmt = p;
+			return true;
+	}
+
+	spec->to = ++p;
+	*fmt = p;
+	return true;
+}
+
+static inline bool
+_log_put(uint8_t *buf, size_t max, size_t *off, const void *src, size_t size)
+{
+	const size_t padded = (size + LOG_SLOT - 1) & ~(LOG_SLOT - 1);
+
+	if(*off + padded > max)
+		return false;
+
+	memcpy(buf + *off, src, size);
+	*off += padded;
+
+	return true;
+}
+
+static inline bool
+_log_put_int(uint8_t *buf, size_t max, size_t *off, int64_t i64)
+{
+	return _log_put(buf, max, off, &i64, sizeof(int64_t));
+}
+
+// serialize arguments as walked by format, false on overflow
+__realtime static bool
+_log_encode(uint8_t *buf, size_t max, const char *fmt, va_list args, uint32_t *size)
+{
+	size_t off = 0;
+	log_spec_t spec;
+
+	while(_log_spec_next(&fmt, &spec))
+	{
+		bool ok = true;
+
+		if(spec.arg == LOG_ARG_INVALID)
+			break; // rest of format is printed verbatim
+
+		for(unsigned i=0; ok && (i<spec.stars); i++)
+			ok = _log_put_int(buf, max, &off, va_arg(args, int));
+
+		switch(spec.arg)
+		{
+			case LOG_ARG_INT:
+				ok = ok && _log_put_int(buf, max, &off, va_arg(args, int));
+				break;
+			case LOG_ARG_LONG:
+				ok = ok && _log_put_int(buf, max, &off, va_arg(args, long));
+				break;
+			case LOG_ARG_LLONG:
+				ok = ok && _log_put_int(buf, max, &off, va_arg(args, long long));
+				break;
+			case LOG_ARG_INTMAX:
+				ok = ok && _log_put_int(buf, max, &off, va_arg(args, intmax_t));
+				break;
+			case LOG_ARG_SIZE:
+				ok = ok && _log_put_int(buf, max, &off, va_arg(args, size_t));
+				break;
+			case LOG_ARG_PTRDIFF:
+				ok = ok && _log_put_int(buf, max, &off, va_arg(args, ptrdiff_t));
+				break;
+			case LOG_ARG_DOUBLE:
+			{
+				const double f64 = va_arg(args, double);
+				ok = ok && _log_put(buf, max, &off, &f64, sizeof(double));
+			}	break;
+			case LOG_ARG_LDOUBLE:
+			{
+				const long double f80 = va_arg(args, long double);
+				ok = ok && _log_put(buf, max, &off, &f80, sizeof(long double));
+			}	break;
+			case LOG_ARG_PTR:
+			{
+				const void *ptr = va_arg(args, void *);
+				ok = ok && _log_put(buf, max, &off, &ptr, sizeof(void *));
+			}	break;
+			case LOG_ARG_STR:
+			{
+				const char *str = va_arg(args, const char *);
+				if(!str)
+					str = "(null)";
+
+				// strings may not outlive the call, thus copy them
+				const size_t len = strnlen(str, LOG_STRING_MAX - 1);
+				char tmp [LOG_STRING_MAX];
+				memcpy(tmp, str, len);
+				tmp[len] = '\0';
+
+				ok = ok && _log_put_int(buf, max, &off, len + 1)
+					&& _log_put(buf, max, &off, tmp, len + 1);
+			}	break;
+			case LOG_ARG_COUNT:
+				(void)va_arg(args, void *);
+				break;
+			case LOG_ARG_NONE:
+			case LOG_ARG_INVALID:
+				break;
+		}
+
+		if(!ok)
+			return false;
+	}
+
+	*size = off;
+	return true;
+}
+
+static inline const void *
+_log_get(const uint8_t *buf, size_t size, size_t *off, size_t len)
+{
+	const size_t padded = (len + LOG_SLOT - 1) & ~(LOG_SLOT - 1);
+
+	if(*off + padded > size)
+		return NULL;
+
+	const void *ptr = buf + *off;
+	*off += padded;
+
+	return ptr;
+}
+
+static inline void
+_log_append(size_t max, size_t *len, int written)
+{
+	if(written < 0)
+		return;
+
+	*len += written;
+	if(*len >= max)
+		*len = max - 1;
+}
+
+// format record like vsnprintf would have done, one conversion at a time
+__non_realtime static void
+_log_format(char *line, size_t max, const char *fmt, const uint8_t *buf, size_t size)
+{
+	const char *lit = fmt;
+	size_t len = 0;
+	size_t off = 0;
+	log_spec_t spec;
+
+	line[0] = '\0';
+
+	while(_log_spec_next(&fmt, &spec))
+	{
+		_log_append(max, &len, snprintf(line + len, max - len, "%.*s",
+			(int)(spec.from - lit), lit));
+		lit = fmt;
+
+		if(spec.arg == LOG_ARG_INVALID)
+		{
+			lit = spec.from; // print rest verbatim
+			break;
+		}
+
+		if(spec.arg == LOG_ARG_NONE)
+		{
+			_log_append(max, &len, snprintf(line + len, max - len, "%%"));
+			continue;
+		}
+
+		// substitute width and precision arguments
+		char conv [64];
+		size_t clen = 0;
+
+		for(const char *p = spec.from; p < spec.to; p++)
+		{
+			if(clen + 24 >= sizeof(conv))
+				return; // bogus specification
+
+			if(*p == '*')
+			{
+				const int64_t *i64 = _log_get(buf, size, &off, sizeof(int64_t));
+				if(!i64)
+					return;
+
+				clen += snprintf(conv + clen, sizeof(conv) - clen, "%"PRIi64, *i64);
+			}
+			else
+			{
+				conv[clen++] = *p;
+			}
+		}
+		conv[clen] = '\0';
+
+		const void *val = NULL;
+		int written = 0;
+
+		switch(spec.arg)
+		{
+			case LOG_ARG_INT:
+				if( (val = _log_get(buf, size, &off, sizeof(int64_t))) )
+					written = snprintf(line + len, max - len, conv, (int)*(const int64_t *)val);
+				break;
+			case LOG_ARG_LONG:
+				if( (val = _log_get(buf, size, &off, sizeof(int64_t))) )
+					written = snprintf(line + len, max - len, conv, (long)*(const int64_t *)val);
+				break;
+			case LOG_ARG_LLONG:
+				if( (val = _log_get(buf, size, &off, sizeof(int64_t))) )
+					written = snprintf(line + len, max - len, conv, (long long)*(const int64_t *)val);
+				break;
+			case LOG_ARG_INTMAX:
+				if( (val = _log_get(buf, size, &off, sizeof(int64_t))) )
+					written = snprintf(line + len, max - len, conv, (intmax_t)*(const int64_t *)val);
+				break;
+			case LOG_ARG_SIZE:
+				if( (val = _log_get(buf, size, &off, sizeof(int64_t))) )
+					written = snprintf(line + len, max - len, conv, (size_t)*(const int64_t *)val);
+				break;
+			case LOG_ARG_PTRDIFF:
+				if( (val = _log_get(buf, size, &off, sizeof(int64_t))) )
+					written = snprintf(line + len, max - len, conv, (ptrdiff_t)*(const int64_t *)val);
+				break;
+			case LOG_ARG_DOUBLE:
+				if( (val = _log_get(buf, size, &off, sizeof(double))) )
+					written = snprintf(line + len, max - len, conv, *(const double *)val);
+				break;
+			case LOG_ARG_LDOUBLE:
+			{
+				long double f80;
+				if( (val = _log_get(buf, size, &off, sizeof(long double))) )
+				{
+					memcpy(&f80, val, sizeof(long double));
+					written = snprintf(line + len, max - len, conv, f80);
+				}
+			}	break;
+			case LOG_ARG_PTR:
+				if( (val = _log_get(buf, size, &off, sizeof(void *))) )
+					written = snprintf(line + len, max - len, conv, *(void *const *)val);
+				break;
+			case LOG_ARG_STR:
+			{
+				const int64_t *slen = _log_get(buf, size, &off, sizeof(int64_t));
+				if(slen && (val = _log_get(buf, size, &off, *slen)) )
+					written = snprintf(line + len, max - len, conv, (const char *)val);
+			}	break;
+			case LOG_ARG_COUNT:
+				val = conv; // nothing to print
+				break;
+			case LOG_ARG_NONE:
+			case LOG_ARG_INVALID:
+				break;
+		}
+
+		if(!val)
+			return; // truncated record
+
+		_log_append(max, &len, written);
+	}
+
+	_log_append(max, &len, snprintf(line + len, max - len, "%s", lit));
+}
+
+__non_realtime void
+bin_log_init(bin_t *bin)
+{
+	pthread_key_create(&bin->log_key, _log_release);
+
+	// every DSP slave and worker pool thread needs a ring of its own, as they
+	// must never fall back to blocking formatting
+	unsigned num_workers = bin->num_workers;
+	if(bin->num_workers <= 0) // one per core, as spawned by the worker pool
+	{
+		const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		num_workers = num_cpus > 0 ? num_cpus : 1;
+	}
+
+	bin->num_logs = LOG_THREADS + MAX(bin->num_slaves, 0) + num_workers;
+	bin->logs = calloc(bin->num_logs, sizeof(bin_log_t));
+	if(!bin->logs)
+		bin->num_logs = 0; // all threads fall back to direct formatting
+
+	for(unsigned i=0; i<bin->num_logs; i++)
+	{
+		bin_log_t *ring = &bin->logs[i];
+
+		ring->rb = varchunk_new(LOG_RING_SIZE, true);
+		atomic_init(&ring->used, false);
+		atomic_init(&ring->repeats, 0);
+		atomic_init(&ring->dropped, 0);
+		ring->seq = 0;
+		ring->tokens = LOG_BURST;
+		ring->t0 = 0;
+		ring->last_size = 0;
+		ring->drained = 0;
+		ring->drained_type = 0;
+	}
+}
+
+__non_realtime void
+bin_log_deinit(bin_t *bin)
+{
+	pthread_key_delete(bin->log_key);
+
+	for(unsigned i=0; i<bin->num_logs; i++)
+	{
+		bin_log_t *ring = &bin->logs[i];
+
+		if(ring->rb)
+			varchunk_free(ring->rb);
+	}
+
+	free(bin->logs);
+	bin->logs = NULL;
+	bin->num_logs = 0;
+}
+
+__realtime static bin_log_t *
+_log_ring(bin_t *bin)
+{
+	bin_log_t *ring = pthread_getspecific(bin->log_key);
+
+	if(ring)
+		return ring;
+
+	// claim free ring for this thread, released again on thread exit
+	for(unsigned i=0; i<bin->num_logs; i++)
+	{
+		bool expected = false;
+
+		if(atomic_compare_exchange_strong(&bin->logs[i].used, &expected, true))
+		{
+			ring = &bin->logs[i];
+			ring->tokens = LOG_BURST;
+			ring->last_size = 0;
+			pthread_setspecific(bin->log_key, ring);
+
+			return ring;
+		}
+	}
+
+	return NULL;
+}
+
+// record message in ring of calling thread, -1 if there is no ring left
+__realtime int
+bin_log_record(bin_t *bin, LV2_URID type, const char *fmt, va_list args)
+{
+	bin_log_t *ring = _log_ring(bin);
+
+	if(!ring || !ring->rb)
+		return -1;
+
+	alignas(uint64_t) uint8_t tmp [LOG_RECORD_MAX];
+	log_record_t *rec = (log_record_t *)tmp;
+	uint8_t *body = tmp + sizeof(log_record_t);
+
+	// truncated copy of format, arguments are encoded as walked by the copy
+	alignas(uint64_t) char copy [LOG_FORMAT_MAX];
+	const size_t fmt_len = strnlen(fmt, LOG_FORMAT_MAX - 1);
+	const uint32_t fmt_size = (fmt_len + 1 + LOG_SLOT - 1) & ~(LOG_SLOT - 1);
+
+	memcpy(copy, fmt, fmt_len);
+	memset(copy + fmt_len, 0x0, fmt_size - fmt_len);
+
+	rec->type = type;
+	rec->size = 0;
+	rec->fmt_size = fmt_size;
+	rec->pad = 0;
+
+	if(!_log_encode(body, LOG_RECORD_MAX - sizeof(log_record_t) - fmt_size, copy, args,
+		&rec->size))
+	{
+		atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+		return 0;
+	}
+
+	memcpy(body + rec->size, copy, fmt_size);
+
+	const size_t total = sizeof(log_record_t) + rec->size + fmt_size;
+	const log_record_t *last = (const log_record_t *)ring->last;
+
+	// coalesce repeats of last message, e.g. buffer overflows
+	if(  (ring->last_size == total)
+		&& (last->type == type)
+		&& (last->size == rec->size)
+		&& !memcmp(ring->last + sizeof(log_record_t), body, rec->size + fmt_size) )
+	{
+		atomic_fetch_add_explicit(&ring->repeats, 1, memory_order_release);
+		return 0;
+	}
+
+	// token bucket rate limiting
+	struct timespec ts;
+	cross_clock_gettime(&bin->clk_mono, &ts);
+	const uint64_t now = ts.tv_sec*1000000000ULL + ts.tv_nsec;
+	const uint64_t earned = (now - ring->t0) / (1000000000ULL / LOG_RATE);
+
+	if(earned)
+	{
+		ring->tokens = (ring->tokens + earned > LOG_BURST) ? LOG_BURST : ring->tokens + earned;
+		ring->t0 = now;
+	}
+
+	void *dst;
+	if(!ring->tokens || !(dst = varchunk_write_request(ring->rb, total)) )
+	{
+		atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+		return 0;
+	}
+
+	ring->tokens -= 1;
+	ring->seq += 1;
+
+	// hand over pending repeats of previous record, restart count for this one
+	const uint64_t repeats = atomic_exchange_explicit(&ring->repeats,
+		(uint64_t)ring->seq << 32, memory_order_acq_rel);
+
+	rec->seq = ring->seq;
+	rec->repeats = repeats & UINT32_MAX;
+
+	memcpy(dst, tmp, total);
+	varchunk_write_advance(ring->rb, total);
+	sem_post(&bin->sem);
+
+	memcpy(ring->last, tmp, total);
+	ring->last_size = total;
+
+	return total;
+}
+
+__non_realtime static void
+_log_repeated(bin_t *bin, bin_log_print_t print, LV2_URID type, uint32_t repeats)
+{
+	char line [64];
+
+	snprintf(line, sizeof(line), "last message repeated %"PRIu32" times\n", repeats);
+	print(bin, type, line);
+}
+
+// format and print all recorded messages, called from worker thread
+__non_realtime void
+bin_log_drain(bin_t *bin, bin_log_print_t print)
+{
+	for(unsigned i=0; i<bin->num_logs; i++)
+	{
+		bin_log_t *ring = &bin->logs[i];
+		const log_record_t *rec;
+		size_t size;
+
+		if(!ring->rb)
+			continue;
+
+		while((rec = varchunk_read_request(ring->rb, &size)))
+		{
+			char line [LOG_LINE_MAX];
+
+			if(rec->repeats)
+				_log_repeated(bin, print, ring->drained_type, rec->repeats);
+
+			const uint8_t *body = (const uint8_t *)rec + sizeof(log_record_t);
+
+			_log_format(line, sizeof(line), (const char *)body + rec->size, body, rec->size);
+			print(bin, rec->type, line);
+
+			ring->drained = rec->seq;
+			ring->drained_type = rec->type;
+
+			varchunk_read_advance(ring->rb);
+		}
+
+		// repeats of last drained record, only if writer has not moved on yet
+		uint64_t repeats = atomic_load_explicit(&ring->repeats, memory_order_acquire);
+		while( (repeats & UINT32_MAX) && ((repeats >> 32) == ring->drained) )
+		{
+			if(atomic_compare_exchange_weak_explicit(&ring->repeats, &repeats,
+				repeats & ~(uint64_t)UINT32_MAX, memory_order_acq_rel, memory_order_acquire))
+			{
+				_log_repeated(bin, print, ring->drained_type, repeats & UINT32_MAX);
+				break;
+			}
+		}
+
+		const unsigned dropped = atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+		if(dropped)
+		{
+			char line [64];
+
+			snprintf(line, sizeof(line), "%u messages dropped by rate limiting\n", dropped);
+			print(bin, bin->log_warning, line);
+		}
+	}
+}
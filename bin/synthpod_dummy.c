@@ -282,11 +282,12 @@ _rt_thread(void *data)
 		}
 	}
 
-	if(handle->bin.cpu_affinity)
+	const int cpu = sp_app_dsp_cpu(bin->app);
+	if(handle->bin.cpu_affinity && (cpu >= 0))
 	{
 		cpu_set_t cpuset;
 		CPU_ZERO(&cpuset);
-		CPU_SET(0, &cpuset);
+		CPU_SET(cpu, &cpuset);
 		if(pthread_setaffinity_np(bin->dsp_thread, sizeof(cpu_set_t), &cpuset))
 			bin_log_error(bin, "%s: pthread_setaffinity_np error\n", __func__);
 	}
@@ -506,6 +507,10 @@ _usage(char **argv)
 		"   [-B]                 disable bad plugins (default)\n"
 		"   [-a]                 enable CPU affinity\n"
 		"   [-A]                 disable CPU affinity (default)\n"
+		"   [-e]                 enable exclusive cores without SMT siblings\n"
+		"   [-E]                 disable exclusive cores (default)\n"
+		"   [-m]                 enable single NUMA node\n"
+		"   [-M]                 disable single NUMA node (default)\n"
 		"   [-y] audio-priority  audio thread realtime priority (70)\n"
 		"   [-Y]                 do NOT use audio thread realtime priority\n"
 		"   [-w] worker-priority worker thread realtime priority (60)\n"
@@ -516,6 +521,11 @@ _usage(char **argv)
 		"   [-p] sample-period   frames per period (1024)\n"
 		"   [-s] sequence-size   minimum sequence size (8192)\n"
 		"   [-c] slave-cores     number of slave cores (auto)\n"
+		"   [-S] spin-time       slave spin time in us, 0 or auto (0)\n"
+		"   [-j] worker-threads  threads shared by module workers (auto)\n"
+		"   [-C] cpu-list        CPUs to pin DSP threads to, e.g. 2,4-7 (auto)\n"
+		"   [-R] trace-path      record DSP trace, dump on xrun or SIGUSR1\n"
+		"   [-P] stats-path      write DSP latency percentiles every second\n"
 		"   [-f] update-rate     GUI update rate (25)\n\n"
 		, argv[0]);
 }
@@ -536,6 +546,8 @@ main(int argc, char **argv)
 	bin->audio_prio = 70;
 	bin->worker_prio = 60;
 	bin->num_slaves = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+	bin->slave_spin = 0; // use semaphores by default
+	bin->num_workers = 0; // one per core by default
 	bin->bad_plugins = false;
 	bin->has_gui = false;
 	bin->kill_gui = false;
@@ -543,11 +555,16 @@ main(int argc, char **argv)
 	snprintf(bin->socket_path, sizeof(bin->socket_path), "shm:///synthpod-%i", getpid());
 	bin->update_rate = 25;
 	bin->cpu_affinity = false;
+	bin->cpu_exclusive = false;
+	bin->cpu_single_node = false;
+	bin->cpu_list = NULL;
+	bin->trace_path = NULL;
+	bin->stats_path = NULL;
 
 	bool quiet = false;
 
 	int c;
-	while((c = getopt(argc, argv, "vhqgGkKtTbBaAy:Yw:Wul:r:p:s:c:f:")) != -1)
+	while((c = getopt(argc, argv, "vhqgGkKtTbBaAeEmMy:Yw:Wul:r:p:s:c:S:j:C:R:P:f:")) != -1)
 	{
 		switch(c)
 		{
@@ -590,6 +607,18 @@ main(int argc, char **argv)
 			case 'A':
 				bin->cpu_affinity = false;
 				break;
+			case 'e':
+				bin->cpu_exclusive = true;
+				break;
+			case 'E':
+				bin->cpu_exclusive = false;
+				break;
+			case 'm':
+				bin->cpu_single_node = true;
+				break;
+			case 'M':
+				bin->cpu_single_node = false;
+				break;
 			case 'y':
 				bin->audio_prio = atoi(optarg);
 				break;
@@ -621,11 +650,27 @@ main(int argc, char **argv)
 				if(atoi(optarg) < bin->num_slaves)
 					bin->num_slaves = atoi(optarg);
 				break;
+			case 'S':
+				bin->slave_spin = !strcmp(optarg, "auto") ? -1 : atoi(optarg);
+				break;
+			case 'j':
+				bin->num_workers = atoi(optarg);
+				break;
+			case 'C':
+				bin->cpu_list = optarg;
+				bin->cpu_affinity = true;
+				break;
+			case 'R':
+				bin->trace_path = optarg;
+				break;
+			case 'P':
+				bin->stats_path = optarg;
+				break;
 			case 'f':
 				bin->update_rate = atoi(optarg);
 				break;
 			case '?':
-				if(  (optopt == 'r') || (optopt == 'p') || (optopt == 's') || (optopt == 'c')
+				if(  (optopt == 'r') || (optopt == 'p') || (optopt == 's') || (optopt == 'c') || (optopt == 'S') || (optopt == 'j') || (optopt == 'C') || (optopt == 'R') || (optopt == 'P')
 					|| (optopt == 'l') || (optopt == 'f') )
 					fprintf(stderr, "Option `-%c' requires an argument.\n", optopt);
 				else if(isprint(optopt))
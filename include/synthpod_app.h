@@ -120,10 +120,17 @@ struct _sp_app_driver_t {
 	sp_app_features_t features;
 
 	unsigned num_slaves;
+	int slave_spin; // us to spin before sleeping, 0: semaphores, <0: auto
+	unsigned num_workers; // threads shared by module workers, 0: auto
 
 	int audio_prio;
 	bool bad_plugins;
 	bool cpu_affinity;
+	bool cpu_exclusive; // avoid SMT siblings
+	bool cpu_single_node; // stay on NUMA node of DSP thread
+	const char *cpu_list; // explicit CPUs, DSP thread first
+	const char *trace_path; // prefix of DSP trace dumps, NULL: no tracing
+	const char *stats_path; // latency statistics JSON, NULL: no stats file
 
 	sp_close_request_t close_request;
 	sp_opened_t opened;
@@ -151,6 +158,9 @@ sp_app_from_worker(sp_app_t *app, uint32_t len, const void *data);
 void
 sp_worker_from_app(sp_app_t *app, uint32_t len, const void *data);
 
+int
+sp_app_dsp_cpu(sp_app_t *app);
+
 void
 sp_app_run_pre(sp_app_t *app, uint32_t nsamples);
 
@@ -218,4 +228,7 @@ sp_app_visibility_get(sp_app_t *app);
 void
 sp_app_xrun_report(sp_app_t *app);
 
+void
+sp_app_trace_request(sp_app_t *app);
+
 #endif // _SYNTHPOD_APP_H
@@ -0,0 +1,1242 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#ifndef _SYNTHPOD_INDEX_H
+#define _SYNTHPOD_INDEX_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <synthpod_common.h>
+
+#include <lilv/lilv.h>
+#include <lv2/lv2plug.in/ns/lv2core/lv2.h>
+#include <lv2/lv2plug.in/ns/ext/atom/atom.h>
+#include <lv2/lv2plug.in/ns/ext/presets/presets.h>
+
+// the index is a line-based text file, the last field of each line may contain spaces
+//   spod-index <version>
+//   V <mtime sec> <mtime nsec> <dir path>       for each directory searched for bundles, sorted
+//   B <mtime sec> <mtime nsec> <bundle path>    for each bundle in those directories, sorted
+//   X <bundle URI>                              for each bundle with specification data
+//   P <mixed binary> <plugin URI>               for each plugin, followed by
+//   D <bundle URI>                              each bundle with data of plugin or its UIs
+//   N <name>                                    its name
+//   C <class label>                             its class
+//   A <author name>                             its author
+//   J <project name>                            its project
+//   M <comment>                                 its comment, on a single line
+//   Y <library URI>                             its shared library
+//   F <feature URI>                             each required feature
+//   U <UI class URI> <UI URI>                   each UI
+//   I <direction><type> <symbol>                each port, [io][acve-]
+//   S <preset URI> <bundle URI>                 each preset and its bundle
+#define SYNTHPOD_INDEX_HEADER "spod-index 3\n"
+
+// lilv's stock default, used if LV2_PATH is unset, directories of builds with
+// other defaults are taken from the bundles found by lilv_world_load_all
+#if defined(__APPLE__)
+#	define SYNTHPOD_INDEX_LV2_PATH "~/Library/Audio/Plug-Ins/LV2:~/.lv2:/usr/local/lib/lv2:/usr/lib/lv2:/Library/Audio/Plug-Ins/LV2"
+#else
+#	define SYNTHPOD_INDEX_LV2_PATH "~/.lv2:/usr/local/lib/lv2:/usr/lib/lv2:/usr/local/lib64/lv2:/usr/lib64/lv2"
+#endif
+
+typedef struct _index_port_t index_port_t;
+typedef struct _index_ui_t index_ui_t;
+typedef struct _index_preset_t index_preset_t;
+typedef struct _index_plug_t index_plug_t;
+typedef struct _index_t index_t;
+typedef struct _index_lines_t index_lines_t;
+
+struct _index_port_t {
+	const char *symbol;
+	char type; // 'a'udio, 'c'ontrol, c'v', 'e'vent, '-' other
+	bool output;
+};
+
+struct _index_ui_t {
+	const char *type;
+	const char *uri;
+};
+
+struct _index_preset_t {
+	const char *uri;
+	const char *bundle;
+};
+
+// strings are NULL if not set
+struct _index_plug_t {
+	const char *uri;
+	bool mixed_binary; // DSP and UI code in same binary
+	const char *name;
+	const char *class_label;
+	const char *author;
+	const char *project;
+	const char *comment;
+	const char *library;
+	unsigned num_bundles;
+	const char **bundles; // bundles with data of plugin
+	unsigned num_features;
+	const char **features; // required features
+	unsigned num_uis;
+	const index_ui_t *uis;
+	unsigned num_ports;
+	const index_port_t *ports;
+	unsigned num_presets;
+	const index_preset_t *presets;
+};
+
+// on-disk plugin index, valid as long as no searched directory or bundle changes
+struct _index_t {
+	char *buf; // index file, strings point into it
+	unsigned num_plugs;
+	index_plug_t *plugs;
+	unsigned num_presets;
+	index_preset_t *presets;
+	const char **bundles;
+	const char **features;
+	index_ui_t *uis;
+	index_port_t *ports;
+	unsigned num_specs;
+	const char **specs; // bundles with specifications
+	bool lazy; // world has not been loaded in full, load bundles on demand
+	unsigned num_loaded;
+	const char **loaded; // bundles loaded on demand
+};
+
+struct _index_lines_t {
+	unsigned num;
+	unsigned max;
+	char **lines;
+};
+
+static inline void
+_synthpod_index_lines_add(index_lines_t *lines, char *line)
+{
+	if(lines->num == lines->max)
+	{
+		const unsigned max = lines->max ? lines->max << 1 : 256;
+		char **tmp = realloc(lines->lines, max * sizeof(char *));
+		if(!tmp)
+		{
+			free(line);
+			return;
+		}
+
+		lines->lines = tmp;
+		lines->max = max;
+	}
+
+	lines->lines[lines->num++] = line;
+}
+
+static inline bool
+_synthpod_index_lines_has(index_lines_t *lines, const char *line)
+{
+	for(unsigned i = 0; i < lines->num; i++)
+	{
+		if(!strcmp(lines->lines[i], line))
+			return true;
+	}
+
+	return false;
+}
+
+static inline int
+_synthpod_index_lines_cmp(const void *a, const void *b)
+{
+	const char *const *line_a = a;
+	const char *const *line_b = b;
+
+	return strcmp(*line_a, *line_b);
+}
+
+// sort and drop duplicates
+static inline void
+_synthpod_index_lines_sort(index_lines_t *lines)
+{
+	if(!lines->num)
+		return;
+
+	qsort(lines->lines, lines->num, sizeof(char *), _synthpod_index_lines_cmp);
+
+	unsigned num = 1;
+	for(unsigned i = 1; i < lines->num; i++)
+	{
+		if(strcmp(lines->lines[i], lines->lines[num - 1]))
+			lines->lines[num++] = lines->lines[i];
+		else
+			free(lines->lines[i]);
+	}
+
+	lines->num = num;
+}
+
+static inline void
+_synthpod_index_lines_free(index_lines_t *lines)
+{
+	for(unsigned i = 0; i < lines->num; i++)
+		free(lines->lines[i]);
+	free(lines->lines);
+
+	memset(lines, 0x0, sizeof(index_lines_t));
+}
+
+// directory path without trailing slashes
+static inline void
+_synthpod_index_dirs_add(index_lines_t *dirs, const char *path, size_t len)
+{
+	while( (len > 1) && (path[len - 1] == '/') )
+		len -= 1;
+
+	if(len == 0)
+		return;
+
+	char *dir = strndup(path, len);
+	if(dir)
+		_synthpod_index_lines_add(dirs, dir);
+}
+
+// directories in LV2_PATH or lilv's default
+static inline void
+_synthpod_index_dirs_configured(index_lines_t *dirs, const char *home)
+{
+	const char *lv2_path = getenv("LV2_PATH");
+	char *paths = strdup(lv2_path ? lv2_path : SYNTHPOD_INDEX_LV2_PATH);
+	if(!paths)
+		return;
+
+	char *rest = paths;
+	char *prefix;
+	while((prefix = strsep(&rest, ":")))
+	{
+		if(prefix[0] == '~')
+		{
+			char *dir_path = NULL;
+			if(!home || (asprintf(&dir_path, "%s%s", home, prefix + 1) == -1) )
+				continue;
+
+			_synthpod_index_dirs_add(dirs, dir_path, strlen(dir_path));
+			free(dir_path);
+		}
+		else
+		{
+			_synthpod_index_dirs_add(dirs, prefix, strlen(prefix));
+		}
+	}
+
+	free(paths);
+}
+
+// directories recorded in V lines of an existing index
+static inline void
+_synthpod_index_dirs_recorded(index_lines_t *dirs, const char *buf)
+{
+	if(strncmp(buf, SYNTHPOD_INDEX_HEADER, strlen(SYNTHPOD_INDEX_HEADER)))
+		return; // other version
+
+	for(const char *line = buf + strlen(SYNTHPOD_INDEX_HEADER); line[0] == 'V'; )
+	{
+		const char *end = strchr(line, '\n');
+		if(!end)
+			break;
+
+		// skip mtime fields
+		const char *path = line;
+		for(unsigned i = 0; (i < 3) && path; i++)
+			path = memchr(path + 1, ' ', end - path - 1);
+
+		if(path)
+			_synthpod_index_dirs_add(dirs, path + 1, end - path - 1);
+
+		line = end + 1;
+	}
+}
+
+// directory containing a bundle found by lilv
+static inline void
+_synthpod_index_dirs_parent(index_lines_t *dirs, const char *bundle_uri)
+{
+	char *bundle_path = lilv_file_uri_parse(bundle_uri, NULL);
+	if(!bundle_path)
+		return;
+
+	size_t len = strlen(bundle_path);
+	while( (len > 1) && (bundle_path[len - 1] == '/') )
+		len -= 1;
+	while( (len > 0) && (bundle_path[len - 1] != '/') )
+		len -= 1;
+
+	_synthpod_index_dirs_add(dirs, bundle_path, len);
+
+	lilv_free(bundle_path);
+}
+
+#if !defined(_WIN32)
+// latest modification of bundle directory or any of its files
+static inline bool
+_synthpod_index_bundle_mtime(const char *path, struct timespec *mtime)
+{
+	struct stat st;
+	if(stat(path, &st) || !S_ISDIR(st.st_mode))
+		return false;
+
+	*mtime = st.st_mtim;
+
+	DIR *dir = opendir(path);
+	if(!dir)
+		return false;
+
+	bool has_manifest = false;
+	struct dirent *entry;
+	while((entry = readdir(dir)))
+	{
+		if(entry->d_name[0] == '.')
+			continue;
+
+		char *file = NULL;
+		if(asprintf(&file, "%s/%s", path, entry->d_name) == -1)
+			continue;
+
+		if(!stat(file, &st))
+		{
+			if(  (st.st_mtim.tv_sec > mtime->tv_sec)
+				|| ( (st.st_mtim.tv_sec == mtime->tv_sec) && (st.st_mtim.tv_nsec > mtime->tv_nsec) ) )
+			{
+				*mtime = st.st_mtim;
+			}
+		}
+
+		if(!strcmp(entry->d_name, "manifest.ttl"))
+			has_manifest = true;
+
+		free(file);
+	}
+
+	closedir(dir);
+
+	return has_manifest;
+}
+#endif
+
+// one line per directory and per bundle therein, concatenated, a directory's
+// mtime changes whenever bundles are added to or removed from it
+static inline char *
+_synthpod_index_stamps(index_lines_t *dirs)
+{
+#if defined(_WIN32)
+	return strdup(SYNTHPOD_INDEX_HEADER); // not cached
+#else
+	index_lines_t stamps = { .num = 0 };
+	index_lines_t bundles = { .num = 0 };
+
+	_synthpod_index_lines_sort(dirs);
+
+	for(unsigned i = 0; i < dirs->num; i++)
+	{
+		const char *dir_path = dirs->lines[i];
+
+		struct stat st;
+		struct timespec mtime = { .tv_sec = 0, .tv_nsec = 0 }; // missing
+		if(!stat(dir_path, &st) && S_ISDIR(st.st_mode))
+			mtime = st.st_mtim;
+
+		char *line = NULL;
+		if(asprintf(&line, "V %"PRIi64" %li %s\n", (int64_t)mtime.tv_sec,
+			mtime.tv_nsec, dir_path) != -1)
+		{
+			_synthpod_index_lines_add(&stamps, line);
+		}
+
+		DIR *dir = opendir(dir_path);
+		if(!dir)
+			continue;
+
+		struct dirent *entry;
+		while((entry = readdir(dir)))
+		{
+			if(entry->d_name[0] == '.')
+				continue;
+
+			char *bundle_path = NULL;
+			if(asprintf(&bundle_path, "%s/%s", dir_path, entry->d_name) == -1)
+				continue;
+
+			line = NULL;
+			if(  _synthpod_index_bundle_mtime(bundle_path, &mtime)
+				&& (asprintf(&line, "B %"PRIi64" %li %s\n", (int64_t)mtime.tv_sec,
+					mtime.tv_nsec, bundle_path) != -1) )
+			{
+				_synthpod_index_lines_add(&bundles, line);
+			}
+
+			free(bundle_path);
+		}
+
+		closedir(dir);
+	}
+
+	_synthpod_index_lines_sort(&bundles);
+
+	size_t len = strlen(SYNTHPOD_INDEX_HEADER);
+	for(unsigned i = 0; i < stamps.num; i++)
+		len += strlen(stamps.lines[i]);
+	for(unsigned i = 0; i < bundles.num; i++)
+		len += strlen(bundles.lines[i]);
+
+	char *str = malloc(len + 1);
+	if(str)
+	{
+		char *ptr = stpcpy(str, SYNTHPOD_INDEX_HEADER);
+
+		for(unsigned i = 0; i < stamps.num; i++)
+			ptr = stpcpy(ptr, stamps.lines[i]);
+		for(unsigned i = 0; i < bundles.num; i++)
+			ptr = stpcpy(ptr, bundles.lines[i]);
+	}
+
+	_synthpod_index_lines_free(&stamps);
+	_synthpod_index_lines_free(&bundles);
+
+	return str;
+#endif
+}
+
+static inline char *
+_synthpod_index_path(const char *home)
+{
+	const char *cache_home = getenv("XDG_CACHE_HOME");
+	char *path = NULL;
+
+	if(cache_home)
+	{
+		if(asprintf(&path, "%s/synthpod/plugin.index", cache_home) == -1)
+			return NULL;
+	}
+	else if(home)
+	{
+		if(asprintf(&path, "%s/.cache/synthpod/plugin.index", home) == -1)
+			return NULL;
+	}
+
+	return path;
+}
+
+static inline char *
+_synthpod_index_read(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	if(!f)
+		return NULL;
+
+	fseek(f, 0, SEEK_END);
+	const long fsize = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	char *buf = fsize > 0 ? malloc(fsize + 1) : NULL;
+	if(buf)
+	{
+		if(fread(buf, fsize, 1, f) == 1)
+		{
+			buf[fsize] = '\0';
+		}
+		else
+		{
+			free(buf);
+			buf = NULL;
+		}
+	}
+
+	fclose(f);
+
+	return buf;
+}
+
+// URI of directory containing file, including trailing slash
+static inline char *
+_synthpod_index_bundle_of(const char *file_uri)
+{
+	const char *slash = strrchr(file_uri, '/');
+
+	return slash ? strndup(file_uri, slash - file_uri + 1) : NULL;
+}
+
+// whether DSP and UI code is mixed into same binary
+static inline bool
+synthpod_index_mixed_binary(LilvWorld *world, const LilvPlugin *plug)
+{
+	const LilvNode *library_uri= lilv_plugin_get_library_uri(plug);
+	if(!library_uri)
+		return false;
+
+	bool mixed_binary = false;
+	LilvUIs *all_uis = lilv_plugin_get_uis(plug);
+	if(all_uis)
+	{
+		LILV_FOREACH(uis, ptr, all_uis)
+		{
+			const LilvUI *ui = lilv_uis_get(all_uis, ptr);
+			if(!ui)
+				continue;
+
+			const LilvNode *ui_uri_node = lilv_ui_get_uri(ui);
+			if(!ui_uri_node)
+				continue;
+
+			// nedded if ui ttl referenced via rdfs#seeAlso
+			lilv_world_load_resource(world, ui_uri_node);
+
+			const LilvNode *ui_library_uri= lilv_ui_get_binary_uri(ui);
+			if(ui_library_uri && lilv_node_equals(library_uri, ui_library_uri))
+				mixed_binary = true; // this is bad, we don't support that
+
+			lilv_world_unload_resource(world, ui_uri_node);
+		}
+
+		lilv_uis_free(all_uis);
+	}
+
+	return mixed_binary;
+}
+
+// writes bundle of file unless seen already, records its directory
+static inline void
+_synthpod_index_write_bundle(FILE *f, char type, const char *file_uri,
+	index_lines_t *seen, index_lines_t *dirs)
+{
+	if(strncmp(file_uri, "file://", 7))
+		return; // not a local file
+
+	char *bundle = _synthpod_index_bundle_of(file_uri);
+	if(!bundle)
+		return;
+
+	if(_synthpod_index_lines_has(seen, bundle))
+	{
+		free(bundle);
+		return;
+	}
+
+	fprintf(f, "%c %s\n", type, bundle);
+	_synthpod_index_dirs_parent(dirs, bundle);
+	_synthpod_index_lines_add(seen, bundle);
+}
+
+// writes string on a single line
+static inline void
+_synthpod_index_write_text(FILE *f, char type, const LilvNode *node)
+{
+	if(!node)
+		return;
+
+	const char *str = lilv_node_as_string(node);
+	if(!str || !str[0])
+		return;
+
+	fprintf(f, "%c ", type);
+	for(const char *ptr = str; *ptr; ptr++)
+		fputc( (*ptr == '\n') || (*ptr == '\r') ? ' ' : *ptr, f);
+	fputc('\n', f);
+}
+
+static inline char
+_synthpod_index_port_type(const LilvPlugin *plug, const LilvPort *port,
+	LilvNode *const *classes)
+{
+	static const char types [] = "acve";
+
+	for(unsigned i = 0; i < sizeof(types) - 1; i++)
+	{
+		if(lilv_port_is_a(plug, port, classes[i]))
+			return types[i];
+	}
+
+	return '-';
+}
+
+// expects world to be loaded in full
+static inline void
+_synthpod_index_write_body(LilvWorld *world, FILE *f, index_lines_t *dirs)
+{
+	LilvNode *pset_preset = lilv_new_uri(world, LV2_PRESETS__Preset);
+	LilvNode *rdfs_see_also = lilv_new_uri(world, LILV_NS_RDFS"seeAlso");
+	LilvNode *rdfs_comment = lilv_new_uri(world, LILV_NS_RDFS"comment");
+	LilvNode *rdf_type = lilv_new_uri(world, LILV_NS_RDF"type");
+	LilvNode *doap_name = lilv_new_uri(world, LILV_NS_DOAP"name");
+	LilvNode *lv2_specification = lilv_new_uri(world, LV2_CORE__Specification);
+	LilvNode *lv2_output_port = lilv_new_uri(world, LV2_CORE__OutputPort);
+	LilvNode *port_classes [4] = {
+		lilv_new_uri(world, LV2_CORE__AudioPort),
+		lilv_new_uri(world, LV2_CORE__ControlPort),
+		lilv_new_uri(world, LV2_CORE__CVPort),
+		lilv_new_uri(world, LV2_ATOM__AtomPort)
+	};
+
+	// bundles with specifications, plugin classes and port properties live there
+	index_lines_t seen = { .num = 0 };
+	LilvNodes *specs = lilv_world_find_nodes(world, NULL, rdf_type, lv2_specification);
+	if(specs)
+	{
+		LILV_FOREACH(nodes, i, specs)
+		{
+			const LilvNode *spec = lilv_nodes_get(specs, i);
+
+			LilvNodes *files = lilv_world_find_nodes(world, spec, rdfs_see_also, NULL);
+			if(files)
+			{
+				LILV_FOREACH(nodes, j, files)
+				{
+					const LilvNode *file = lilv_nodes_get(files, j);
+
+					if(lilv_node_is_uri(file))
+						_synthpod_index_write_bundle(f, 'X', lilv_node_as_uri(file), &seen, dirs);
+				}
+
+				lilv_nodes_free(files);
+			}
+		}
+
+		lilv_nodes_free(specs);
+	}
+	_synthpod_index_lines_free(&seen);
+
+	const LilvPlugins *plugs = lilv_world_get_all_plugins(world);
+	LILV_FOREACH(plugins, itr, plugs)
+	{
+		const LilvPlugin *plug = lilv_plugins_get(plugs, itr);
+
+		fprintf(f, "P %d %s\n", synthpod_index_mixed_binary(world, plug) ? 1 : 0,
+			lilv_node_as_uri(lilv_plugin_get_uri(plug)));
+
+		_synthpod_index_write_bundle(f, 'D', lilv_node_as_uri(lilv_plugin_get_bundle_uri(plug)),
+			&seen, dirs);
+
+		const LilvNodes *data_uris = lilv_plugin_get_data_uris(plug);
+		LILV_FOREACH(nodes, i, data_uris)
+		{
+			_synthpod_index_write_bundle(f, 'D', lilv_node_as_uri(lilv_nodes_get(data_uris, i)),
+				&seen, dirs);
+		}
+
+		LilvUIs *all_uis = lilv_plugin_get_uis(plug);
+		if(all_uis)
+		{
+			LILV_FOREACH(uis, i, all_uis)
+			{
+				const LilvUI *ui = lilv_uis_get(all_uis, i);
+				const LilvNode *ui_bundle = lilv_ui_get_bundle_uri(ui);
+
+				if(ui_bundle)
+					_synthpod_index_write_bundle(f, 'D', lilv_node_as_uri(ui_bundle), &seen, dirs);
+			}
+		}
+
+		_synthpod_index_lines_free(&seen);
+
+		LilvNode *name = lilv_plugin_get_name(plug);
+		_synthpod_index_write_text(f, 'N', name);
+		if(name)
+			lilv_node_free(name);
+
+		const LilvPluginClass *class = lilv_plugin_get_class(plug);
+		if(class)
+			_synthpod_index_write_text(f, 'C', lilv_plugin_class_get_label(class));
+
+		LilvNode *author = lilv_plugin_get_author_name(plug);
+		_synthpod_index_write_text(f, 'A', author);
+		if(author)
+			lilv_node_free(author);
+
+		LilvNode *project = lilv_plugin_get_project(plug);
+		if(project)
+		{
+			LilvNode *project_name = lilv_world_get(world, project, doap_name, NULL);
+			_synthpod_index_write_text(f, 'J', project_name);
+			if(project_name)
+				lilv_node_free(project_name);
+
+			lilv_node_free(project);
+		}
+
+		LilvNodes *comments = lilv_plugin_get_value(plug, rdfs_comment);
+		if(comments)
+		{
+			if(lilv_nodes_size(comments))
+				_synthpod_index_write_text(f, 'M', lilv_nodes_get_first(comments));
+
+			lilv_nodes_free(comments);
+		}
+
+		const LilvNode *library = lilv_plugin_get_library_uri(plug);
+		if(library)
+			fprintf(f, "Y %s\n", lilv_node_as_uri(library));
+
+		LilvNodes *features = lilv_plugin_get_required_features(plug);
+		if(features)
+		{
+			LILV_FOREACH(nodes, i, features)
+				fprintf(f, "F %s\n", lilv_node_as_uri(lilv_nodes_get(features, i)));
+
+			lilv_nodes_free(features);
+		}
+
+		if(all_uis)
+		{
+			LILV_FOREACH(uis, i, all_uis)
+			{
+				const LilvUI *ui = lilv_uis_get(all_uis, i);
+				const LilvNodes *ui_classes = lilv_ui_get_classes(ui);
+				const LilvNode *ui_class = ui_classes && lilv_nodes_size(ui_classes)
+					? lilv_nodes_get_first(ui_classes)
+					: NULL;
+
+				if(ui_class)
+				{
+					fprintf(f, "U %s %s\n", lilv_node_as_uri(ui_class),
+						lilv_node_as_uri(lilv_ui_get_uri(ui)));
+				}
+			}
+
+			lilv_uis_free(all_uis);
+		}
+
+		const uint32_t num_ports = lilv_plugin_get_num_ports(plug);
+		for(uint32_t i = 0; i < num_ports; i++)
+		{
+			const LilvPort *port = lilv_plugin_get_port_by_index(plug, i);
+
+			fprintf(f, "I %c%c %s\n",
+				lilv_port_is_a(plug, port, lv2_output_port) ? 'o' : 'i',
+				_synthpod_index_port_type(plug, port, port_classes),
+				lilv_node_as_string(lilv_port_get_symbol(plug, port)));
+		}
+
+		LilvNodes *presets = lilv_plugin_get_related(plug, pset_preset);
+		if(presets)
+		{
+			LILV_FOREACH(nodes, i, presets)
+			{
+				const LilvNode *preset = lilv_nodes_get(presets, i);
+
+				LilvNodes *files = lilv_world_find_nodes(world, preset, rdfs_see_also, NULL);
+				if(files)
+				{
+					const LilvNode *file = lilv_nodes_size(files) ? lilv_nodes_get_first(files) : NULL;
+					char *bundle = file && lilv_node_is_uri(file)
+						? _synthpod_index_bundle_of(lilv_node_as_uri(file))
+						: NULL;
+
+					if(bundle)
+					{
+						fprintf(f, "S %s %s\n", lilv_node_as_uri(preset), bundle);
+						_synthpod_index_dirs_parent(dirs, bundle);
+						free(bundle);
+					}
+
+					lilv_nodes_free(files);
+				}
+			}
+
+			lilv_nodes_free(presets);
+		}
+	}
+
+	lilv_node_free(pset_preset);
+	lilv_node_free(rdfs_see_also);
+	lilv_node_free(rdfs_comment);
+	lilv_node_free(rdf_type);
+	lilv_node_free(doap_name);
+	lilv_node_free(lv2_specification);
+	lilv_node_free(lv2_output_port);
+	for(unsigned i = 0; i < 4; i++)
+		lilv_node_free(port_classes[i]);
+}
+
+// stamps of all directories with bundles followed by the body
+static inline char *
+_synthpod_index_build(LilvWorld *world, index_lines_t *dirs, size_t *offset)
+{
+	FILE *body = tmpfile();
+	if(!body)
+		return NULL;
+
+	_synthpod_index_write_body(world, body, dirs);
+
+	const long body_size = ftell(body);
+	char *stamps = _synthpod_index_stamps(dirs);
+	char *buf = NULL;
+
+	if(stamps && (body_size >= 0) && !ferror(body) )
+	{
+		*offset = strlen(stamps);
+
+		buf = malloc(*offset + body_size + 1);
+		if(buf)
+		{
+			memcpy(buf, stamps, *offset);
+			rewind(body);
+
+			if(fread(buf + *offset, 1, body_size, body) == (size_t)body_size)
+			{
+				buf[*offset + body_size] = '\0';
+			}
+			else
+			{
+				free(buf);
+				buf = NULL;
+			}
+		}
+	}
+
+	free(stamps);
+	fclose(body);
+
+	return buf;
+}
+
+// replaces index file atomically, engine and UI may race to write it
+static inline int
+_synthpod_index_write(const char *path, const char *buf)
+{
+#if defined(_WIN32)
+	return -1; // not cached
+#else
+	char *dir = _synthpod_index_bundle_of(path);
+	if(dir)
+	{
+		mkpath(dir);
+		free(dir);
+	}
+
+	char *tmp_path = NULL;
+	if(asprintf(&tmp_path, "%s.XXXXXX", path) == -1)
+		return -1;
+
+	const int fd = mkstemp(tmp_path);
+	FILE *f = fd != -1 ? fdopen(fd, "wb") : NULL;
+	if(!f)
+	{
+		if(fd != -1)
+		{
+			close(fd);
+			unlink(tmp_path);
+		}
+		free(tmp_path);
+		return -1;
+	}
+
+	fputs(buf, f);
+
+	const bool failed = ferror(f) | (fclose(f) != 0);
+
+	if(failed || rename(tmp_path, path))
+	{
+		unlink(tmp_path);
+		free(tmp_path);
+		return -1;
+	}
+
+	free(tmp_path);
+
+	return 0;
+#endif
+}
+
+// splits index into records, strings are terminated in place
+static inline int
+_synthpod_index_parse(index_t *index, char *buf, size_t offset)
+{
+	unsigned num_plugs = 0;
+	unsigned num_presets = 0;
+	unsigned num_bundles = 0;
+	unsigned num_features = 0;
+	unsigned num_uis = 0;
+	unsigned num_ports = 0;
+	unsigned num_specs = 0;
+
+	for(const char *line = buf + offset; *line; )
+	{
+		switch(line[0])
+		{
+			case 'P':
+				num_plugs += 1;
+				break;
+			case 'S':
+				num_presets += 1;
+				break;
+			case 'D':
+				num_bundles += 1;
+				break;
+			case 'F':
+				num_features += 1;
+				break;
+			case 'U':
+				num_uis += 1;
+				break;
+			case 'I':
+				num_ports += 1;
+				break;
+			case 'X':
+				num_specs += 1;
+				break;
+		}
+
+		const char *end = strchr(line, '\n');
+		if(!end)
+			break;
+		line = end + 1;
+	}
+
+	index->plugs = calloc(num_plugs + 1, sizeof(index_plug_t));
+	index->presets = calloc(num_presets + 1, sizeof(index_preset_t));
+	index->bundles = calloc(num_bundles + 1, sizeof(const char *));
+	index->features = calloc(num_features + 1, sizeof(const char *));
+	index->uis = calloc(num_uis + 1, sizeof(index_ui_t));
+	index->ports = calloc(num_ports + 1, sizeof(index_port_t));
+	index->specs = calloc(num_specs + 1, sizeof(const char *));
+	if(  !index->plugs || !index->presets || !index->bundles || !index->features
+		|| !index->uis || !index->ports || !index->specs)
+	{
+		return -1;
+	}
+
+	index_plug_t *plug = NULL;
+	num_bundles = 0;
+	num_features = 0;
+	num_uis = 0;
+	num_ports = 0;
+	for(char *line = buf + offset; *line; )
+	{
+		char *end = strchr(line, '\n');
+		if(!end)
+			break;
+		*end = '\0';
+
+		const char type = line[0];
+		char *val = (type && (line[1] == ' ')) ? &line[2] : NULL;
+
+		if(!val)
+		{
+			// malformed
+		}
+		else if(type == 'P')
+		{
+			if(val[0] && (val[1] == ' ') )
+			{
+				plug = &index->plugs[index->num_plugs++];
+				plug->mixed_binary = val[0] == '1';
+				plug->uri = &val[2];
+				plug->bundles = &index->bundles[num_bundles];
+				plug->features = &index->features[num_features];
+				plug->uis = &index->uis[num_uis];
+				plug->ports = &index->ports[num_ports];
+				plug->presets = &index->presets[index->num_presets];
+			}
+			else
+			{
+				plug = NULL;
+			}
+		}
+		else if(type == 'S')
+		{
+			char *sep = strchr(val, ' ');
+			if(sep)
+			{
+				index_preset_t *preset = &index->presets[index->num_presets++];
+
+				*sep = '\0';
+				preset->uri = val;
+				preset->bundle = sep + 1;
+
+				if(plug)
+					plug->num_presets += 1;
+			}
+		}
+		else if(type == 'X')
+		{
+			index->specs[index->num_specs++] = val;
+		}
+		else if(!plug)
+		{
+			// stamps or orphaned plugin data
+		}
+		else if(type == 'D')
+		{
+			index->bundles[num_bundles++] = val;
+			plug->num_bundles += 1;
+		}
+		else if(type == 'F')
+		{
+			index->features[num_features++] = val;
+			plug->num_features += 1;
+		}
+		else if(type == 'U')
+		{
+			char *sep = strchr(val, ' ');
+			if(sep)
+			{
+				index_ui_t *ui = &index->uis[num_uis++];
+
+				*sep = '\0';
+				ui->type = val;
+				ui->uri = sep + 1;
+				plug->num_uis += 1;
+			}
+		}
+		else if(type == 'I')
+		{
+			if(val[0] && val[1] && (val[2] == ' ') )
+			{
+				index_port_t *port = &index->ports[num_ports++];
+
+				port->output = val[0] == 'o';
+				port->type = val[1];
+				port->symbol = &val[3];
+				plug->num_ports += 1;
+			}
+		}
+		else if(type == 'N')
+		{
+			plug->name = val;
+		}
+		else if(type == 'C')
+		{
+			plug->class_label = val;
+		}
+		else if(type == 'A')
+		{
+			plug->author = val;
+		}
+		else if(type == 'J')
+		{
+			plug->project = val;
+		}
+		else if(type == 'M')
+		{
+			plug->comment = val;
+		}
+		else if(type == 'Y')
+		{
+			plug->library = val;
+		}
+
+		line = end + 1;
+	}
+
+	return 0;
+}
+
+static inline void
+_synthpod_index_bundle_load(index_t *index, LilvWorld *world, const char *bundle)
+{
+	for(unsigned i = 0; i < index->num_loaded; i++)
+	{
+		if(!strcmp(index->loaded[i], bundle))
+			return; // already loaded
+	}
+
+	const char **loaded = realloc(index->loaded, (index->num_loaded + 1) * sizeof(const char *));
+	if(!loaded)
+		return;
+
+	index->loaded = loaded;
+	index->loaded[index->num_loaded++] = bundle;
+
+	LilvNode *bundle_node = lilv_new_uri(world, bundle);
+	if(bundle_node)
+	{
+		lilv_world_load_bundle(world, bundle_node);
+		lilv_node_free(bundle_node);
+	}
+}
+
+// specifications and plugin classes, as lilv_world_load_all would load them
+static inline void
+_synthpod_index_specs_load(index_t *index, LilvWorld *world)
+{
+	for(unsigned i = 0; i < index->num_specs; i++)
+		_synthpod_index_bundle_load(index, world, index->specs[i]);
+
+	lilv_world_load_specifications(world);
+	lilv_world_load_plugin_classes(world);
+}
+
+static inline void
+synthpod_index_deinit(index_t *index)
+{
+	free(index->plugs);
+	free(index->presets);
+	free(index->bundles);
+	free(index->features);
+	free(index->uis);
+	free(index->ports);
+	free(index->specs);
+	free(index->loaded);
+	free(index->buf);
+
+	memset(index, 0x0, sizeof(index_t));
+}
+
+// discovers all bundles and rebuilds index from the loaded world,
+// returns -1 without index, 1 if index could not be written to disk
+static inline int
+synthpod_index_rebuild(index_t *index, LilvWorld *world, const char *home)
+{
+	synthpod_index_deinit(index);
+	lilv_world_load_all(world);
+
+	index_lines_t dirs = { .num = 0 };
+	size_t offset = 0;
+
+	_synthpod_index_dirs_configured(&dirs, home);
+	char *buf = _synthpod_index_build(world, &dirs, &offset);
+	_synthpod_index_lines_free(&dirs);
+
+	if(!buf)
+		return -1;
+
+	char *path = _synthpod_index_path(home);
+	const int ret = path && !_synthpod_index_write(path, buf) ? 0 : 1;
+	free(path);
+
+	index->buf = buf;
+
+	if(_synthpod_index_parse(index, buf, offset))
+	{
+		synthpod_index_deinit(index);
+		return -1;
+	}
+
+	return ret;
+}
+
+// loads world lazily if index is up to date, rebuilds it otherwise
+static inline int
+synthpod_index_init(index_t *index, LilvWorld *world, const char *home)
+{
+#if defined(_WIN32)
+	char *buf = NULL; // not cached
+#else
+	char *path = _synthpod_index_path(home);
+	char *buf = path ? _synthpod_index_read(path) : NULL;
+
+	free(path);
+#endif
+
+	if(buf)
+	{
+		// directories searched last time plus configured ones
+		index_lines_t dirs = { .num = 0 };
+
+		_synthpod_index_dirs_configured(&dirs, home);
+		_synthpod_index_dirs_recorded(&dirs, buf);
+		char *stamps = _synthpod_index_stamps(&dirs);
+		_synthpod_index_lines_free(&dirs);
+
+		const size_t len = stamps ? strlen(stamps) : 0;
+
+		if(  stamps
+			&& !strncmp(buf, stamps, len)
+			&& (buf[len] != 'V')
+			&& (buf[len] != 'B') )
+		{
+			free(stamps);
+
+			index->buf = buf;
+			index->lazy = true;
+
+			if(_synthpod_index_parse(index, buf, len) == 0)
+			{
+				_synthpod_index_specs_load(index, world);
+				return 0;
+			}
+
+			synthpod_index_deinit(index);
+		}
+		else
+		{
+			free(stamps);
+			free(buf);
+		}
+	}
+
+	// index is missing or stale
+	return synthpod_index_rebuild(index, world, home);
+}
+
+static inline const index_plug_t *
+synthpod_index_plug_get(index_t *index, const char *uri)
+{
+	for(unsigned i = 0; i < index->num_plugs; i++)
+	{
+		const index_plug_t *plug = &index->plugs[i];
+
+		if(!strcmp(plug->uri, uri))
+			return plug;
+	}
+
+	return NULL;
+}
+
+// loads bundles with data of plugin and its UIs
+static inline void
+synthpod_index_plug_load(index_t *index, LilvWorld *world, const index_plug_t *plug)
+{
+	if(!index->lazy)
+		return;
+
+	for(unsigned i = 0; i < plug->num_bundles; i++)
+		_synthpod_index_bundle_load(index, world, plug->bundles[i]);
+}
+
+// loads bundles with presets of plugin
+static inline void
+synthpod_index_plug_presets_load(index_t *index, LilvWorld *world, const index_plug_t *plug)
+{
+	if(!index->lazy)
+		return;
+
+	for(unsigned i = 0; i < plug->num_presets; i++)
+		_synthpod_index_bundle_load(index, world, plug->presets[i].bundle);
+}
+
+// returns false if preset is not in index
+static inline bool
+synthpod_index_preset_load(index_t *index, LilvWorld *world, const char *uri)
+{
+	if(!index->lazy)
+		return true;
+
+	for(unsigned i = 0; i < index->num_presets; i++)
+	{
+		const index_preset_t *preset = &index->presets[i];
+
+		if(!strcmp(preset->uri, uri))
+		{
+			_synthpod_index_bundle_load(index, world, preset->bundle);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#endif // _SYNTHPOD_INDEX_H
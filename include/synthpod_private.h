@@ -338,6 +338,7 @@ struct _reg_t {
 		reg_item_t state;
 		reg_item_t load_default_state;
 		reg_item_t thread_safe_restore;
+		reg_item_t state_changed;
 	} state;
 
 	struct {
@@ -376,6 +377,9 @@ struct _reg_t {
 		reg_item_t dsp_profiling;
 		reg_item_t cpus_available;
 		reg_item_t cpus_used;
+		reg_item_t buffer_saved;
+		reg_item_t module_percentiles;
+		reg_item_t dsp_percentiles;
 		reg_item_t period_size;
 		reg_item_t num_periods;
 		reg_item_t quit;
@@ -637,6 +641,10 @@ sp_regs_init(reg_t *regs, LilvWorld *world, LV2_URID_Map *map)
 #	define LV2_STATE__threadSafeRestore LV2_STATE_PREFIX "threadSafeRestore"
 #endif
 	_register(&regs->state.thread_safe_restore, world, map, LV2_STATE__threadSafeRestore);
+#ifndef LV2_STATE__StateChanged
+#	define LV2_STATE__StateChanged LV2_STATE_PREFIX "StateChanged"
+#endif
+	_register(&regs->state.state_changed, world, map, LV2_STATE__StateChanged);
 
 	_register(&regs->synthpod.payload, world, map, SYNTHPOD_PREFIX"payload");
 	_register_string(&regs->synthpod.state, world, map, "state.ttl");
@@ -672,6 +680,9 @@ sp_regs_init(reg_t *regs, LilvWorld *world, LV2_URID_Map *map)
 	_register(&regs->synthpod.dsp_profiling, world, map, SYNTHPOD_PREFIX"DSPProfiling");
 	_register(&regs->synthpod.cpus_available, world, map, SYNTHPOD_PREFIX"CPUsAvailable");
 	_register(&regs->synthpod.cpus_used, world, map, SYNTHPOD_PREFIX"CPUsUsed");
+	_register(&regs->synthpod.buffer_saved, world, map, SYNTHPOD_PREFIX"bufferBytesSaved");
+	_register(&regs->synthpod.module_percentiles, world, map, SYNTHPOD_PREFIX"moduleProfilingPercentiles");
+	_register(&regs->synthpod.dsp_percentiles, world, map, SYNTHPOD_PREFIX"DSPProfilingPercentiles");
 	_register(&regs->synthpod.period_size, world, map, SYNTHPOD_PREFIX"periodSize");
 	_register(&regs->synthpod.num_periods, world, map, SYNTHPOD_PREFIX"numPeriods");
 	_register(&regs->synthpod.quit, world, map, SYNTHPOD_PREFIX"quit");
@@ -898,6 +909,7 @@ sp_regs_deinit(reg_t *regs)
 	_unregister(&regs->state.state);
 	_unregister(&regs->state.load_default_state);
 	_unregister(&regs->state.thread_safe_restore);
+	_unregister(&regs->state.state_changed);
 
 	_unregister(&regs->synthpod.payload);
 	_unregister(&regs->synthpod.state);
@@ -933,6 +945,9 @@ sp_regs_deinit(reg_t *regs)
 	_unregister(&regs->synthpod.dsp_profiling);
 	_unregister(&regs->synthpod.cpus_available);
 	_unregister(&regs->synthpod.cpus_used);
+	_unregister(&regs->synthpod.buffer_saved);
+	_unregister(&regs->synthpod.module_percentiles);
+	_unregister(&regs->synthpod.dsp_percentiles);
 	_unregister(&regs->synthpod.period_size);
 	_unregister(&regs->synthpod.num_periods);
 	_unregister(&regs->synthpod.quit);
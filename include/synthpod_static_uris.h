@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2015-2016 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#ifndef _SYNTHPOD_STATIC_URIS_H
+#define _SYNTHPOD_STATIC_URIS_H
+
+#include <synthpod_common.h>
+#include <synthpod_private.h>
+#include <xpress.lv2/xpress.h>
+
+// well-known URIs backing the static URID range of the mapper, array index is
+// the URID, i.e. URIDs of these are fixed across runs as long as this is
+// only ever appended to
+static const char *synthpod_static_uris [] = {
+	NULL, // invalid URID
+
+	// lv2 atom
+	LV2_ATOM__Atom,
+	LV2_ATOM__AtomPort,
+	LV2_ATOM__Blank,
+	LV2_ATOM__Bool,
+	LV2_ATOM__Chunk,
+	LV2_ATOM__Double,
+	LV2_ATOM__Event,
+	LV2_ATOM__Float,
+	LV2_ATOM__Int,
+	LV2_ATOM__Literal,
+	LV2_ATOM__Long,
+	LV2_ATOM__Number,
+	LV2_ATOM__Object,
+	LV2_ATOM__Path,
+	LV2_ATOM__Property,
+	LV2_ATOM__Resource,
+	LV2_ATOM__Sequence,
+	LV2_ATOM__Sound,
+	LV2_ATOM__String,
+	LV2_ATOM__Tuple,
+	LV2_ATOM__URI,
+	LV2_ATOM__URID,
+	LV2_ATOM__Vector,
+	LV2_ATOM__atomTransfer,
+	LV2_ATOM__beatTime,
+	LV2_ATOM__bufferType,
+	LV2_ATOM__childType,
+	LV2_ATOM__eventTransfer,
+	LV2_ATOM__frameTime,
+	LV2_ATOM__supports,
+	LV2_ATOM__timeUnit,
+
+	// lv2 core
+	LV2_CORE__AudioPort,
+	LV2_CORE__CVPort,
+	LV2_CORE__ControlPort,
+	LV2_CORE__InputPort,
+	LV2_CORE__OutputPort,
+	LV2_CORE__Plugin,
+	LV2_CORE__Port,
+	LV2_CORE__appliesTo,
+	LV2_CORE__control,
+	LV2_CORE__default,
+	LV2_CORE__designation,
+	LV2_CORE__enumeration,
+	LV2_CORE__extensionData,
+	LV2_CORE__inPlaceBroken,
+	LV2_CORE__index,
+	LV2_CORE__integer,
+	LV2_CORE__maximum,
+	LV2_CORE__microVersion,
+	LV2_CORE__minimum,
+	LV2_CORE__minorVersion,
+	LV2_CORE__name,
+	LV2_CORE__optionalFeature,
+	LV2_CORE__port,
+	LV2_CORE__requiredFeature,
+	LV2_CORE__scalePoint,
+	LV2_CORE__symbol,
+	LV2_CORE__toggled,
+
+	// lv2 patch
+	LV2_PATCH__Ack,
+	LV2_PATCH__Copy,
+	LV2_PATCH__Error,
+	LV2_PATCH__Get,
+	LV2_PATCH__Message,
+	LV2_PATCH__Move,
+	LV2_PATCH__Patch,
+	LV2_PATCH__Put,
+	LV2_PATCH__Request,
+	LV2_PATCH__Response,
+	LV2_PATCH__Set,
+	LV2_PATCH__add,
+	LV2_PATCH__body,
+	LV2_PATCH__destination,
+	LV2_PATCH__property,
+	LV2_PATCH__readable,
+	LV2_PATCH__remove,
+	LV2_PATCH__request,
+	LV2_PATCH__sequenceNumber,
+	LV2_PATCH__subject,
+	LV2_PATCH__value,
+	LV2_PATCH__wildcard,
+	LV2_PATCH__writable,
+
+	// lv2 midi
+	LV2_MIDI__MidiEvent,
+	LV2_MIDI__Controller,
+	LV2_MIDI__NoteOn,
+	LV2_MIDI__NoteOff,
+	LV2_MIDI__Aftertouch,
+	LV2_MIDI__ChannelPressure,
+	LV2_MIDI__Bender,
+	LV2_MIDI__ProgramChange,
+	LV2_MIDI__SystemExclusive,
+	LV2_MIDI__channel,
+	LV2_MIDI__controllerNumber,
+	LV2_MIDI__noteNumber,
+	LV2_MIDI__velocity,
+
+	// lv2 time
+	LV2_TIME__Position,
+	LV2_TIME__Rate,
+	LV2_TIME__Time,
+	LV2_TIME__bar,
+	LV2_TIME__barBeat,
+	LV2_TIME__beat,
+	LV2_TIME__beatUnit,
+	LV2_TIME__beatsPerBar,
+	LV2_TIME__beatsPerMinute,
+	LV2_TIME__frame,
+	LV2_TIME__framesPerSecond,
+	LV2_TIME__speed,
+
+	// osc
+	LV2_OSC__Event,
+	LV2_OSC__schedule,
+	LV2_OSC__Packet,
+	LV2_OSC__Bundle,
+	LV2_OSC__bundleTimetag,
+	LV2_OSC__bundleItems,
+	LV2_OSC__Message,
+	LV2_OSC__messagePath,
+	LV2_OSC__messageArguments,
+	LV2_OSC__Timetag,
+	LV2_OSC__timetagIntegral,
+	LV2_OSC__timetagFraction,
+	LV2_OSC__Nil,
+	LV2_OSC__Impulse,
+	LV2_OSC__Char,
+	LV2_OSC__RGBA,
+
+	// canvas
+	CANVAS__graph,
+	CANVAS__body,
+	CANVAS__aspectRatio,
+	CANVAS__BeginPath,
+	CANVAS__ClosePath,
+	CANVAS__Arc,
+	CANVAS__CurveTo,
+	CANVAS__LineTo,
+	CANVAS__MoveTo,
+	CANVAS__Rectangle,
+	CANVAS__PolyLine,
+	CANVAS__Style,
+	CANVAS__LineWidth,
+	CANVAS__LineDash,
+	CANVAS__LineCap,
+	CANVAS__LineJoin,
+	CANVAS__MiterLimit,
+	CANVAS__Stroke,
+	CANVAS__Fill,
+	CANVAS__Clip,
+	CANVAS__Save,
+	CANVAS__Restore,
+	CANVAS__Translate,
+	CANVAS__Scale,
+	CANVAS__Rotate,
+	CANVAS__Transform,
+	CANVAS__Reset,
+	CANVAS__FontSize,
+	CANVAS__FillText,
+	CANVAS__lineCapButt,
+	CANVAS__lineCapRound,
+	CANVAS__lineCapSquare,
+	CANVAS__lineJoinMiter,
+	CANVAS__lineJoinRound,
+	CANVAS__lineJoinBevel,
+	CANVAS__mouseButtonLeft,
+	CANVAS__mouseButtonMiddle,
+	CANVAS__mouseButtonRight,
+	CANVAS__mouseWheelX,
+	CANVAS__mouseWheelY,
+	CANVAS__mousePositionX,
+	CANVAS__mousePositionY,
+	CANVAS__mouseFocus,
+
+	// xpress
+	XPRESS__voiceMap,
+	XPRESS__Token,
+	XPRESS__Alive,
+	XPRESS__source,
+	XPRESS__uuid,
+	XPRESS__zone,
+	XPRESS__body,
+	XPRESS__pitch,
+	XPRESS__pressure,
+	XPRESS__timbre,
+	XPRESS__dPitch,
+	XPRESS__dPressure,
+	XPRESS__dTimbre,
+
+	// synthpod registry
+	LV2_CORE_PREFIX"isBitmask",
+	LV2_UI_PREFIX"floatProtocol",
+	LV2_UI_PREFIX"peakProtocol",
+	LV2_UI__portNotification,
+	LV2_RESIZE_PORT__minimumSize,
+	LV2_PORT_PROPS__logarithmic,
+	LV2_CORE_PREFIX"parameterProperty",
+	LV2_WORKER__schedule,
+	LV2_LOG__Entry,
+	LV2_LOG__Error,
+	LV2_LOG__Note,
+	LV2_LOG__Trace,
+	LV2_LOG__Warning,
+	LV2_UI__windowTitle,
+	LV2_UI__showInterface,
+	LV2_UI__idleInterface,
+	LV2_EXTERNAL_UI__Widget,
+	LV2_EXTERNAL_UI_DEPRECATED_URI,
+	LV2_UI__X11UI,
+	LV2_UI__GtkUI,
+	LV2_UI__Gtk3UI,
+	LV2_UI__Qt4UI,
+	LV2_UI_PREFIX"Qt5UI",
+	LV2_UI__plugin,
+	LV2_UI_PREFIX"protocol",
+	LV2_UI_PREFIX"periodStart",
+	LV2_UI_PREFIX"periodSize",
+	LV2_UI_PREFIX"peak",
+	LV2_UI__portSubscribe,
+	LV2_UI__portIndex,
+	LV2_UI__updateRate,
+	LV2_INSTANCE_ACCESS_URI,
+	LV2_DATA_ACCESS_URI,
+	LV2_UI__ui,
+	LV2_PRESETS__Preset,
+	LV2_PRESETS__bank,
+	LV2_PRESETS__Bank,
+	LILV_NS_RDF"value",
+	LILV_NS_RDF"type",
+	LILV_NS_RDF"subject",
+	LILV_NS_RDFS"label",
+	LILV_NS_RDFS"range",
+	LILV_NS_RDFS"comment",
+	LILV_NS_RDFS"seeAlso",
+	LILV_NS_DOAP"license",
+	LILV_NS_DOAP"name",
+	LV2_PARAMETERS__sampleRate,
+	LV2_PARAMETERS__gain,
+	LV2_BUF_SIZE_PREFIX "nominalBlockLength",
+	LV2_BUF_SIZE__maxBlockLength,
+	LV2_BUF_SIZE__minBlockLength,
+	LV2_BUF_SIZE__sequenceSize,
+	LV2_PATCH_PREFIX "Insert",
+	LV2_PATCH_PREFIX "Delete",
+	"http://open-music-kontrollers.ch/lv2/xpress#Message",
+	LV2_PORT_GROUPS__group,
+	LV2_PORT_GROUPS__left,
+	LV2_PORT_GROUPS__right,
+	LV2_PORT_GROUPS__center,
+	LV2_PORT_GROUPS__side,
+	LV2_PORT_GROUPS__centerLeft,
+	LV2_PORT_GROUPS__centerRight,
+	LV2_PORT_GROUPS__sideLeft,
+	LV2_PORT_GROUPS__sideRight,
+	LV2_PORT_GROUPS__rearLeft,
+	LV2_PORT_GROUPS__rearRight,
+	LV2_PORT_GROUPS__rearCenter,
+	LV2_PORT_GROUPS__lowFrequencyEffects,
+	LV2_UNITS__conversion,
+	LV2_UNITS__prefixConversion,
+	LV2_UNITS__render,
+	LV2_UNITS__symbol,
+	LV2_UNITS__unit,
+	LV2_UNITS__Unit,
+	LV2_UNITS__bar,
+	LV2_UNITS__beat,
+	LV2_UNITS__bpm,
+	LV2_UNITS__cent,
+	LV2_UNITS__cm,
+	LV2_UNITS__coef,
+	LV2_UNITS__db,
+	LV2_UNITS__degree,
+	LV2_UNITS__frame,
+	LV2_UNITS__hz,
+	LV2_UNITS__inch,
+	LV2_UNITS__khz,
+	LV2_UNITS__km,
+	LV2_UNITS__m,
+	LV2_UNITS__mhz,
+	LV2_UNITS__midiNote,
+	LV2_UNITS_PREFIX"midiController",
+	LV2_UNITS__mile,
+	LV2_UNITS__min,
+	LV2_UNITS__mm,
+	LV2_UNITS__ms,
+	LV2_UNITS__oct,
+	LV2_UNITS__pc,
+	LV2_UNITS__s,
+	LV2_UNITS__semitone12TET,
+	LV2_STATE__state,
+	LV2_STATE__loadDefaultState,
+	LV2_STATE__threadSafeRestore,
+	SYNTHPOD_PREFIX"payload",
+	SYNTHPOD_PREFIX"graph",
+	SYNTHPOD_PREFIX"stereo",
+	SYNTHPOD_PREFIX"monoatom",
+	SYNTHPOD_PREFIX"moduleList",
+	SYNTHPOD_PREFIX"moduleSupported",
+	SYNTHPOD_PREFIX"moduleAdd",
+	SYNTHPOD_PREFIX"moduleDel",
+	SYNTHPOD_PREFIX"moduleMove",
+	SYNTHPOD_PREFIX"modulePresetLoad",
+	SYNTHPOD_PREFIX"modulePresetSave",
+	SYNTHPOD_PREFIX"moduleVisible",
+	SYNTHPOD_PREFIX"moduleDisabled",
+	SYNTHPOD_PREFIX"moduleProfiling",
+	SYNTHPOD_PREFIX"modulePositionX",
+	SYNTHPOD_PREFIX"modulePositionY",
+	SYNTHPOD_PREFIX"moduleAlias",
+	SYNTHPOD_PREFIX"moduleReinstantiate",
+	SYNTHPOD_PREFIX"moduleCreated",
+	SYNTHPOD_PREFIX"nodePositionX",
+	SYNTHPOD_PREFIX"nodePositionY",
+	SYNTHPOD_PREFIX"graphPositionX",
+	SYNTHPOD_PREFIX"graphPositionY",
+	SYNTHPOD_PREFIX"columnEnabled",
+	SYNTHPOD_PREFIX"rowEnabled",
+	SYNTHPOD_PREFIX"portRefresh",
+	SYNTHPOD_PREFIX"bundleLoad",
+	SYNTHPOD_PREFIX"bundleSave",
+	SYNTHPOD_PREFIX"pathGet",
+	SYNTHPOD_PREFIX"DSPProfiling",
+	SYNTHPOD_PREFIX"CPUsAvailable",
+	SYNTHPOD_PREFIX"CPUsUsed",
+	SYNTHPOD_PREFIX"bufferBytesSaved",
+	SYNTHPOD_PREFIX"moduleProfilingPercentiles",
+	SYNTHPOD_PREFIX"DSPProfilingPercentiles",
+	SYNTHPOD_PREFIX"periodSize",
+	SYNTHPOD_PREFIX"numPeriods",
+	SYNTHPOD_PREFIX"quit",
+	SYNTHPOD_PREFIX"systemPorts",
+	SYNTHPOD_PREFIX"ControlPort",
+	SYNTHPOD_PREFIX"AudioPort",
+	SYNTHPOD_PREFIX"CVPort",
+	SYNTHPOD_PREFIX"MIDIPort",
+	SYNTHPOD_PREFIX"OSCPort",
+	SYNTHPOD_PREFIX"ComPort",
+	SYNTHPOD_PREFIX"connectionList",
+	SYNTHPOD_PREFIX"nodeList",
+	SYNTHPOD_PREFIX"subscriptionList",
+	SYNTHPOD_PREFIX"notificationList",
+	SYNTHPOD_PREFIX"automationList",
+	SYNTHPOD_PREFIX"sourceModule",
+	SYNTHPOD_PREFIX"sourceSymbol",
+	SYNTHPOD_PREFIX"sinkModule",
+	SYNTHPOD_PREFIX"sinkSymbol",
+	SYNTHPOD_PREFIX"sourceMinimum",
+	SYNTHPOD_PREFIX"sourceMaximum",
+	SYNTHPOD_PREFIX"sinkMinimum",
+	SYNTHPOD_PREFIX"sinkMaximum",
+	SYNTHPOD_PREFIX"sourceEnabled",
+	SYNTHPOD_PREFIX"sinkEnabled",
+	SYNTHPOD_PREFIX"learning",
+	SYNTHPOD_PREFIX"placeholder",
+	SYNTHPOD_PREFIX"visibility",
+	LV2_INLINEDISPLAY_PREFIX"surface",
+};
+
+#define SYNTHPOD_NSTATIC_URIS (sizeof(synthpod_static_uris) / sizeof(const char *))
+
+#endif
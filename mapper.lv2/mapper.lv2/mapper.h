@@ -38,6 +38,10 @@ extern "C" {
 #	define MAPPER_SEED 12345
 #endif
 
+#if !defined(MAPPER_LOAD)
+#	define MAPPER_LOAD 50 // load factor in percent at which to grow
+#endif
+
 typedef struct _mapper_t mapper_t;
 
 typedef char *(*mapper_alloc_t)(void *data, size_t size);
@@ -53,6 +57,10 @@ mapper_new(uint32_t nitems, uint32_t nstats, const char **stats,
 MAPPER_API void
 mapper_free(mapper_t *mapper);
 
+// call regularly from a single non-rt thread, doubles table size beyond MAPPER_LOAD
+MAPPER_API bool
+mapper_grow(mapper_t *mapper);
+
 MAPPER_API uint32_t
 mapper_get_usage(mapper_t *mapper);
 
@@ -68,20 +76,44 @@ mapper_get_unmap(mapper_t *mapper);
 
 #if !defined(_WIN32)
 #	include <sys/mman.h> // mlock
+#	include <sched.h> // sched_yield
 #endif
 
-typedef struct _mapper_item_t mapper_item_t;
+#define MAPPER_MOVED UINT32_MAX // frozen empty slot, continue in next table
+#define MAPPER_SEGS 32
+#define MAPPER_CACHE_LINE 64
 
-struct _mapper_item_t {
-	atomic_uintptr_t val;
-	uint32_t stat;
-};
+typedef struct _mapper_table_t mapper_table_t;
 
-struct _mapper_t {
+// maps URIs to URIDs, URIs themselves live in segments indexed by URID
+struct _mapper_table_t {
 	uint32_t nitems;
 	uint32_t nitems_mask;
+	atomic_uintptr_t next; // table being migrated to, 0: none
+
+	atomic_uint items []; // URID, 0: empty slot
+};
+
+struct _mapper_t {
+	atomic_uintptr_t table; // current table
+	atomic_flag growing;
+
+	// URIDs never change, segment k holds URIDs [nitems<<(k-1), nitems<<k)
+	uint32_t nitems; // size of first segment
+	uint32_t nitems_shift;
+	atomic_uint nsegs;
+	atomic_uint capacity;
+	atomic_uint nurids;
+	atomic_uintptr_t segs [MAPPER_SEGS];
+
 	atomic_uint usage;
 
+	// readers announce themselves in the counter of the current epoch parity
+	uint8_t pad1 [MAPPER_CACHE_LINE];
+	atomic_uint epoch;
+	atomic_uint readers [2];
+	uint8_t pad2 [MAPPER_CACHE_LINE];
+
 	mapper_alloc_t alloc;
 	mapper_free_t free;
 	void *data;
@@ -92,117 +124,497 @@ struct _mapper_t {
 	uint32_t nstats;
 	const char **stats;
 
-	mapper_item_t items [];
+	// perfect hash over static URIs, NULL: they live in the dynamic table
+	uint32_t *stat_disps; // displacement per bucket
+	uint32_t *stat_slots; // static URID, 0: empty slot
+	uint32_t stat_buckets_mask;
+	uint32_t stat_slots_mask;
 };
 
-static uint32_t
-_mapper_map(void *data, const char *uri)
+static inline atomic_uintptr_t *
+_mapper_slot(mapper_t *mapper, uint32_t urid)
 {
-	if(!uri) // invalid URI
+	uint32_t k = 0;
+	uint32_t off = urid;
+
+	if(urid >= mapper->nitems)
+	{
+		k = 32 - __builtin_clz(urid) - mapper->nitems_shift;
+		off = urid - (mapper->nitems << (k - 1));
+	}
+
+	atomic_uintptr_t *seg = (atomic_uintptr_t *)atomic_load_explicit(&mapper->segs[k],
+		memory_order_acquire);
+
+	return &seg[off];
+}
+
+static inline const char *
+_mapper_uri(mapper_t *mapper, uint32_t urid)
+{
+	if(urid < mapper->nstats)
+	{
+		return mapper->stats[urid];
+	}
+
+	return (const char *)atomic_load_explicit(_mapper_slot(mapper, urid),
+		memory_order_acquire);
+}
+
+static inline uint32_t
+_mapper_stat_slot(mapper_t *mapper, uint64_t hash, uint32_t disp)
+{
+	const uint32_t f1 = hash >> 32;
+	const uint32_t f2 = ((uint32_t)hash >> 16) | 1;
+
+	return (f1 + disp*f2) & mapper->stat_slots_mask;
+}
+
+// constant time lookup of static URIs, needs neither atomics nor probing
+static inline uint32_t
+_mapper_stat_lookup(mapper_t *mapper, uint64_t hash, const char *uri)
+{
+	if(!mapper->stat_slots)
 	{
 		return 0;
 	}
 
-	char *uri_clone = NULL;
-	const size_t uri_len = strlen(uri) + 1;
-	mapper_t *mapper = data;
-	const uint32_t hash = mum_hash(uri, uri_len - 1, MAPPER_SEED); // ignore zero terminator
+	const uint32_t disp = mapper->stat_disps[hash & mapper->stat_buckets_mask];
+	const uint32_t urid = mapper->stat_slots[_mapper_stat_slot(mapper, hash, disp)];
+
+	if(urid && (strcmp(mapper->stats[urid], uri) == 0))
+	{
+		return urid;
+	}
+
+	return 0;
+}
+
+// hash and displace, buckets with most URIs are placed first
+static bool
+_mapper_stat_build(mapper_t *mapper)
+{
+	const uint32_t nstats = mapper->nstats;
+
+	uint32_t nslots = 1;
+	while(nslots < 2*nstats)
+	{
+		nslots <<= 1;
+	}
+
+	uint32_t nbuckets = 1;
+	while(nbuckets < nstats/4)
+	{
+		nbuckets <<= 1;
+	}
 
-	for(uint32_t i = 0, idx = (hash + i*i) & mapper->nitems_mask;
-		i < mapper->nitems;
-		i++, idx = (hash + i*i) & mapper->nitems_mask)
+	mapper->stat_slots_mask = nslots - 1;
+	mapper->stat_buckets_mask = nbuckets - 1;
+	mapper->stat_slots = calloc(nslots, sizeof(uint32_t));
+	mapper->stat_disps = calloc(nbuckets, sizeof(uint32_t));
+	uint64_t *hashes = calloc(nstats, sizeof(uint64_t));
+	uint32_t *sizes = calloc(nbuckets, sizeof(uint32_t));
+	uint32_t *slots = calloc(nstats, sizeof(uint32_t));
+	uint32_t *urids = calloc(nstats, sizeof(uint32_t));
+	bool success = mapper->stat_slots && mapper->stat_disps && hashes && sizes
+		&& slots && urids;
+
+	for(uint32_t i = 1; success && (i < nstats); i++)
 	{
-		mapper_item_t *item = &mapper->items[idx];
+		const char *uri = mapper->stats[i];
+
+		hashes[i] = mum_hash(uri, strlen(uri), MAPPER_SEED);
+		sizes[hashes[i] & mapper->stat_buckets_mask] += 1;
+	}
 
-		// find out if URI is already mapped
-		const uintptr_t val = atomic_load_explicit(&item->val, memory_order_acquire);
-		if(val != 0) // slot is already taken
+	uint32_t max_size = 0;
+	for(uint32_t b = 0; success && (b < nbuckets); b++)
+	{
+		if(sizes[b] > max_size)
 		{
-			if(memcmp((const char *)val, uri, uri_len) == 0) // URI is already mapped, use that
+			max_size = sizes[b];
+		}
+	}
+
+	for(uint32_t size = max_size; success && (size > 0); size--)
+	{
+		for(uint32_t b = 0; success && (b < nbuckets); b++)
+		{
+			if(sizes[b] != size)
+			{
+				continue;
+			}
+
+			// try displacements until all URIs of this bucket hit free slots
+			bool placed = false;
+			for(uint32_t disp = 0; !placed && (disp < 4*nslots); disp++)
 			{
-				if(uri_clone)
+				uint32_t n = 0;
+				bool collision = false;
+
+				for(uint32_t i = 1; !collision && (i < nstats); i++)
+				{
+					if( (hashes[i] & mapper->stat_buckets_mask) != b)
+					{
+						continue;
+					}
+
+					const uint32_t slot = _mapper_stat_slot(mapper, hashes[i], disp);
+					bool dup = false;
+
+					collision = mapper->stat_slots[slot] != 0;
+					for(uint32_t j = 0; !collision && (j < n); j++)
+					{
+						if(slots[j] != slot)
+						{
+							continue;
+						}
+
+						// same URI twice, first one wins
+						dup = (hashes[urids[j]] == hashes[i])
+							&& (strcmp(mapper->stats[urids[j]], mapper->stats[i]) == 0);
+						collision = !dup;
+					}
+
+					if(!collision && !dup)
+					{
+						slots[n] = slot;
+						urids[n] = i;
+						n++;
+					}
+				}
+
+				if(collision)
 				{
-					mapper->free(mapper->data, uri_clone); // free superfluous URI
+					continue;
 				}
 
-				return item->stat ? item->stat : idx + mapper->nstats;
+				for(uint32_t j = 0; j < n; j++)
+				{
+					mapper->stat_slots[slots[j]] = urids[j];
+				}
+
+				mapper->stat_disps[b] = disp;
+				placed = true;
 			}
 
-			// slot is already taken by another URI, try next slot
-			continue;
+			success = placed;
 		}
+	}
+
+	free(hashes);
+	free(sizes);
+	free(slots);
+	free(urids);
+
+	if(!success)
+	{
+		free(mapper->stat_slots);
+		free(mapper->stat_disps);
+		mapper->stat_slots = NULL;
+		mapper->stat_disps = NULL;
+
+		return false;
+	}
+
+#if !defined(_WIN32)
+	// lock memory
+	mlock(mapper->stat_slots, nslots*sizeof(uint32_t));
+	mlock(mapper->stat_disps, nbuckets*sizeof(uint32_t));
+#endif
 
-		// clone URI for possible injection
-		if(!uri_clone)
+	return true;
+}
+
+static inline unsigned
+_mapper_rcu_lock(mapper_t *mapper)
+{
+	while(true)
+	{
+		const unsigned epoch = atomic_load(&mapper->epoch);
+
+		atomic_fetch_add(&mapper->readers[epoch & 1], 1);
+
+		if(atomic_load(&mapper->epoch) == epoch) // no flip in between
 		{
-			uri_clone = mapper->alloc(mapper->data, uri_len);
+			return epoch;
+		}
 
-			if(!uri_clone) // out-of-memory
-			{
-				return 0;
-			}
+		atomic_fetch_sub(&mapper->readers[epoch & 1], 1);
+	}
+}
 
-			memcpy(uri_clone, uri, uri_len);
+static inline void
+_mapper_rcu_unlock(mapper_t *mapper, unsigned epoch)
+{
+	atomic_fetch_sub_explicit(&mapper->readers[epoch & 1], 1, memory_order_release);
+}
+
+// wait until all readers which may still see a retired table have left
+static void
+_mapper_rcu_synchronize(mapper_t *mapper)
+{
+	const unsigned epoch = atomic_fetch_add(&mapper->epoch, 1);
+
+	while(atomic_load(&mapper->readers[epoch & 1]))
+	{
+#if !defined(_WIN32)
+		sched_yield();
+#endif
+	}
+}
+
+// reserve next URID, fails if segments have not been grown yet
+static inline uint32_t
+_mapper_reserve(mapper_t *mapper)
+{
+	uint32_t urid = atomic_load_explicit(&mapper->nurids, memory_order_relaxed);
+
+	do
+	{
+		if(urid >= atomic_load_explicit(&mapper->capacity, memory_order_acquire))
+		{
+			return 0;
 		}
+	} while(!atomic_compare_exchange_weak_explicit(&mapper->nurids, &urid, urid + 1,
+		memory_order_release, memory_order_relaxed));
+
+	return urid;
+}
 
-		// try to populate slot with newly mapped URI
-		uintptr_t expected = 0;
-		const uintptr_t desired = (uintptr_t)uri_clone;
-		const bool match = atomic_compare_exchange_strong_explicit(&item->val,
-			&expected, desired, memory_order_release, memory_order_relaxed);
-		if(match) // we have successfully taken this slot first
+// returns URID if found or injected, 0 if caller should continue in next table
+static uint32_t
+_mapper_table_map(mapper_t *mapper, mapper_table_t *table, uint32_t hash,
+	const char *uri, size_t uri_len, char **uri_clone, uint32_t *urid_new)
+{
+	for(uint32_t i = 0, idx = (hash + i*i) & table->nitems_mask;
+		i < table->nitems;
+		i++, idx = (hash + i*i) & table->nitems_mask)
+	{
+		atomic_uint *item = &table->items[idx];
+
+		uint32_t urid = atomic_load_explicit(item, memory_order_acquire);
+
+		if(urid == 0) // empty slot, try to populate it
 		{
-			atomic_fetch_add_explicit(&mapper->usage, 1, memory_order_relaxed);
+			// clone URI and reserve URID once for possible injection
+			if(!*urid_new)
+			{
+				if(!*uri_clone)
+				{
+					*uri_clone = mapper->alloc(mapper->data, uri_len);
+
+					if(!*uri_clone) // out-of-memory
+					{
+						return 0;
+					}
+
+					memcpy(*uri_clone, uri, uri_len);
+				}
+
+				*urid_new = _mapper_reserve(mapper);
+
+				if(!*urid_new) // URID segments exhausted
+				{
+					return 0;
+				}
+
+				atomic_store_explicit(_mapper_slot(mapper, *urid_new),
+					(uintptr_t)*uri_clone, memory_order_release);
+			}
+
+			const bool match = atomic_compare_exchange_strong_explicit(item,
+				&urid, *urid_new, memory_order_release, memory_order_acquire);
+			if(match) // we have successfully taken this slot first
+			{
+				atomic_fetch_add_explicit(&mapper->usage, 1, memory_order_relaxed);
 
-			return item->stat ? item->stat : idx + mapper->nstats;
+				return *urid_new;
+			}
 		}
-		else if(memcmp((const char *)expected, uri, uri_len) == 0) // other thread stole it
+
+		if(urid == MAPPER_MOVED) // slot frozen by migration, URI is not in this table
 		{
-			mapper->free(mapper->data, uri_clone); // free superfluous URI
+			return 0;
+		}
 
-			return item->stat ? item->stat : idx + mapper->nstats;
+		if(strcmp(_mapper_uri(mapper, urid), uri) == 0) // URI is already mapped, use that
+		{
+			return urid;
 		}
 
 		// slot is already taken by another URI, try next slot
 	}
 
 	// item buffer overflow
+	return 0;
+}
+
+// inject known URID, only used by the migrating thread and at initialization
+static bool
+_mapper_table_put(mapper_t *mapper, mapper_table_t *table, uint32_t urid)
+{
+	const char *uri = _mapper_uri(mapper, urid);
+	const uint32_t hash = mum_hash(uri, strlen(uri), MAPPER_SEED);
 
-	if(uri_clone)
+	for(uint32_t i = 0, idx = (hash + i*i) & table->nitems_mask;
+		i < table->nitems;
+		i++, idx = (hash + i*i) & table->nitems_mask)
 	{
-		mapper->free(mapper->data, uri_clone); // free superfluous URI
+		atomic_uint *item = &table->items[idx];
+
+		uint32_t expected = 0;
+		const bool match = atomic_compare_exchange_strong_explicit(item,
+			&expected, urid, memory_order_release, memory_order_relaxed);
+		if(match)
+		{
+			return true;
+		}
 	}
 
-	return 0;
+	return false;
 }
 
-static const char *
-_mapper_unmap(void *data, uint32_t urid)
+static mapper_table_t *
+_mapper_table_new(uint32_t nitems)
 {
+	const size_t size = sizeof(mapper_table_t) + nitems*sizeof(atomic_uint);
+	mapper_table_t *table = calloc(1, size);
+	if(!table) // allocation failed
+	{
+		return NULL;
+	}
+
+	table->nitems = nitems;
+	table->nitems_mask = nitems - 1;
+	atomic_init(&table->next, 0);
+
+	// initialize atomic variables of items
+	for(uint32_t idx = 0; idx < nitems; idx++)
+	{
+		atomic_init(&table->items[idx], 0);
+	}
+
+#if !defined(_WIN32)
+	// lock memory
+	mlock(table, size);
+#endif
+
+	return table;
+}
+
+static void
+_mapper_table_free(mapper_table_t *table)
+{
+#if !defined(_WIN32)
+	// unlock memory
+	munlock(table, sizeof(mapper_table_t) + table->nitems*sizeof(atomic_uint));
+#endif
+
+	free(table);
+}
+
+// append URID segment, e.g. capacity doubles
+static bool
+_mapper_seg_add(mapper_t *mapper)
+{
+	const uint32_t k = atomic_load_explicit(&mapper->nsegs, memory_order_relaxed);
+
+	if(k >= MAPPER_SEGS - mapper->nitems_shift)
+	{
+		return false; // URID space exhausted
+	}
+
+	const uint32_t nslots = k ? mapper->nitems << (k - 1) : mapper->nitems;
+	const size_t size = nslots*sizeof(atomic_uintptr_t);
+	atomic_uintptr_t *seg = calloc(1, size);
+	if(!seg)
+	{
+		return false;
+	}
+
+	for(uint32_t i = 0; i < nslots; i++)
+	{
+		atomic_init(&seg[i], 0);
+	}
+
+#if !defined(_WIN32)
+	// lock memory
+	mlock(seg, size);
+#endif
+
+	atomic_store_explicit(&mapper->segs[k], (uintptr_t)seg, memory_order_release);
+	atomic_store_explicit(&mapper->nsegs, k + 1, memory_order_relaxed);
+	atomic_store_explicit(&mapper->capacity, mapper->nitems << k, memory_order_release);
+
+	return true;
+}
+
+static uint32_t
+_mapper_map(void *data, const char *uri)
+{
+	if(!uri) // invalid URI
+	{
+		return 0;
+	}
+
+	char *uri_clone = NULL;
+	uint32_t urid_new = 0;
+	const size_t uri_len = strlen(uri) + 1;
 	mapper_t *mapper = data;
+	const uint64_t hash64 = mum_hash(uri, uri_len - 1, MAPPER_SEED); // ignore zero terminator
+	const uint32_t hash = hash64;
 
-	if(urid == 0) // invalid URID
+	// well-known URIs never hit the dynamic table
+	const uint32_t stat = _mapper_stat_lookup(mapper, hash64, uri);
+	if(stat)
 	{
-		return NULL;
+		return stat;
 	}
 
-	if(urid < mapper->nstats)
+	const unsigned epoch = _mapper_rcu_lock(mapper);
+
+	// look in current table first, then in the one it is being migrated to
+	uint32_t urid = 0;
+	for(mapper_table_t *table = (mapper_table_t *)atomic_load_explicit(&mapper->table,
+			memory_order_acquire);
+		table && !urid;
+		table = (mapper_table_t *)atomic_load_explicit(&table->next, memory_order_acquire))
 	{
-		return mapper->stats[urid];
+		urid = _mapper_table_map(mapper, table, hash, uri, uri_len, &uri_clone, &urid_new);
 	}
 
-	urid -= mapper->nstats;
+	_mapper_rcu_unlock(mapper, epoch);
 
-	if(urid > mapper->nitems) // invalid URID
+	if(urid_new && (urid != urid_new)) // reserved URID is unused, leave a hole
 	{
-		return NULL;
+		atomic_store_explicit(_mapper_slot(mapper, urid_new), 0, memory_order_relaxed);
+	}
+
+	if(uri_clone && (urid != urid_new))
+	{
+		mapper->free(mapper->data, uri_clone); // free superfluous URI
 	}
 
-	mapper_item_t *item = &mapper->items[urid];
+	return urid;
+}
+
+static const char *
+_mapper_unmap(void *data, uint32_t urid)
+{
+	mapper_t *mapper = data;
+
+	if(urid == 0) // invalid URID
+	{
+		return NULL;
+	}
 
-	const uintptr_t val = atomic_load_explicit(&item->val, memory_order_relaxed);
+	if(urid >= atomic_load_explicit(&mapper->nurids, memory_order_acquire)) // invalid URID
+	{
+		return NULL;
+	}
 
-	return (const char *)val;
+	return _mapper_uri(mapper, urid);
 }
 
 static char *
@@ -225,8 +637,9 @@ MAPPER_API bool
 mapper_is_lock_free(void)
 {
 	atomic_uintptr_t val;
+	atomic_uint urid;
 
-	return atomic_is_lock_free(&val);
+	return atomic_is_lock_free(&val) && atomic_is_lock_free(&urid);
 }
 
 MAPPER_API mapper_t *
@@ -234,22 +647,31 @@ mapper_new(uint32_t nitems, uint32_t nstats, const char **stats,
 	mapper_alloc_t mapper_alloc_cb, mapper_free_t mapper_free_cb, void *data)
 {
 	// item number needs to be a power of two
-	uint32_t power_of_two = 1;
+	uint32_t power_of_two = 2;
 	while(power_of_two < nitems)
 	{
 		power_of_two <<= 1; // assure size to be a power of 2
 	}
 
+	// first URID segment needs to fit static and dynamic URIDs
+	uint32_t seg_size = power_of_two;
+	uint32_t shift = __builtin_ctz(seg_size);
+	while(seg_size < power_of_two + nstats)
+	{
+		seg_size <<= 1;
+		shift += 1;
+	}
+
 	// allocate mapper structure
-	mapper_t *mapper = calloc(1, sizeof(mapper_t) + power_of_two*sizeof(mapper_item_t));
+	mapper_t *mapper = calloc(1, sizeof(mapper_t));
 	if(!mapper) // allocation failed
 	{
 		return NULL;
 	}
 
 	// set mapper properties
-	mapper->nitems = power_of_two;
-	mapper->nitems_mask = power_of_two - 1;
+	mapper->nitems = seg_size;
+	mapper->nitems_shift = shift;
 
 	mapper->nstats = nstats;
 	mapper->stats = stats;
@@ -268,33 +690,48 @@ mapper_new(uint32_t nitems, uint32_t nstats, const char **stats,
 	mapper->unmap.unmap = _mapper_unmap;
 	mapper->unmap.handle = mapper;
 
-	// initialize atomic usage counter
+	// initialize atomic variables
+	atomic_flag_clear(&mapper->growing);
+	atomic_init(&mapper->nsegs, 0);
+	atomic_init(&mapper->capacity, 0);
+	atomic_init(&mapper->nurids, nstats ? nstats : 1); // URID 0 is invalid
 	atomic_init(&mapper->usage, 0);
+	atomic_init(&mapper->epoch, 0);
+	atomic_init(&mapper->readers[0], 0);
+	atomic_init(&mapper->readers[1], 0);
+	for(uint32_t k = 0; k < MAPPER_SEGS; k++)
+	{
+		atomic_init(&mapper->segs[k], 0);
+	}
 
-	// initialize atomic variables of items
-	for(uint32_t idx = 0; idx < mapper->nitems; idx++)
+	mapper_table_t *table = _mapper_table_new(power_of_two);
+	if(!table || !_mapper_seg_add(mapper))
 	{
-		mapper_item_t *item = &mapper->items[idx];
+		if(table)
+		{
+			_mapper_table_free(table);
+		}
+		free(mapper);
 
-		atomic_init(&item->val, 0);
-		item->stat = 0;
+		return NULL;
 	}
+	atomic_init(&mapper->table, (uintptr_t)table);
 
 #if !defined(_WIN32)
 	// lock memory
-	mlock(mapper, sizeof(mapper_t) + mapper->nitems*sizeof(mapper_item_t));
+	mlock(mapper, sizeof(mapper_t));
 #endif
 
-	// populate static URIDs
-	for(uint32_t i = 1; i < mapper->nstats; i++)
+	// populate static URIDs, via perfect hash or dynamic table as fallback
+	if( (mapper->nstats > 1) && !_mapper_stat_build(mapper) )
 	{
-		const char *uri = mapper->stats[i];
-
-		const uint32_t urid = _mapper_map(mapper, uri);
-		mapper_item_t *item = &mapper->items[urid - mapper->nstats];
-
-		item->stat = i;
+		for(uint32_t i = 1; i < mapper->nstats; i++)
+		{
+			_mapper_table_put(mapper, table, i);
+		}
 	}
+	atomic_fetch_add_explicit(&mapper->usage, mapper->nstats ? mapper->nstats - 1 : 0,
+		memory_order_relaxed);
 
 	return mapper;
 }
@@ -302,31 +739,118 @@ mapper_new(uint32_t nitems, uint32_t nstats, const char **stats,
 MAPPER_API void
 mapper_free(mapper_t *mapper)
 {
-	// free URIs in item array with free function
-	for(uint32_t idx = 0; idx < mapper->nitems; idx++)
+	// free URIs in segments with free function, static ones are not owned
+	const uint32_t nurids = atomic_load_explicit(&mapper->nurids, memory_order_relaxed);
+	for(uint32_t urid = mapper->nstats; urid < nurids; urid++)
 	{
-		mapper_item_t *item = &mapper->items[idx];
+		atomic_uintptr_t *slot = _mapper_slot(mapper, urid);
 
 		// try to depopulate slot
-		uintptr_t expected = 0;
-		const uintptr_t desired = 0;
-		const bool match = atomic_compare_exchange_strong_explicit(&item->val,
-			&expected, desired, memory_order_release, memory_order_relaxed);
-		if(!match) // we have successfully depopulated this slot first
+		const uintptr_t val = atomic_exchange_explicit(slot, 0, memory_order_relaxed);
+		if(val) // we have successfully depopulated this slot first
 		{
 			atomic_fetch_sub_explicit(&mapper->usage, 1, memory_order_relaxed);
-			mapper->free(mapper->data, (char *)expected);
+			mapper->free(mapper->data, (char *)val);
 		}
 	}
 
+	const uint32_t nsegs = atomic_load_explicit(&mapper->nsegs, memory_order_relaxed);
+	for(uint32_t k = 0; k < nsegs; k++)
+	{
+		atomic_uintptr_t *seg = (atomic_uintptr_t *)atomic_load_explicit(&mapper->segs[k],
+			memory_order_relaxed);
+		const uint32_t nslots = k ? mapper->nitems << (k - 1) : mapper->nitems;
+
+#if !defined(_WIN32)
+		// unlock memory
+		munlock(seg, nslots*sizeof(atomic_uintptr_t));
+#endif
+
+		free(seg);
+	}
+
+	_mapper_table_free((mapper_table_t *)atomic_load_explicit(&mapper->table,
+		memory_order_relaxed));
+
+	if(mapper->stat_slots)
+	{
+#if !defined(_WIN32)
+		// unlock memory
+		munlock(mapper->stat_slots, (mapper->stat_slots_mask + 1)*sizeof(uint32_t));
+		munlock(mapper->stat_disps, (mapper->stat_buckets_mask + 1)*sizeof(uint32_t));
+#endif
+
+		free(mapper->stat_slots);
+		free(mapper->stat_disps);
+	}
+
 #if !defined(_WIN32)
 	// unlock memory
-	munlock(mapper, sizeof(mapper_t) + mapper->nitems*sizeof(mapper_item_t));
+	munlock(mapper, sizeof(mapper_t));
 #endif
 
 	free(mapper);
 }
 
+MAPPER_API bool
+mapper_grow(mapper_t *mapper)
+{
+	mapper_table_t *table = (mapper_table_t *)atomic_load_explicit(&mapper->table,
+		memory_order_acquire);
+
+	const uint64_t usage = atomic_load_explicit(&mapper->usage, memory_order_relaxed);
+	if(usage*100 < (uint64_t)table->nitems*MAPPER_LOAD) // still sparse enough
+	{
+		return false;
+	}
+
+	if(atomic_flag_test_and_set(&mapper->growing)) // somebody else is at it
+	{
+		return false;
+	}
+
+	// URID capacity needs to follow table size
+	mapper_table_t *next = NULL;
+	if( (atomic_load(&mapper->capacity) >= mapper->nstats + table->nitems*2)
+		|| _mapper_seg_add(mapper) )
+	{
+		next = _mapper_table_new(table->nitems*2);
+	}
+
+	if(!next)
+	{
+		atomic_flag_clear(&mapper->growing);
+
+		return false;
+	}
+
+	// from now on, URIs not found in current table are injected into next
+	atomic_store(&table->next, (uintptr_t)next);
+
+	// freeze empty slots and migrate populated ones
+	for(uint32_t idx = 0; idx < table->nitems; idx++)
+	{
+		atomic_uint *item = &table->items[idx];
+
+		uint32_t urid = 0;
+		if(atomic_compare_exchange_strong(item, &urid, MAPPER_MOVED))
+		{
+			continue; // was empty
+		}
+
+		_mapper_table_put(mapper, next, urid);
+	}
+
+	// retire current table once no reader can see it anymore
+	atomic_store(&mapper->table, (uintptr_t)next);
+	_mapper_rcu_synchronize(mapper);
+	_mapper_table_free(table);
+
+	atomic_flag_clear(&mapper->growing);
+
+	return true;
+}
+
 MAPPER_API uint32_t
 mapper_get_usage(mapper_t *mapper)
 {
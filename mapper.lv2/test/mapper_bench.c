@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2017 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#define MAPPER_IMPLEMENTATION
+#include <mapper.lv2/mapper.h>
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <assert.h>
+#include <time.h>
+#include <sched.h>
+
+#include "random.c"
+
+#define MAX_URI_LEN 46
+#define MAX_ITEMS 0x100000 // 1M, in total over all threads
+#define MIN_ITEMS 0x1000 // 4K, initial size when growing
+
+typedef struct _pool_t pool_t;
+
+// per-thread properties
+struct _pool_t {
+	mapper_t *mapper;
+	pthread_t thread;
+	uint32_t nthreads;
+	uint32_t nuris;
+	char (*uris) [MAX_URI_LEN];
+	uint64_t inject_ns;
+	uint64_t lookup_ns;
+};
+
+// threads should start (un)mapping at the same time
+static atomic_uint waiting = ATOMIC_VAR_INIT(0);
+
+// grower thread should stop when mapping threads are done
+static atomic_bool done = ATOMIC_VAR_INIT(false);
+
+static uint64_t
+_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static void
+_barrier(uint32_t n)
+{
+	const uint32_t arrived = atomic_fetch_add(&waiting, 1) + 1;
+	const uint32_t target = (arrived + n - 1) / n * n;
+
+	while(atomic_load(&waiting) < target)
+	{
+		sched_yield();
+	}
+}
+
+static void *
+_thread(void *data)
+{
+	pool_t *pool = data;
+	LV2_URID_Map *map = mapper_get_map(pool->mapper);
+	LV2_URID_Unmap *unmap = mapper_get_unmap(pool->mapper);
+	const uint32_t n = pool->nthreads;
+
+	_barrier(n);
+
+	// inject new URIs, may race with table growth
+	uint64_t t0 = _now();
+	for(uint32_t i = 0; i < pool->nuris; i++)
+	{
+		while(!map->map(map->handle, pool->uris[i]))
+		{
+			sched_yield(); // table full, wait for grower
+		}
+	}
+	pool->inject_ns = _now() - t0;
+
+	_barrier(n);
+
+	// look up already mapped URIs
+	t0 = _now();
+	for(uint32_t i = 0; i < pool->nuris; i++)
+	{
+		const uint32_t urid = map->map(map->handle, pool->uris[i]);
+		assert(urid);
+		(void)urid;
+	}
+	pool->lookup_ns = _now() - t0;
+
+	// unmap is not timed, it is a plain array access
+	for(uint32_t i = 0; i < pool->nuris; i++)
+	{
+		const char *uri = unmap->unmap(unmap->handle, map->map(map->handle, pool->uris[i]));
+		assert(uri && !strcmp(uri, pool->uris[i]));
+		(void)uri;
+	}
+
+	return NULL;
+}
+
+static void *
+_grower(void *data)
+{
+	mapper_t *mapper = data;
+
+	while(!atomic_load_explicit(&done, memory_order_relaxed))
+	{
+		if(!mapper_grow(mapper))
+		{
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+	assert(mapper_is_lock_free());
+
+	assert(argc > 2);
+	const uint32_t n = atoi(argv[1]); // number of concurrent threads
+	const bool grow = atoi(argv[2]); // whether to start small and grow while mapping
+	assert(n > 0);
+
+	mapper_t *mapper = mapper_new(grow ? MIN_ITEMS : MAX_ITEMS, 0, NULL, NULL, NULL, NULL);
+	assert(mapper);
+
+	pool_t *pools = calloc(n, sizeof(pool_t));
+	assert(pools);
+
+	(void)genrand_res53; // to make pedantic compiler happy
+
+	// distinct URIs per thread, generated upfront
+	for(uint32_t p = 0; p < n; p++)
+	{
+		pool_t *pool = &pools[p];
+		MT mersenne;
+
+		pool->mapper = mapper;
+		pool->nthreads = n;
+		pool->nuris = MAX_ITEMS / 2 / n;
+		pool->uris = calloc(pool->nuris, MAX_URI_LEN);
+		assert(pool->uris);
+
+		init_genrand(&mersenne, p + 1);
+		for(uint32_t i = 0; i < pool->nuris; i++)
+		{
+			snprintf(pool->uris[i], MAX_URI_LEN, "urn:bench:%08"PRIx32"%08lx%08lx",
+				p, genrand_int32(&mersenne), genrand_int32(&mersenne));
+		}
+	}
+
+	pthread_t grower;
+	if(grow)
+	{
+		pthread_create(&grower, NULL, _grower, mapper);
+	}
+
+	for(uint32_t p = 0; p < n; p++)
+	{
+		pthread_create(&pools[p].thread, NULL, _thread, &pools[p]);
+	}
+
+	uint64_t inject_ns = 0;
+	uint64_t lookup_ns = 0;
+	for(uint32_t p = 0; p < n; p++)
+	{
+		pool_t *pool = &pools[p];
+
+		pthread_join(pool->thread, NULL);
+		inject_ns += pool->inject_ns;
+		lookup_ns += pool->lookup_ns;
+		free(pool->uris);
+	}
+
+	atomic_store_explicit(&done, true, memory_order_relaxed);
+	if(grow)
+	{
+		pthread_join(grower, NULL);
+	}
+
+	const uint32_t nuris = pools[0].nuris * n;
+	assert(mapper_get_usage(mapper) == nuris);
+	const mapper_table_t *table = (const mapper_table_t *)atomic_load(&mapper->table);
+
+	fprintf(stdout,
+		"  threads   : %"PRIu32"\n"
+		"  grow      : %s (%"PRIu32" -> %"PRIu32" items)\n"
+		"  inject    : %.1f ns/op per thread\n"
+		"  lookup    : %.1f ns/op per thread\n",
+		n, grow ? "yes" : "no", grow ? MIN_ITEMS : MAX_ITEMS, table->nitems,
+		(double)inject_ns / nuris, (double)lookup_ns / nuris);
+
+	free(pools);
+	mapper_free(mapper);
+
+	return 0;
+}
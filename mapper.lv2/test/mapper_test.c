@@ -25,11 +25,13 @@
 #include <assert.h>
 #include <time.h>
 #include <math.h>
+#include <sched.h>
 
 #include "random.c"
 
 #define MAX_URI_LEN 46
 #define MAX_ITEMS 0x100000 // 1M
+#define MIN_ITEMS 0x1000 // 4K, initial size when growing
 #define USE_STATS
 
 #if defined(USE_STATS)
@@ -64,6 +66,7 @@ struct _pool_t {
 	mapper_t *mapper;
 	pthread_t thread;
 	MT mersenne;
+	bool grow;
 };
 
 enum {
@@ -166,6 +169,69 @@ _nrtmem_free(void *data, char *uri)
 // threads should start (un)mapping at the same time
 static atomic_bool rolling = ATOMIC_VAR_INIT(false);
 
+// grower thread should stop when mapping threads are done
+static atomic_bool done = ATOMIC_VAR_INIT(false);
+
+// URIDs as seen by the first thread mapping a given URI
+static atomic_uint urids [MAX_ITEMS/2];
+
+static uint32_t
+_map(LV2_URID_Map *map, const char *uri, bool grow)
+{
+	uint32_t urid;
+
+	// table may temporarily be full until grower thread has caught up
+	while(!(urid = map->map(map->handle, uri)) && grow)
+	{
+		sched_yield();
+	}
+
+	return urid;
+}
+
+static void *
+_grower(void *data)
+{
+	pool_t *pool = data;
+	mapper_t *mapper = pool->mapper;
+
+	while(!atomic_load_explicit(&done, memory_order_relaxed))
+	{
+		if(!mapper_grow(mapper))
+		{
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+static void
+_uri_gen(MT *mersenne, char *uri)
+{
+	// generate UUID version 4 URN via mersenne twister random number generator
+	union {
+		uint8_t bytes [0x10];
+		uint32_t u32s [0x4];
+	} un;
+
+	for(unsigned i=0x0; i<0x4; i++)
+	{
+		un.u32s[i] = genrand_int32(mersenne);
+	}
+
+	un.bytes[6] = (un.bytes[6] & 0x0f) | 0x40; // set four most significant bits of 7th byte to 0b0100
+	un.bytes[8] = (un.bytes[8] & 0x3f) | 0x80; // set two most significant bits of 9th byte to 0b10
+
+	snprintf(uri, MAX_URI_LEN,
+		"urn:uuid:%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+		un.bytes[0x0], un.bytes[0x1], un.bytes[0x2], un.bytes[0x3],
+		un.bytes[0x4], un.bytes[0x5],
+		un.bytes[0x6], un.bytes[0x7],
+		un.bytes[0x8], un.bytes[0x9],
+		un.bytes[0xa], un.bytes[0xb], un.bytes[0xc], un.bytes[0xd], un.bytes[0xe], un.bytes[0xf]);
+}
+
 static void *
 _thread(void *data)
 {
@@ -194,43 +260,73 @@ _thread(void *data)
 	char uri [MAX_URI_LEN];
 	for(uint32_t i = 0; i < MAX_ITEMS/2; i++)
 	{
-		// generate UUID version 4 URN via mersenne twister random number generator
-		{
-			union {
-				uint8_t bytes [0x10];
-				uint32_t u32s [0x4];
-			} un;
-
-			for(unsigned i=0x0; i<0x4; i++)
-			{
-				un.u32s[i] = genrand_int32(&pool->mersenne);
-			}
+		_uri_gen(&pool->mersenne, uri);
 
-			un.bytes[6] = (un.bytes[6] & 0x0f) | 0x40; // set four most significant bits of 7th byte to 0b0100
-			un.bytes[8] = (un.bytes[8] & 0x3f) | 0x80; // set two most significant bits of 9th byte to 0b10
-
-			snprintf(uri, MAX_URI_LEN,
-				"urn:uuid:%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-				un.bytes[0x0], un.bytes[0x1], un.bytes[0x2], un.bytes[0x3],
-				un.bytes[0x4], un.bytes[0x5],
-				un.bytes[0x6], un.bytes[0x7],
-				un.bytes[0x8], un.bytes[0x9],
-				un.bytes[0xa], un.bytes[0xb], un.bytes[0xc], un.bytes[0xd], un.bytes[0xe], un.bytes[0xf]);
-		}
-
-		const uint32_t urid1 = map->map(map->handle, uri);
+		const uint32_t urid1 = _map(map, uri, pool->grow);
 		assert(urid1);
 		const char *dst = unmap->unmap(unmap->handle, urid1);
 		assert(dst);
 		assert(strcmp(dst, uri) == 0);
-		const uint32_t urid2 = map->map(map->handle, uri);
+		const uint32_t urid2 = _map(map, uri, pool->grow);
 		assert(urid2);
 		assert(urid1 == urid2);
+
+		// all threads must see the same URID for the same URI
+		uint32_t expected = 0;
+		if(!atomic_compare_exchange_strong(&urids[i], &expected, urid1))
+		{
+			assert(expected == urid1);
+		}
 	}
 
 	return NULL;
 }
 
+// large static dictionary must be perfectly hashed and keep its URIDs
+static void
+_test_stats(void)
+{
+	const uint32_t nlarge = 0x1000;
+	const char **large = calloc(nlarge, sizeof(const char *));
+	char (*uris) [MAX_URI_LEN] = calloc(nlarge, MAX_URI_LEN);
+	assert(large && uris);
+
+	for(uint32_t i = 1; i < nlarge; i++)
+	{
+		snprintf(uris[i], MAX_URI_LEN, "urn:static:%"PRIu32, i);
+		large[i] = uris[i];
+	}
+	large[nlarge - 1] = large[1]; // duplicate, first one wins
+
+	mapper_t *mapper = mapper_new(0x100, nlarge, large, NULL, NULL, NULL);
+	assert(mapper);
+	assert(mapper->stat_slots);
+
+	LV2_URID_Map *map = mapper_get_map(mapper);
+	LV2_URID_Unmap *unmap = mapper_get_unmap(mapper);
+
+	for(uint32_t i = 1; i < nlarge - 1; i++)
+	{
+		assert(map->map(map->handle, large[i]) == i);
+		assert(unmap->unmap(unmap->handle, i) == large[i]);
+	}
+	assert(map->map(map->handle, large[nlarge - 1]) == 1);
+
+	// static URIs are never injected into the dynamic table
+	const mapper_table_t *table = (const mapper_table_t *)atomic_load(&mapper->table);
+	for(uint32_t idx = 0; idx < table->nitems; idx++)
+	{
+		assert(atomic_load(&table->items[idx]) == 0);
+	}
+
+	// dynamic URIDs start right after the static ones
+	assert(map->map(map->handle, "urn:dynamic:1") == nlarge);
+
+	mapper_free(mapper);
+	free(uris);
+	free(large);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -239,14 +335,21 @@ main(int argc, char **argv)
 
 	assert(mapper_is_lock_free());
 
+	_test_stats();
+
 	assert(argc > 2);
 	const uint32_t n = atoi(argv[1]); // number of concurrent threads
 	const bool is_rt = atoi(argv[2]); // whether to use rt-memory
 
-	const uint64_t seed = (argc == 4) // get seed from command line or from time
+	const uint64_t seed = (argc > 3) // get seed from command line or from time
 		? atol(argv[3])
 		: time(NULL);
 
+	const bool grow = (argc > 4) // whether to start small and grow while mapping
+		? atoi(argv[4])
+		: false;
+	const uint32_t nitems = grow ? MIN_ITEMS : MAX_ITEMS;
+
 	// create rt memory
 	rtmem_t *rtmem = rtmem_new(n);
 	assert(rtmem);
@@ -256,8 +359,8 @@ main(int argc, char **argv)
 
 	// create mapper
 	mapper_t *mapper = is_rt
-		? mapper_new(MAX_ITEMS, nstats, stats, _rtmem_alloc, _rtmem_free, rtmem)
-		: mapper_new(MAX_ITEMS, nstats, stats, _nrtmem_alloc, _nrtmem_free, &nrtmem);
+		? mapper_new(nitems, nstats, stats, _rtmem_alloc, _rtmem_free, rtmem)
+		: mapper_new(nitems, nstats, stats, _nrtmem_alloc, _nrtmem_free, &nrtmem);
 	assert(mapper);
 
 	// create array of threads
@@ -272,10 +375,20 @@ main(int argc, char **argv)
 		pool_t *pool = &pools[p];
 
 		pool->mapper = mapper;
+		pool->grow = grow;
 		init_genrand(&pool->mersenne, seed);
 		pthread_create(&pool->thread, NULL, _thread, pool);
 	}
 
+	// init/start grower thread
+	pool_t grower = {
+		.mapper = mapper
+	};
+	if(grow)
+	{
+		pthread_create(&grower.thread, NULL, _grower, &grower);
+	}
+
 	// signal rolling
 	atomic_store_explicit(&rolling, true, memory_order_relaxed);
 
@@ -287,6 +400,29 @@ main(int argc, char **argv)
 		pthread_join(pool->thread, NULL);
 	}
 
+	// stop grower thread
+	atomic_store_explicit(&done, true, memory_order_relaxed);
+	if(grow)
+	{
+		pthread_join(grower.thread, NULL);
+	}
+
+	// URIDs must have stayed stable across table migrations
+	{
+		LV2_URID_Map *map = mapper_get_map(mapper);
+		MT mersenne;
+		char uri [MAX_URI_LEN];
+
+		init_genrand(&mersenne, seed);
+
+		for(uint32_t i = 0; i < MAX_ITEMS/2; i++)
+		{
+			_uri_gen(&mersenne, uri);
+
+			assert(map->map(map->handle, uri) == atomic_load(&urids[i]));
+		}
+	}
+
 	// query usage
 	const uint32_t usage = mapper_get_usage(mapper);
 	assert(usage == MAX_ITEMS/2 + (nstats - 1));
@@ -302,18 +438,19 @@ main(int argc, char **argv)
 	// check whether combined allocations and frees match usage
 	const uint32_t tot_nalloc = rt_nalloc + nrt_nalloc;
 	const uint32_t tot_nfree = rt_nfree + nrt_nfree;
-	assert(tot_nalloc - tot_nfree == usage);
+	assert(tot_nalloc - tot_nfree == usage - (nstats - 1)); // static URIs are not cloned
 
 	// distribution of fills/gaps
+	mapper_table_t *table = (mapper_table_t *)atomic_load(&mapper->table);
 	uint32_t fill_min = UINT32_MAX;
 	uint32_t fill_max = 0;
 	double fill_avg = 0;
 	uint32_t fill_n = 0;
-	for(uint32_t idx = 0, from = 0; idx < mapper->nitems; idx++)
+	for(uint32_t idx = 0, from = 0; idx < table->nitems; idx++)
 	{
-		mapper_item_t *item = &mapper->items[idx];
+		atomic_uint *item = &table->items[idx];
 
-		if(atomic_load_explicit(&item->val, memory_order_relaxed) == 0) // a gap is starting
+		if(atomic_load_explicit(item, memory_order_relaxed) == 0) // a gap is starting
 		{
 			const uint32_t fill = idx - from; // length of preceding fill
 
@@ -341,11 +478,11 @@ main(int argc, char **argv)
 	fill_avg /= fill_n;
 
 	double fill_dev = 0;
-	for(uint32_t idx = 0, from = 0; idx < mapper->nitems; idx++)
+	for(uint32_t idx = 0, from = 0; idx < table->nitems; idx++)
 	{
-		mapper_item_t *item = &mapper->items[idx];
+		atomic_uint *item = &table->items[idx];
 
-		if(atomic_load_explicit(&item->val, memory_order_relaxed) == 0) // a gap is starting
+		if(atomic_load_explicit(item, memory_order_relaxed) == 0) // a gap is starting
 		{
 			const uint32_t fill = idx - from; // length of preceding fill
 
@@ -362,6 +499,8 @@ main(int argc, char **argv)
 
 	fill_dev = sqrt(fill_dev / (fill_n - 1));
 
+	const uint32_t nitems_final = table->nitems;
+
 	// free mapper
 	mapper_free(mapper);
 
@@ -380,6 +519,7 @@ main(int argc, char **argv)
 	rtmem_free(rtmem);
 
 	fprintf(stderr,
+		"  items     : %"PRIu32"\n"
 		"  fill-min  : %"PRIu32"\n"
 		"  fill-max  : %"PRIu32"\n"
 		"  fill-avg  : %.2lf\n"
@@ -389,7 +529,7 @@ main(int argc, char **argv)
 		"  nrt-allocs: %"PRIu32"\n"
 		"  nrt-frees : %"PRIu32"\n"
 		"  collisions: %"PRIu32" (%.1f%% of total allocations -> +%.1f%% allocation overhead)\n",
-		fill_min, fill_max, fill_avg, fill_dev,
+		nitems_final, fill_min, fill_max, fill_avg, fill_dev,
 		rt_nalloc, rt_nfree, nrt_nalloc, nrt_nfree,
 		tot_nfree, 100.f * tot_nfree / tot_nalloc, 100.f * tot_nfree / usage);
 
@@ -24,6 +24,7 @@ extern "C" {
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <netatom.lv2/endian.h>
 
@@ -36,12 +37,21 @@ extern "C" {
 #	define NETATOM_API static
 #endif
 
+// slots in dictionary index, power of 2, filled up to 3/4
+#ifndef NETATOM_INDEX_SIZE
+#	define NETATOM_INDEX_SIZE 0x1000
+#endif
+
 typedef struct _netatom_t netatom_t;
 
 NETATOM_API uint8_t *
 netatom_serialize(netatom_t *netatom, LV2_Atom *atom, size_t size_rx,
 	size_t *size_tx);
 
+NETATOM_API uint8_t *
+netatom_serialize_to(netatom_t *netatom, const LV2_Atom *atom, uint8_t *buf_tx,
+	size_t size_tx, size_t *written);
+
 NETATOM_API const LV2_Atom *
 netatom_deserialize(netatom_t *netatom, uint8_t *buf_tx, size_t size_tx);
 
@@ -53,13 +63,23 @@ netatom_free(netatom_t *netatom);
 
 #ifdef NETATOM_IMPLEMENTATION
 
+#define NETATOM_INDEX_MASK (NETATOM_INDEX_SIZE - 1)
+#define NETATOM_INDEX_FILL (NETATOM_INDEX_SIZE / 4 * 3)
+
 typedef union _netatom_union_t netatom_union_t;
+typedef struct _netatom_slot_t netatom_slot_t;
 
 union _netatom_union_t {
 	LV2_Atom *atom;
 	uint8_t *buf;
 };
 
+struct _netatom_slot_t {
+	uint32_t urid;
+	uint32_t ref;
+	uint32_t gen; // slot is only valid for matching generation
+};
+
 struct _netatom_t {
 	bool swap;
 	LV2_URID_Unmap *unmap;
@@ -70,10 +90,45 @@ struct _netatom_t {
 		const uint8_t *cur;
 		const uint8_t *end;
 	} dict;
+	struct {
+		uint32_t gen;
+		uint32_t nitems;
+		netatom_slot_t slots [NETATOM_INDEX_SIZE];
+	} index;
 	uint32_t MIDI_MidiEvent;
 	bool overflow;
 };
 
+static inline void
+_netatom_index_reset(netatom_t *netatom)
+{
+	// invalidate all slots at once by bumping the generation
+	if(++netatom->index.gen == 0)
+	{
+		memset(netatom->index.slots, 0x0, sizeof(netatom->index.slots));
+		netatom->index.gen = 1;
+	}
+
+	netatom->index.nitems = 0;
+}
+
+static inline netatom_slot_t *
+_netatom_index_slot(netatom_t *netatom, uint32_t urid)
+{
+	uint32_t idx = (urid * 0x9e3779b1) & NETATOM_INDEX_MASK;
+
+	// linear probing, terminates as index is never filled beyond 3/4
+	for(uint32_t i = 0; i < NETATOM_INDEX_SIZE; i++, idx = (idx + 1) & NETATOM_INDEX_MASK)
+	{
+		netatom_slot_t *slot = &netatom->index.slots[idx];
+
+		if( (slot->gen != netatom->index.gen) || (slot->urid == urid) )
+			return slot; // empty or matching slot
+	}
+
+	return NULL;
+}
+
 static inline void
 _netatom_ser_uri(netatom_t *netatom, uint32_t *urid, const char *uri)
 {
@@ -82,17 +137,11 @@ _netatom_ser_uri(netatom_t *netatom, uint32_t *urid, const char *uri)
 
 	// look for matching URID in dictionary
 	uint32_t match = 0;
+	netatom_slot_t *slot = _netatom_index_slot(netatom, *urid);
 
-	for(netatom_union_t ptr = { .buf = netatom->dict.buf };
-		ptr.buf < netatom->dict.cur;
-		ptr.buf += lv2_atom_pad_size(lv2_atom_total_size(ptr.atom)))
-	{
-		if(ptr.atom->type == *urid)
-		{
-			match = ptr.buf - netatom->dict.buf + 1;
-			break;
-		}
-	}
+	// once the index is full, new URIDs get duplicate dictionary entries
+	if(slot && (slot->gen == netatom->index.gen))
+		match = slot->ref;
 
 	if(match) // use already matched URI in dictionary
 	{
@@ -118,7 +167,15 @@ _netatom_ser_uri(netatom_t *netatom, uint32_t *urid, const char *uri)
 				LV2_Atom *atom = (LV2_Atom *)netatom->dict.cur;
 				atom->size = size;
 				atom->type = *urid;
-				strncpy(LV2_ATOM_BODY(atom), uri, tot_size); // automatic padding
+				strncpy(LV2_ATOM_BODY(atom), uri, tot_size - sizeof(LV2_Atom)); // automatic padding
+
+				if(slot && (netatom->index.nitems < NETATOM_INDEX_FILL))
+				{
+					slot->urid = *urid;
+					slot->ref = ref;
+					slot->gen = netatom->index.gen;
+					netatom->index.nitems += 1;
+				}
 
 				*urid = ref;
 				netatom->dict.cur += tot_size;
@@ -452,11 +509,15 @@ netatom_serialize(netatom_t *netatom, LV2_Atom *atom, size_t size_rx,
 	uint8_t *buf_rx = (uint8_t *)atom;
 	const uint32_t tot_size = lv2_atom_pad_size(lv2_atom_total_size(atom));
 
+	if(tot_size > size_rx)
+		return NULL;
+
 	netatom->dict.buf = buf_rx + tot_size;
 	netatom->dict.cur = netatom->dict.buf;
 	netatom->dict.end = buf_rx + size_rx;
 
 	netatom->overflow = false;
+	_netatom_index_reset(netatom);
 
 	_netatom_ser_atom(netatom, atom);
 	_netatom_ser_dict(netatom);
@@ -473,6 +534,25 @@ netatom_serialize(netatom_t *netatom, LV2_Atom *atom, size_t size_rx,
 	return buf_rx;
 }
 
+NETATOM_API uint8_t *
+netatom_serialize_to(netatom_t *netatom, const LV2_Atom *atom, uint8_t *buf_tx,
+	size_t size_tx, size_t *written)
+{
+	if(!netatom || !atom || !buf_tx)
+		return NULL;
+
+	const uint32_t tot_size = lv2_atom_total_size(atom);
+
+	if(lv2_atom_pad_size(tot_size) > size_tx)
+		return NULL;
+
+	// encode straight into the destination, e.g. a ring buffer reservation
+	memcpy(buf_tx, atom, tot_size);
+	memset(buf_tx + tot_size, 0x0, lv2_atom_pad_size(tot_size) - tot_size);
+
+	return netatom_serialize(netatom, (LV2_Atom *)buf_tx, size_tx, written);
+}
+
 NETATOM_API const LV2_Atom *
 netatom_deserialize(netatom_t *netatom, uint8_t *buf_tx, size_t size_tx)
 {
@@ -506,6 +586,8 @@ netatom_new(LV2_URID_Map *map, LV2_URID_Unmap *unmap, bool swap)
 	if(!netatom)
 		return NULL;
 
+	netatom->index.gen = 1; // slots are zeroed, thus invalid
+
 	netatom->swap = swap;
 	netatom->map = map;
 	netatom->unmap = unmap;
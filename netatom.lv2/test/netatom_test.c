@@ -16,13 +16,16 @@
  */
 
 #include <time.h>
+#include <assert.h>
+#include <inttypes.h>
 #include <sratom/sratom.h>
 
 #define NETATOM_IMPLEMENTATION
 #include <netatom.lv2/netatom.h>
 
-#define MAX_URIDS 2048
+#define MAX_URIDS 8192
 #define MAX_BUF 4092
+#define MAX_LARGE 0x80000
 
 typedef struct _urid_t urid_t;
 typedef struct _store_t store_t;
@@ -63,11 +66,9 @@ _unmap(LV2_URID_Unmap_Handle instance, LV2_URID urid)
 {
 	store_t *handle = instance;
 
-	for(urid_t *itm=handle->urids; itm->urid; itm++)
-	{
-		if(itm->urid == urid)
-			return itm->uri;
-	}
+	// URIDs are handed out sequentially
+	if( (urid > 0) && (urid <= handle->urid) )
+		return handle->urids[urid - 1].uri;
 
 	// not found
 	return NULL;
@@ -119,6 +120,89 @@ _netatom_test(LV2_URID_Map *map, LV2_URID_Unmap *unmap, bool swap,
 	netatom_free(netatom);
 }
 
+static void
+_netatom_test_to(LV2_URID_Map *map, LV2_URID_Unmap *unmap, bool swap,
+	const LV2_Atom *atom, unsigned iterations)
+{
+	static uint8_t buf [MAX_BUF];
+	netatom_t *netatom = netatom_new(map, unmap, swap);
+	assert(netatom);
+
+	for(unsigned i = 0; i < iterations; i++)
+	{
+		size_t size_tx = 0;
+		uint8_t *buf_tx = netatom_serialize_to(netatom, atom, buf, MAX_BUF, &size_tx);
+		assert(buf_tx == buf);
+
+		const LV2_Atom *atom_rx = netatom_deserialize(netatom, buf_tx, size_tx);
+		assert(atom_rx);
+
+		const uint32_t size_rx = lv2_atom_total_size(atom_rx);
+
+		assert(size_rx == lv2_atom_total_size(atom));
+		assert(memcmp(atom, atom_rx, size_rx) == 0);
+	}
+
+	// too small a destination must fail gracefully
+	assert(netatom_serialize_to(netatom, atom, buf, lv2_atom_total_size(atom) / 2, NULL) == NULL);
+
+	netatom_free(netatom);
+}
+
+static void
+_netatom_bench(LV2_URID_Map *map, LV2_URID_Unmap *unmap, bool swap,
+	uint32_t nkeys, unsigned iterations)
+{
+	uint8_t *src = calloc(1, MAX_LARGE);
+	uint8_t *dst = calloc(1, MAX_LARGE);
+	assert(src && dst);
+
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, map);
+	lv2_atom_forge_set_buffer(&forge, src, MAX_LARGE);
+
+	// patch:Put-like state dump with distinct keys and URID values
+	char tmp [64];
+	LV2_Atom_Forge_Frame obj_frame;
+	lv2_atom_forge_object(&forge, &obj_frame, 0, map->map(map->handle, "urn:netatom:test#Put"));
+	for(uint32_t k = 0; k < nkeys; k++)
+	{
+		snprintf(tmp, sizeof(tmp), "urn:netatom:bench#key%"PRIu32, k);
+		lv2_atom_forge_key(&forge, map->map(map->handle, tmp));
+		snprintf(tmp, sizeof(tmp), "urn:netatom:bench#val%"PRIu32, k);
+		lv2_atom_forge_urid(&forge, map->map(map->handle, tmp));
+	}
+	lv2_atom_forge_pop(&forge, &obj_frame);
+
+	const LV2_Atom *atom = (const LV2_Atom *)src;
+	assert(lv2_atom_total_size(atom) > nkeys * sizeof(LV2_Atom_Property_Body));
+	netatom_t *netatom = netatom_new(map, unmap, swap);
+	assert(netatom);
+
+	size_t size_tx = 0;
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(unsigned i = 0; i < iterations; i++)
+	{
+		uint8_t *buf_tx = netatom_serialize_to(netatom, atom, dst, MAX_LARGE, &size_tx);
+		assert(buf_tx);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	const double d = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+	fprintf(stderr, "%5"PRIu32" keys, %7"PRIu32" -> %7zu bytes, %9.3lf us/msg\n",
+		nkeys, lv2_atom_total_size(atom), size_tx, d * 1e6 / iterations);
+
+	const LV2_Atom *atom_rx = netatom_deserialize(netatom, dst, size_tx);
+	assert(atom_rx);
+	assert(lv2_atom_total_size(atom_rx) == lv2_atom_total_size(atom));
+	assert(memcmp(atom, atom_rx, lv2_atom_total_size(atom)) == 0);
+
+	netatom_free(netatom);
+	free(dst);
+	free(src);
+}
+
 static void
 _sratom_test(LV2_URID_Map *map, LV2_URID_Unmap *unmap, bool pretty,
 	const LV2_Atom *atom, unsigned iterations)
@@ -283,6 +367,19 @@ main(int argc, char **argv)
 	fprintf(stderr, "%lf s, %lf s, x %lf\n", d1, d2, d2/d1);
 #endif
 
+	_netatom_test_to(&map, &unmap, false, &un.atom, iterations);
+	_netatom_test_to(&map, &unmap, true, &un.atom, iterations);
+
+#if !defined(__APPLE__) && !defined(_WIN32)
+	// large messages, the last one exceeds the dictionary index
+	const unsigned bench_iterations = iterations / 10 + 1;
+	_netatom_bench(&map, &unmap, false, 16, bench_iterations);
+	_netatom_bench(&map, &unmap, false, 256, bench_iterations);
+	_netatom_bench(&map, &unmap, false, 1024, bench_iterations);
+	_netatom_bench(&map, &unmap, true, 1024, bench_iterations);
+	_netatom_bench(&map, &unmap, false, 2048, bench_iterations);
+#endif
+
 	_freemap(&handle);
 
 	return 0;
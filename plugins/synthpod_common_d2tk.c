@@ -71,6 +71,7 @@ struct _entry_t {
 struct _status_t {
 	int32_t cpus_available;
 	int32_t cpus_used;
+	int64_t buffer_saved;
 	int32_t period_size;
 	int32_t num_periods;
 	float sample_rate;
@@ -83,6 +84,7 @@ struct _prof_t {
 	float min;
 	float avg;
 	float max;
+	float p999; // cumulative 99.9th percentile
 };
 
 struct _mod_t {
@@ -176,16 +178,17 @@ _status_labels_update(plughandle_t *handle)
 		stat_label_t *label = &handle->status.label[1];
 
 		label->len = snprintf(label->buf, sizeof(label->buf),
-			"DSP: %04.1f | %04.1f | %04.1f %%",
-			handle->prof.min, handle->prof.avg, handle->prof.max);
+			"DSP: %04.1f | %04.1f | %04.1f | %04.1f %%",
+			handle->prof.min, handle->prof.avg, handle->prof.max, handle->prof.p999);
 	}
 
 	{
 		stat_label_t *label = &handle->status.label[2];
 
 		label->len = snprintf(label->buf, sizeof(label->buf),
-			"CPU: %"PRIi32" / %"PRIi32,
-			handle->status.cpus_used, handle->status.cpus_available);
+			"CPU: %"PRIi32" / %"PRIi32" | BUF: -%"PRIi64" KiB",
+			handle->status.cpus_used, handle->status.cpus_available,
+			handle->status.buffer_saved / 1024);
 	}
 }
 
@@ -1031,6 +1034,22 @@ cleanup(LV2UI_Handle instance)
 	free(handle);
 }
 
+// number of float elements in a percentiles vector, 0 for other vectors
+static inline uint32_t
+_percentiles_num(plughandle_t *handle, const LV2_Atom *value)
+{
+	const LV2_Atom_Vector *vec = (const LV2_Atom_Vector *)value;
+
+	if(  (value->size < sizeof(LV2_Atom_Vector_Body))
+		|| (vec->body.child_type != handle->forge.Float)
+		|| (vec->body.child_size != sizeof(float)) )
+	{
+		return 0;
+	}
+
+	return (value->size - sizeof(LV2_Atom_Vector_Body)) / sizeof(float);
+}
+
 static inline mod_t *
 _mod_find_by_urn(plughandle_t *handle, LV2_URID urn, bool claim)
 {
@@ -1297,6 +1316,22 @@ _port_event_set(plughandle_t *handle, const LV2_Atom_Object *obj)
 	{
 		//FIXME
 	}
+	else if( (prop == handle->regs.synthpod.dsp_percentiles.urid)
+		&& (value->type == handle->forge.Vector)
+		&& (_percentiles_num(handle, value) >= 3) )
+	{
+		const float *f32 = LV2_ATOM_CONTENTS_CONST(LV2_Atom_Vector, value);
+
+		handle->prof.p999 = f32[2];
+
+		_status_labels_update(handle);
+	}
+	else if( (prop == handle->regs.synthpod.module_percentiles.urid)
+		&& (value->type == handle->forge.Vector)
+		&& subj )
+	{
+		//FIXME
+	}
 	else if( (prop == handle->regs.synthpod.graph_position_x.urid)
 		&& (value->type == handle->forge.Float) )
 	{
@@ -1324,6 +1359,13 @@ _port_event_set(plughandle_t *handle, const LV2_Atom_Object *obj)
 
 		_status_labels_update(handle);
 	}
+	else if( (prop == handle->regs.synthpod.buffer_saved.urid)
+		&& (value->type == handle->forge.Long) )
+	{
+		handle->status.buffer_saved = ATOM_LONG_VAL(value);
+
+		_status_labels_update(handle);
+	}
 	else if( (prop == handle->regs.synthpod.cpus_available.urid)
 		&& (value->type == handle->forge.Int) )
 	{
@@ -1710,6 +1752,14 @@ _init(plughandle_t *handle)
 		_message_write(handle);
 	}
 
+	// patch:Get [patch:property spod:bufferBytesSaved]
+	if(  _message_request(handle)
+		&& synthpod_patcher_get(&handle->regs, &handle->forge,
+			0, 0, handle->regs.synthpod.buffer_saved.urid) )
+	{
+		_message_write(handle);
+	}
+
 	// patch:Get [patch:property spod:periodSize]
 	if(  _message_request(handle)
 		&& synthpod_patcher_get(&handle->regs, &handle->forge,
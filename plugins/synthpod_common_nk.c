@@ -17,6 +17,7 @@
 
 #include <synthpod_lv2.h>
 #include <synthpod_patcher.h>
+#include <synthpod_index.h>
 #include <synthpod_common.h>
 
 #include "lv2/lv2plug.in/ns/ext/urid/urid.h"
@@ -261,6 +262,8 @@ struct _prof_t {
 	float min;
 	float avg;
 	float max;
+	float p999; // cumulative 99.9th percentile
+	float miss; // cumulative deadline-miss ratio
 };
 
 struct _mod_t {
@@ -376,6 +379,7 @@ struct _pset_preset_t {
 
 struct _plughandle_t {
 	LilvWorld *world;
+	index_t index;
 	LilvNodes *bundles;
 
 	void *dsp_instance;
@@ -451,7 +455,7 @@ struct _plughandle_t {
 	property_selector_search_t property_search_selector;
 
 	hash_t bundle_matches;
-	hash_t plugin_matches;
+	hash_t plugin_matches; // index_plug_t
 	hash_t preset_matches;
 	hash_t port_matches;
 	hash_t param_matches;
@@ -505,6 +509,7 @@ struct _plughandle_t {
 	prof_t prof;
 	int32_t cpus_available;
 	int32_t cpus_used;
+	int64_t buffer_saved;
 	int32_t period_size;
 	int32_t num_periods;
 	float sample_rate;
@@ -1802,6 +1807,22 @@ _mod_dynam_find_by_property(mod_t *mod, LV2_URID property)
 	return NULL;
 }
 
+// number of float elements in a percentiles vector, 0 for other vectors
+static inline uint32_t
+_percentiles_num(plughandle_t *handle, const LV2_Atom *value)
+{
+	const LV2_Atom_Vector *vec = (const LV2_Atom_Vector *)value;
+
+	if(  (value->size < sizeof(LV2_Atom_Vector_Body))
+		|| (vec->body.child_type != handle->forge.Float)
+		|| (vec->body.child_size != sizeof(float)) )
+	{
+		return 0;
+	}
+
+	return (value->size - sizeof(LV2_Atom_Vector_Body)) / sizeof(float);
+}
+
 static mod_t *
 _mod_find_by_urn(plughandle_t *handle, LV2_URID urn)
 {
@@ -3489,11 +3510,9 @@ _sort_port_name(const void *a, const void *b)
 }
 
 static void
-_patch_mod_add(plughandle_t *handle, const LilvPlugin *plug)
+_patch_mod_add(plughandle_t *handle, const char *uri)
 {
 	DBG;
-	const LilvNode *node= lilv_plugin_get_uri(plug);
-	const char *uri = lilv_node_as_string(node);
 	const LV2_URID urid = handle->map->map(handle->map->handle, uri);
 
 	if(  _message_request(handle)
@@ -4565,60 +4584,73 @@ static int
 _sort_plugin_name(const void *a, const void *b)
 {
 	DBG;
-	const LilvPlugin *plug_a = *(const LilvPlugin **)a;
-	const LilvPlugin *plug_b = *(const LilvPlugin **)b;
+	const index_plug_t *plug_a = *(const index_plug_t **)a;
+	const index_plug_t *plug_b = *(const index_plug_t **)b;
 
-	const char *name_a = NULL;
-	const char *name_b = NULL;
-
-	LilvNode *node_a = lilv_plugin_get_name(plug_a);
-	LilvNode *node_b = lilv_plugin_get_name(plug_b);
-
-	if(node_a)
-		name_a = lilv_node_as_string(node_a);
-	if(node_b)
-		name_b = lilv_node_as_string(node_b);
+	const char *name_a = plug_a->name;
+	const char *name_b = plug_b->name;
 
 	const int ret = name_a && name_b
 		? strcasenumcmp(name_a, name_b)
 		: 0;
 
-	if(node_a)
-		lilv_node_free(node_a);
-	if(node_b)
-		lilv_node_free(node_b);
-
 	return ret;
 }
 
-static void
-_discover_bundles(plughandle_t *handle)
+// loads bundles of plugin on demand, unknown plugins trigger a rebuild of index
+static const LilvPlugin *
+_plugin_load(plughandle_t *handle, const char *uri)
 {
 	DBG;
+	LilvNode *uri_node = lilv_new_uri(handle->world, uri);
+	if(!uri_node)
+		return NULL;
+
 	const LilvPlugins *plugs = lilv_world_get_all_plugins(handle->world);
-	if(!plugs)
-		return;
+	const LilvPlugin *plug = lilv_plugins_get_by_uri(plugs, uri_node);
+	const index_plug_t *index_plug = synthpod_index_plug_get(&handle->index, uri);
 
-	LilvNode *self_uri = lilv_new_uri(handle->world, "http://open-music-kontrollers.ch/lv2/synthpod#stereo");
-	if(self_uri)
+	if(index_plug)
 	{
-		const LilvPlugin *plug = lilv_plugins_get_by_uri(plugs, self_uri);
-		if(plug)
+		if(!plug)
 		{
-			handle->bundles = lilv_plugin_get_related(plug, handle->node.pset_Preset);
+			synthpod_index_plug_load(&handle->index, handle->world, index_plug);
+			plug = lilv_plugins_get_by_uri(plugs, uri_node);
+		}
+
+		synthpod_index_plug_presets_load(&handle->index, handle->world, index_plug);
+	}
+	else if(!plug && handle->index.lazy) // installed after index was built
+	{
+		_hash_free(&handle->plugin_matches); // points into index
+		synthpod_index_rebuild(&handle->index, handle->world, getenv("HOME"));
+		plug = lilv_plugins_get_by_uri(plugs, uri_node);
+	}
 
-			if(handle->bundles)
+	lilv_node_free(uri_node);
+
+	return plug;
+}
+
+static void
+_discover_bundles(plughandle_t *handle)
+{
+	DBG;
+	// loads preset bundles of synthpod from index
+	const LilvPlugin *plug = _plugin_load(handle, SYNTHPOD_STEREO_URI);
+	if(plug)
+	{
+		handle->bundles = lilv_plugin_get_related(plug, handle->node.pset_Preset);
+
+		if(handle->bundles)
+		{
+			LILV_FOREACH(nodes, itr, handle->bundles)
 			{
-				LILV_FOREACH(nodes, itr, handle->bundles)
-				{
-					const LilvNode *bundle = lilv_nodes_get(handle->bundles, itr);
+				const LilvNode *bundle = lilv_nodes_get(handle->bundles, itr);
 
-					lilv_world_load_resource(handle->world, bundle);
-				}
+				lilv_world_load_resource(handle->world, bundle);
 			}
 		}
-
-		lilv_node_free(self_uri);
 	}
 }
 
@@ -4645,106 +4677,57 @@ _refresh_main_plugin_list(plughandle_t *handle)
 	DBG;
 	_hash_free(&handle->plugin_matches);
 
-	const LilvPlugins *plugs = lilv_world_get_all_plugins(handle->world);
-
-	LilvNode *p = NULL;
-	if(handle->plugin_search_selector == PLUGIN_SELECTOR_SEARCH_COMMENT)
-		p = handle->node.rdfs_comment;
-	else if(handle->plugin_search_selector == PLUGIN_SELECTOR_SEARCH_PROJECT)
-		p = handle->node.doap_name;
+	const char *search = _textedit_const(&handle->plugin_search_edit);
+	const bool search_all = _textedit_len(&handle->plugin_search_edit) == 0;
 
-	bool selector_visible = false;
-	LILV_FOREACH(plugins, i, plugs)
+	for(unsigned i = 0; i < handle->index.num_plugs; i++)
 	{
-		const LilvPlugin *plug = lilv_plugins_get(plugs, i);
-		const char *plug_uri = lilv_node_as_uri(lilv_plugin_get_uri(plug));
+		const index_plug_t *plug = &handle->index.plugs[i];
 
-		if(  !strcmp(plug_uri, SYNTHPOD_PREFIX"sink")
-			|| !strcmp(plug_uri, SYNTHPOD_PREFIX"source") )
+		if(  !strcmp(plug->uri, SYNTHPOD_PREFIX"sink")
+			|| !strcmp(plug->uri, SYNTHPOD_PREFIX"source") )
 		{
 			continue;
 		}
 
-		LilvNode *name_node = lilv_plugin_get_name(plug);
-		if(name_node)
+		if(!plug->name)
+			continue;
+
+		bool visible = search_all;
+
+		if(!visible)
 		{
-			const char *name_str = lilv_node_as_string(name_node);
-			bool visible = _textedit_len(&handle->plugin_search_edit) == 0;
+			const char *label = NULL;
 
-			if(!visible)
+			switch(handle->plugin_search_selector)
 			{
-				switch(handle->plugin_search_selector)
-				{
-					case PLUGIN_SELECTOR_SEARCH_NAME:
-					{
-						if(strcasestr(name_str, _textedit_const(&handle->plugin_search_edit)))
-							visible = true;
-					} break;
-					case PLUGIN_SELECTOR_SEARCH_COMMENT:
-					{
-						LilvNodes *label_nodes = p ? lilv_plugin_get_value(plug, p) : NULL;
-						if(label_nodes)
-						{
-							const LilvNode *label_node = lilv_nodes_size(label_nodes)
-								? lilv_nodes_get_first(label_nodes) : NULL;
-							if(label_node)
-							{
-								if(strcasestr(lilv_node_as_string(label_node), _textedit_const(&handle->plugin_search_edit)))
-									visible = true;
-							}
-							lilv_nodes_free(label_nodes);
-						}
-					} break;
-					case PLUGIN_SELECTOR_SEARCH_AUTHOR:
-					{
-						LilvNode *author_node = lilv_plugin_get_author_name(plug);
-						if(author_node)
-						{
-							if(strcasestr(lilv_node_as_string(author_node), _textedit_const(&handle->plugin_search_edit)))
-								visible = true;
-							lilv_node_free(author_node);
-						}
-					} break;
-					case PLUGIN_SELECTOR_SEARCH_CLASS:
-					{
-						const LilvPluginClass *class = lilv_plugin_get_class(plug);
-						if(class)
-						{
-							const LilvNode *label_node = lilv_plugin_class_get_label(class);
-							if(label_node)
-							{
-								if(strcasestr(lilv_node_as_string(label_node), _textedit_const(&handle->plugin_search_edit)))
-									visible = true;
-							}
-						}
-					} break;
-					case PLUGIN_SELECTOR_SEARCH_PROJECT:
-					{
-						LilvNode *project = lilv_plugin_get_project(plug);
-						if(project)
-						{
-							LilvNode *label_node = p ? lilv_world_get(handle->world, lilv_plugin_get_uri(plug), p, NULL) : NULL;
-							if(label_node)
-							{
-								if(strcasestr(lilv_node_as_string(label_node), _textedit_const(&handle->plugin_search_edit)))
-									visible = true;
-								lilv_node_free(label_node);
-							}
-							lilv_node_free(project);
-						}
-					} break;
+				case PLUGIN_SELECTOR_SEARCH_NAME:
+					label = plug->name;
+					break;
+				case PLUGIN_SELECTOR_SEARCH_COMMENT:
+					label = plug->comment;
+					break;
+				case PLUGIN_SELECTOR_SEARCH_AUTHOR:
+					label = plug->author;
+					break;
+				case PLUGIN_SELECTOR_SEARCH_CLASS:
+					label = plug->class_label;
+					break;
+				case PLUGIN_SELECTOR_SEARCH_PROJECT:
+					label = plug->project;
+					break;
 
-					case PLUGIN_SELECTOR_SEARCH_MAX:
-						break;
-				}
+				case PLUGIN_SELECTOR_SEARCH_MAX:
+					break;
 			}
 
-			if(visible)
-			{
-				_hash_add(&handle->plugin_matches, (void *)plug);
-			}
+			if(label && strcasestr(label, search))
+				visible = true;
+		}
 
-			lilv_node_free(name_node);
+		if(visible)
+		{
+			_hash_add(&handle->plugin_matches, (void *)plug);
 		}
 	}
 
@@ -4759,32 +4742,22 @@ _expose_main_plugin_list(plughandle_t *handle, struct nk_context *ctx,
 	if(_hash_empty(&handle->plugin_matches) || find_matches)
 		_refresh_main_plugin_list(handle);
 
-	const LilvPlugins *plugs = lilv_world_get_all_plugins(handle->world);
-
 	int count = 0;
 	HASH_FOREACH(&handle->plugin_matches, itr)
 	{
-		const LilvPlugin *plug = *itr;
+		const index_plug_t *plug = *itr;
 		if(plug)
 		{
-			LilvNode *name_node = lilv_plugin_get_name(plug);
-			if(name_node)
-			{
-				const char *name_str = lilv_node_as_string(name_node);
-
-				nk_style_push_style_item(ctx, &ctx->style.selectable.normal, (count++ % 2)
-					? nk_style_item_color(nk_rgb(40, 40, 40))
-					: nk_style_item_color(nk_rgb(45, 45, 45))); // NK_COLOR_WINDOW
-
-				if(nk_select_label(ctx, name_str, NK_TEXT_LEFT, nk_false))
-				{
-					_patch_mod_add(handle, plug);
-				}
-
-				nk_style_pop_style_item(ctx);
+			nk_style_push_style_item(ctx, &ctx->style.selectable.normal, (count++ % 2)
+				? nk_style_item_color(nk_rgb(40, 40, 40))
+				: nk_style_item_color(nk_rgb(45, 45, 45))); // NK_COLOR_WINDOW
 
-				lilv_node_free(name_node);
+			if(nk_select_label(ctx, plug->name, NK_TEXT_LEFT, nk_false))
+			{
+				_patch_mod_add(handle, plug->uri);
 			}
+
+			nk_style_pop_style_item(ctx);
 		}
 	}
 }
@@ -6984,8 +6957,8 @@ _expose_mod(plughandle_t *handle, struct nk_context *ctx, struct nk_rect space_b
 		//FIXME can this be solved more elegantly
 		{
 			char load [32];
-			snprintf(load, sizeof(load), "%.1f | %.1f | %.1f %%",
-				mod->prof.min, mod->prof.avg, mod->prof.max);
+			snprintf(load, sizeof(load), "%.1f | %.1f | %.1f | %.1f %%",
+				mod->prof.min, mod->prof.avg, mod->prof.max, mod->prof.p999);
 
 			const size_t load_len= strlen(load);
 			const float fw = font->width(font->userdata, font->height, load, load_len);
@@ -8173,11 +8146,12 @@ _expose_main_footer(plughandle_t *handle, struct nk_context *ctx, float dy)
 		nk_labelf(ctx, NK_TEXT_LEFT, "DEV: %"PRIi32" x %"PRIi32" @ %.1f kHz (%.2f ms)",
 			handle->period_size, handle->num_periods, khz, ms);
 
-		nk_labelf(ctx, NK_TEXT_LEFT, "DSP: %.1f | %.1f | %.1f %%",
-			handle->prof.min, handle->prof.avg, handle->prof.max);
+		nk_labelf(ctx, NK_TEXT_LEFT, "DSP: %.1f | %.1f | %.1f | %.1f %% (%.2f %% miss)",
+			handle->prof.min, handle->prof.avg, handle->prof.max, handle->prof.p999,
+			handle->prof.miss);
 
-		nk_labelf(ctx, NK_TEXT_LEFT, "CPU: %"PRIi32" / %"PRIi32,
-			handle->cpus_used, handle->cpus_available);
+		nk_labelf(ctx, NK_TEXT_LEFT, "CPU: %"PRIi32" / %"PRIi32" | BUF: -%"PRIi64" KiB",
+			handle->cpus_used, handle->cpus_available, handle->buffer_saved / 1024);
 
 		if(nk_widget_is_mouse_clicked(ctx, NK_BUTTON_LEFT))
 			handle->t0 = t1;
@@ -8211,7 +8185,7 @@ _init(plughandle_t *handle)
 		lilv_world_set_option(handle->world, LILV_OPTION_DYN_MANIFEST, node_false);
 		lilv_node_free(node_false);
 	}
-	lilv_world_load_all(handle->world);
+	synthpod_index_init(&handle->index, handle->world, getenv("HOME")); // loads world in full if index is stale
 	LilvNode *synthpod_bundle = lilv_new_file_uri(handle->world, NULL, SYNTHPOD_BUNDLE_DIR);
 	if(synthpod_bundle)
 	{
@@ -8279,6 +8253,14 @@ _init(plughandle_t *handle)
 		_message_write(handle);
 	}
 
+	// patch:Get [patch:property spod:bufferBytesSaved]
+	if(  _message_request(handle)
+		&& synthpod_patcher_get(&handle->regs, &handle->forge,
+			0, 0, handle->regs.synthpod.buffer_saved.urid) )
+	{
+		_message_write(handle);
+	}
+
 	// patch:Get [patch:property spod:periodSize]
 	if(  _message_request(handle)
 		&& synthpod_patcher_get(&handle->regs, &handle->forge,
@@ -8365,6 +8347,7 @@ _deinit(plughandle_t *handle)
 		_undiscover_bundles(handle);
 
 		lilv_world_free(handle->world);
+		synthpod_index_deinit(&handle->index);
 	}
 }
 
@@ -9194,6 +9177,32 @@ port_event(LV2UI_Handle instance, uint32_t port_index, uint32_t size,
 								nk_pugl_post_redisplay(&handle->win);
 							}
 						}
+						else if( (prop == handle->regs.synthpod.dsp_percentiles.urid)
+							&& (value->type == handle->forge.Vector)
+							&& (_percentiles_num(handle, value) >= 6) )
+						{
+							const float *f32 = LV2_ATOM_CONTENTS_CONST(LV2_Atom_Vector, value);
+
+							handle->prof.p999 = f32[2];
+							handle->prof.miss = f32[5];
+
+							nk_pugl_post_redisplay(&handle->win);
+						}
+						else if( (prop == handle->regs.synthpod.module_percentiles.urid)
+							&& (value->type == handle->forge.Vector)
+							&& (_percentiles_num(handle, value) >= 3)
+							&& subj )
+						{
+							const float *f32 = LV2_ATOM_CONTENTS_CONST(LV2_Atom_Vector, value);
+
+							mod_t *mod = _mod_find_by_urn(handle, subj);
+							if(mod)
+							{
+								mod->prof.p999 = f32[2];
+
+								nk_pugl_post_redisplay(&handle->win);
+							}
+						}
 						else if( (prop == handle->regs.ui.instance_access.urid)
 							&& (value->type == handle->forge.Long)
 							&& subj )
@@ -9251,6 +9260,15 @@ port_event(LV2UI_Handle instance, uint32_t port_index, uint32_t size,
 
 							nk_pugl_post_redisplay(&handle->win);
 						}
+						else if( (prop == handle->regs.synthpod.buffer_saved.urid)
+							&& (value->type == handle->forge.Long) )
+						{
+							const LV2_Atom_Long *buffer_saved = (const LV2_Atom_Long *)value;
+
+							handle->buffer_saved = buffer_saved->body;
+
+							nk_pugl_post_redisplay(&handle->win);
+						}
 						else if( (prop == handle->regs.synthpod.cpus_available.urid)
 							&& (value->type == handle->forge.Int) )
 						{
@@ -9361,15 +9379,7 @@ port_event(LV2UI_Handle instance, uint32_t port_index, uint32_t size,
 						{
 							if(uri)
 							{
-								LilvNode *uri_node = lilv_new_uri(handle->world, uri);
-								const LilvPlugin *plug = NULL;
-
-								if(uri_node)
-								{
-									const LilvPlugins *plugs = lilv_world_get_all_plugins(handle->world);
-									plug = lilv_plugins_get_by_uri(plugs, uri_node);
-									lilv_node_free(uri_node);
-								}
+								const LilvPlugin *plug = _plugin_load(handle, uri);
 
 								if(plug)
 									_mod_init(handle, mod, plug);
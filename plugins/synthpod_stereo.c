@@ -380,6 +380,10 @@ instantiate(const LV2_Descriptor* descriptor, double rate,
 	handle->driver.osc_sched = NULL;
 	handle->driver.features = 0;
 	handle->driver.num_slaves = 0;
+	handle->driver.slave_spin = 0;
+	handle->driver.num_workers = 0; // one per core
+	handle->driver.trace_path = NULL;
+	handle->driver.stats_path = NULL;
 	handle->driver.bad_plugins = false; //FIXME
 
 	const LilvWorld *world = NULL;
@@ -18,6 +18,8 @@
 #ifndef _SANDBOX_IO_H
 #define _SANDBOX_IO_H
 
+#include <stdlib.h>
+#include <stdbool.h>
 #include <inttypes.h>
 #include <semaphore.h>
 #include <sys/mman.h>
@@ -25,15 +27,22 @@
 #include <fcntl.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
-#define NETATOM_IMPLEMENTATION
-#include <netatom.lv2/netatom.h>
+#if defined(__linux__)
+#	include <limits.h>
+#	include <unistd.h>
+#	include <linux/futex.h>
+#	include <sys/syscall.h>
+#endif
 
 #include <varchunk.h>
 
 #include <lv2/lv2plug.in/ns/lv2core/lv2.h>
 #include <lv2/lv2plug.in/ns/ext/urid/urid.h>
 #include <lv2/lv2plug.in/ns/ext/atom/atom.h>
+#include <lv2/lv2plug.in/ns/ext/atom/forge.h>
+#include <lv2/lv2plug.in/ns/ext/atom/util.h>
 #include <lv2/lv2plug.in/ns/ext/parameters/parameters.h>
 #include <lv2/lv2plug.in/ns/extensions/ui/ui.h>
 
@@ -43,7 +52,17 @@ extern "C" {
 
 #define RDF_PREFIX "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
 
+// per-connection URID dictionary, power of 2, filled up to 3/4
+#define SANDBOX_IO_URIDS 0x2000
+#define SANDBOX_IO_URIDS_MASK (SANDBOX_IO_URIDS - 1)
+#define SANDBOX_IO_URIDS_FILL (SANDBOX_IO_URIDS / 4 * 3)
+#define SANDBOX_IO_ANNOUNCED UINT32_MAX
+
 typedef struct _sandbox_io_subscription_t sandbox_io_subscription_t;
+typedef struct _sandbox_io_urid_t sandbox_io_urid_t;
+typedef struct _sandbox_io_urids_t sandbox_io_urids_t;
+typedef struct _sandbox_io_tx_t sandbox_io_tx_t;
+typedef struct _sandbox_io_rx_t sandbox_io_rx_t;
 typedef struct _sandbox_io_shm_body_t sandbox_io_shm_body_t;
 typedef struct _sandbox_io_shm_t sandbox_io_shm_t;
 typedef struct _sandbox_io_t sandbox_io_t;
@@ -52,20 +71,52 @@ typedef bool (*_sandbox_io_recv_cb_t)(void *data, uint32_t index, uint32_t size,
 	uint32_t format, const void *buf);
 typedef void (*_sandbox_io_subscribe_cb_t)(void *data, uint32_t index,
 	uint32_t protocol, bool state);
+typedef uint32_t (*_sandbox_io_urid_cb_t)(sandbox_io_t *io, void *data,
+	uint32_t urid);
 
 struct _sandbox_io_subscription_t {
 	uint32_t protocol;
 	int32_t state;
 };
 
+struct _sandbox_io_urid_t {
+	uint32_t key; // 0 marks an empty slot
+	uint32_t val;
+};
+
+struct _sandbox_io_urids_t {
+	uint32_t nitems;
+	sandbox_io_urid_t items [SANDBOX_IO_URIDS];
+};
+
+struct _sandbox_io_tx_t {
+	uint8_t *buf;
+	uint8_t *cur;
+	const uint8_t *end;
+	bool overflow;
+};
+
+struct _sandbox_io_rx_t {
+	const uint8_t *buf;
+	const uint8_t *end;
+	bool missing;
+};
+
 struct _sandbox_io_shm_body_t {
+#if defined(__linux__)
+	atomic_uint seq; // futex word, bumped on signal
+	atomic_uint sleepers; // receivers parked on futex
+#else
 	sem_t sem;
+#endif
 	varchunk_t varchunk;
 };
 
 struct _sandbox_io_shm_t {
-	atomic_size_t minimum;
+	// keep varchunks following in shared memory cache-line-aligned
+	atomic_size_t minimum __attribute__((aligned(VARCHUNK_CACHE_LINE)));
 	atomic_bool connected;
+	atomic_uint session;
 };
 
 struct _sandbox_io_t {
@@ -75,7 +126,10 @@ struct _sandbox_io_t {
 	LV2_URID_Map *map;
 	LV2_URID_Unmap *unmap;
 
-	netatom_t *netatom;
+	sandbox_io_urids_t *tx_urids; // local URIDs announced to peer
+	sandbox_io_urids_t *rx_urids; // peer URIDs -> local URIDs
+	uint32_t tx_serial;
+	unsigned tx_session;
 	LV2_Atom_Forge_Frame frame;
 	LV2_Atom_Forge forge;
 
@@ -103,8 +157,272 @@ struct _sandbox_io_t {
 	sandbox_io_shm_body_t *from_master;
 	sandbox_io_shm_body_t *to_master;
 	bool again;
+
+	uint64_t window_ns; // minimal interval between wakeups of parked peer
+	uint64_t wake_ns;
+	bool tx_pending;
 };
 
+static inline uint64_t
+_sandbox_io_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+#if defined(__linux__)
+static inline int
+_sandbox_io_futex_wait(atomic_uint *addr, unsigned val,
+	const struct timespec *abs_timeout)
+{
+	// shared futex, absolute timeout on CLOCK_REALTIME like sem_timedwait
+	return syscall(SYS_futex, addr, FUTEX_WAIT_BITSET | FUTEX_CLOCK_REALTIME,
+		val, abs_timeout, NULL, FUTEX_BITSET_MATCH_ANY);
+}
+
+static inline void
+_sandbox_io_futex_wake(atomic_uint *addr)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+#endif
+
+static inline sandbox_io_urid_t *
+_sandbox_io_urid_slot(sandbox_io_urids_t *urids, uint32_t key, bool add)
+{
+	uint32_t idx = (key * 0x9e3779b1) & SANDBOX_IO_URIDS_MASK;
+
+	// linear probing, terminates as table is never filled beyond 3/4
+	for(uint32_t i = 0; i < SANDBOX_IO_URIDS; i++, idx = (idx + 1) & SANDBOX_IO_URIDS_MASK)
+	{
+		sandbox_io_urid_t *slot = &urids->items[idx];
+
+		if(slot->key == key)
+			return slot;
+
+		if(slot->key == 0)
+		{
+			if(!add || (urids->nitems >= SANDBOX_IO_URIDS_FILL))
+				return NULL; // not found or dictionary full
+
+			urids->nitems += 1;
+			slot->key = key;
+			slot->val = 0;
+			return slot;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+_sandbox_io_walk(sandbox_io_t *io, LV2_Atom *atom, _sandbox_io_urid_cb_t cb,
+	void *data)
+{
+	LV2_Atom_Forge *forge = &io->forge;
+
+	// translate type first, so we can dispatch on local URIDs on both ends
+	atom->type = cb(io, data, atom->type);
+
+	if(atom->type == forge->URID)
+	{
+		uint32_t *u = LV2_ATOM_BODY(atom);
+		*u = cb(io, data, *u);
+	}
+	else if(atom->type == forge->Literal)
+	{
+		LV2_Atom_Literal *lit = (LV2_Atom_Literal *)atom;
+		lit->body.datatype = cb(io, data, lit->body.datatype);
+		lit->body.lang = cb(io, data, lit->body.lang);
+	}
+	else if(atom->type == forge->Object)
+	{
+		LV2_Atom_Object *obj = (LV2_Atom_Object *)atom;
+		obj->body.id = cb(io, data, obj->body.id);
+		obj->body.otype = cb(io, data, obj->body.otype);
+		LV2_ATOM_OBJECT_FOREACH(obj, prop)
+		{
+			prop->key = cb(io, data, prop->key);
+			prop->context = cb(io, data, prop->context);
+			_sandbox_io_walk(io, &prop->value, cb, data);
+		}
+	}
+	else if(atom->type == forge->Tuple)
+	{
+		LV2_Atom_Tuple *tup = (LV2_Atom_Tuple *)atom;
+		LV2_ATOM_TUPLE_FOREACH(tup, item)
+		{
+			_sandbox_io_walk(io, item, cb, data);
+		}
+	}
+	else if(atom->type == forge->Sequence)
+	{
+		LV2_Atom_Sequence *seq = (LV2_Atom_Sequence *)atom;
+		seq->body.unit = cb(io, data, seq->body.unit);
+		LV2_ATOM_SEQUENCE_FOREACH(seq, ev)
+		{
+			_sandbox_io_walk(io, &ev->body, cb, data);
+		}
+	}
+	else if(atom->type == forge->Vector)
+	{
+		LV2_Atom_Vector *vec = (LV2_Atom_Vector *)atom;
+		vec->body.child_type = cb(io, data, vec->body.child_type);
+	}
+}
+
+static uint32_t
+_sandbox_io_tx_urid(sandbox_io_t *io, void *data, uint32_t urid)
+{
+	sandbox_io_tx_t *tx = data;
+
+	if(urid == 0)
+		return 0; // ignore untyped atoms
+
+	sandbox_io_urid_t *slot = _sandbox_io_urid_slot(io->tx_urids, urid, true);
+
+	// already known to peer or already in this message's dictionary
+	if(slot && ( (slot->val == SANDBOX_IO_ANNOUNCED) || (slot->val == io->tx_serial) ) )
+		return urid;
+
+	const char *uri = io->unmap->unmap(io->unmap->handle, urid);
+	if(!uri)
+		return 0; // invalid urid
+
+	const uint32_t size = strlen(uri) + 1;
+	const uint32_t tot_size = sizeof(LV2_Atom) + lv2_atom_pad_size(size);
+
+	if(tx->cur + tot_size > tx->end)
+	{
+		tx->overflow = true;
+		return urid;
+	}
+
+	LV2_Atom *entry = (LV2_Atom *)tx->cur;
+	entry->size = size;
+	entry->type = urid;
+	strncpy(LV2_ATOM_BODY(entry), uri, tot_size - sizeof(LV2_Atom)); // automatic padding
+	tx->cur += tot_size;
+
+	if(slot) // otherwise dictionary is full, announce again in every message
+		slot->val = io->tx_serial;
+
+	return urid;
+}
+
+static uint32_t
+_sandbox_io_rx_urid(sandbox_io_t *io, void *data, uint32_t urid)
+{
+	sandbox_io_rx_t *rx = data;
+
+	if(urid == 0)
+		return 0; // ignore untyped atoms
+
+	const sandbox_io_urid_t *slot = _sandbox_io_urid_slot(io->rx_urids, urid, false);
+	if(slot)
+		return slot->val;
+
+	// dictionary full, resolve from message dictionary
+	for(const uint8_t *ptr = rx->buf;
+		ptr < rx->end;
+		ptr += lv2_atom_pad_size(lv2_atom_total_size((const LV2_Atom *)ptr)))
+	{
+		const LV2_Atom *entry = (const LV2_Atom *)ptr;
+
+		if(entry->type == urid)
+			return io->map->map(io->map->handle, LV2_ATOM_BODY_CONST(entry));
+	}
+
+	rx->missing = true;
+	return 0;
+}
+
+// appends dictionary entries for not yet announced URIDs, returns total size
+static inline size_t
+_sandbox_io_announce(sandbox_io_t *io, LV2_Atom *atom, size_t max_sz)
+{
+	const unsigned session = atomic_load_explicit(&io->shm->session, memory_order_acquire);
+
+	if(session != io->tx_session) // peer (re)connected with empty dictionary
+	{
+		memset(io->tx_urids, 0x0, sizeof(sandbox_io_urids_t));
+		io->tx_session = session;
+	}
+
+	if(++io->tx_serial == SANDBOX_IO_ANNOUNCED)
+		io->tx_serial = 1;
+
+	uint8_t *buf = (uint8_t *)atom;
+	const size_t tot_size = lv2_atom_pad_size(lv2_atom_total_size(atom));
+
+	if(tot_size > max_sz)
+		return 0;
+
+	sandbox_io_tx_t tx = {
+		.buf = buf + tot_size,
+		.cur = buf + tot_size,
+		.end = buf + max_sz,
+		.overflow = false
+	};
+
+	_sandbox_io_walk(io, atom, _sandbox_io_tx_urid, &tx);
+
+	if(tx.overflow)
+		return 0;
+
+	// only mark as announced once message is guaranteed to be sent
+	for(const uint8_t *ptr = tx.buf;
+		ptr < tx.cur;
+		ptr += lv2_atom_pad_size(lv2_atom_total_size((const LV2_Atom *)ptr)))
+	{
+		const LV2_Atom *entry = (const LV2_Atom *)ptr;
+		sandbox_io_urid_t *slot = _sandbox_io_urid_slot(io->tx_urids, entry->type, false);
+
+		if(slot)
+			slot->val = SANDBOX_IO_ANNOUNCED;
+	}
+
+	return tx.cur - buf;
+}
+
+// registers message dictionary and remaps URIDs in-place
+static inline const LV2_Atom *
+_sandbox_io_translate(sandbox_io_t *io, uint8_t *buf, size_t sz)
+{
+	LV2_Atom *atom = (LV2_Atom *)buf;
+	const size_t tot_size = lv2_atom_pad_size(lv2_atom_total_size(atom));
+
+	if(tot_size > sz)
+		return NULL;
+
+	sandbox_io_rx_t rx = {
+		.buf = buf + tot_size,
+		.end = buf + sz,
+		.missing = false
+	};
+
+	for(const uint8_t *ptr = rx.buf;
+		ptr < rx.end;
+		ptr += lv2_atom_pad_size(lv2_atom_total_size((const LV2_Atom *)ptr)))
+	{
+		const LV2_Atom *entry = (const LV2_Atom *)ptr;
+		sandbox_io_urid_t *slot = _sandbox_io_urid_slot(io->rx_urids, entry->type, true);
+
+		if(slot) // overwrites stale entries from a previous session
+			slot->val = io->map->map(io->map->handle, LV2_ATOM_BODY_CONST(entry));
+	}
+
+	_sandbox_io_walk(io, atom, _sandbox_io_rx_urid, &rx);
+
+	if(rx.missing)
+		return NULL;
+
+	return atom;
+}
+
 static inline int
 _sandbox_io_recv(sandbox_io_t *io, _sandbox_io_recv_cb_t recv_cb,
 	_sandbox_io_subscribe_cb_t subscribe_cb, void *data)
@@ -120,8 +438,8 @@ _sandbox_io_recv(sandbox_io_t *io, _sandbox_io_recv_cb_t recv_cb,
 	while((buf = varchunk_read_request(&rx->varchunk, &sz)))
 	{
 		const LV2_Atom *atom = io->again
-			? netatom_deserialize(io->netatom, (uint8_t *)buf, sz)
-			: (const LV2_Atom *)buf; // already deserialized in previous invocation
+			? _sandbox_io_translate(io, (uint8_t *)buf, sz)
+			: (const LV2_Atom *)buf; // already translated in previous invocation
 
 		io->again = true;
 
@@ -232,15 +550,18 @@ _sandbox_io_recv(sandbox_io_t *io, _sandbox_io_recv_cb_t recv_cb,
 		}
 		else
 		{
-			//fprintf(stderr, "_sandbox_io_recv: netatom_deserialize failed\n");
+			//fprintf(stderr, "_sandbox_io_recv: _sandbox_io_translate failed\n");
 		}
 
 		if(io->again)
-			varchunk_read_advance(&rx->varchunk);
+			varchunk_read_stage(&rx->varchunk);
 		else
 			break;
 	}
 
+	// release all consumed chunks at once
+	varchunk_read_commit(&rx->varchunk);
+
 	if(close_request)
 		return -1; // received ui:closeRequest
 
@@ -250,6 +571,10 @@ _sandbox_io_recv(sandbox_io_t *io, _sandbox_io_recv_cb_t recv_cb,
 static inline void
 _sandbox_io_connected_set(sandbox_io_t *io, bool connected)
 {
+	// a new session starts with an empty URID dictionary on the slave side
+	if(connected)
+		atomic_fetch_add_explicit(&io->shm->session, 1, memory_order_release);
+
 	atomic_store_explicit(&io->shm->connected, connected, memory_order_release);
 }
 
@@ -275,7 +600,7 @@ _sandbox_io_send(sandbox_io_t *io, uint32_t index,
 
 	// reserve additional bytes for the parent atom and dictionary
 	const size_t add_sz = sizeof(LV2_Atom_Object) + 3*(sizeof(LV2_Atom_Property) + sizeof(LV2_Atom_Int));
-	const size_t dict_sz = 1024; //FIXME how big ?
+	const size_t dict_sz = 1024; // only needed until URIDs are announced
 	const size_t req_sz = size + add_sz + dict_sz;
 	size_t max_sz;
 
@@ -362,12 +687,12 @@ _sandbox_io_send(sandbox_io_t *io, uint32_t index,
 		{
 			lv2_atom_forge_pop(&io->forge, &frame);
 
-			size_t wrt_sz;
-			const uint8_t *buf_rx = netatom_serialize(io->netatom, (LV2_Atom *)buf_tx, max_sz, &wrt_sz);
-			if(buf_rx)
+			const size_t wrt_sz = _sandbox_io_announce(io, (LV2_Atom *)buf_tx, max_sz);
+			if(wrt_sz)
 			{
-				varchunk_write_advance(&tx->varchunk, wrt_sz);
-				sem_post(&tx->sem);
+				// published and signaled in batch by _sandbox_io_signal_tx
+				varchunk_write_stage(&tx->varchunk, wrt_sz);
+				io->tx_pending = true;
 
 				return 0; // success
 			}
@@ -377,37 +702,43 @@ _sandbox_io_send(sandbox_io_t *io, uint32_t index,
 	return -1; // failed
 }
 
-static inline void
-_sandbox_io_wait(sandbox_io_t *io)
+// returns true on timeout
+static inline bool
+_sandbox_io_timedwait(sandbox_io_t *io, const struct timespec *abs_timeout)
 {
 	sandbox_io_shm_body_t *rx = io->is_master
 		? io->to_master
 		: io->from_master;
 
-	int s;
-	while((s = sem_wait(&rx->sem)) == -1)
+#if defined(__linux__)
+	const unsigned seq = atomic_load(&rx->seq);
+	size_t sz;
+
+	if(varchunk_read_request(&rx->varchunk, &sz))
+		return false; // data already pending, no need to park
+
+	bool timedout = false;
+
+	atomic_fetch_add(&rx->sleepers, 1);
+
+	while(atomic_load(&rx->seq) == seq)
 	{
-		switch(errno)
+		if( (_sandbox_io_futex_wait(&rx->seq, seq, abs_timeout) == -1)
+			&& (errno == ETIMEDOUT) )
 		{
-			case EINTR:
-				continue;
-
-			case EINVAL:
-				return;
+			timedout = true;
+			break;
 		}
 	}
 
-	return;
-}
-
-static inline bool
-_sandbox_io_timedwait(sandbox_io_t *io, const struct timespec *abs_timeout)
-{
-	sandbox_io_shm_body_t *rx = io->is_master
-		? io->to_master
-		: io->from_master;
+	atomic_fetch_sub(&rx->sleepers, 1);
 
-	while(sem_timedwait(&rx->sem, abs_timeout) == -1)
+	return timedout;
+#else
+	int s;
+	while( (s = abs_timeout
+		? sem_timedwait(&rx->sem, abs_timeout)
+		: sem_wait(&rx->sem)) == -1)
 	{
 		switch(errno)
 		{
@@ -423,6 +754,27 @@ _sandbox_io_timedwait(sandbox_io_t *io, const struct timespec *abs_timeout)
 	}
 
 	return false;
+#endif
+}
+
+static inline void
+_sandbox_io_wait(sandbox_io_t *io)
+{
+	_sandbox_io_timedwait(io, NULL);
+}
+
+static inline void
+_sandbox_io_wake(sandbox_io_shm_body_t *body)
+{
+#if defined(__linux__)
+	atomic_fetch_add(&body->seq, 1);
+
+	// only pay for a syscall if somebody actually is parked
+	if(atomic_load(&body->sleepers))
+		_sandbox_io_futex_wake(&body->seq);
+#else
+	sem_post(&body->sem);
+#endif
 }
 
 static inline void
@@ -432,9 +784,10 @@ _sandbox_io_signal_rx(sandbox_io_t *io)
 		? io->to_master
 		: io->from_master;
 
-	sem_post(&rx->sem);
+	_sandbox_io_wake(rx);
 }
 
+// publishes all staged messages and wakes peer at most once per window
 static inline void
 _sandbox_io_signal_tx(sandbox_io_t *io)
 {
@@ -442,7 +795,29 @@ _sandbox_io_signal_tx(sandbox_io_t *io)
 		? io->from_master
 		: io->to_master;
 
-	sem_post(&tx->sem);
+	if(!io->tx_pending)
+		return;
+
+	varchunk_write_commit(&tx->varchunk);
+
+	if(io->window_ns)
+	{
+		const uint64_t now = _sandbox_io_now();
+
+#if defined(__linux__)
+		// peer is parked and was woken recently, retry on a subsequent call
+		if( (now - io->wake_ns < io->window_ns) && atomic_load(&tx->sleepers) )
+			return;
+#else
+		if(now - io->wake_ns < io->window_ns)
+			return;
+#endif
+
+		io->wake_ns = now;
+	}
+
+	io->tx_pending = false;
+	_sandbox_io_wake(tx);
 }
 
 static inline int
@@ -454,12 +829,12 @@ _sandbox_io_init(sandbox_io_t *io, LV2_URID_Map *map, LV2_URID_Unmap *unmap,
 
 	io->is_master = is_master;
 	io->drop = drop_messages;
+	io->again = true; // first message needs translation, too
 
 	const bool is_shm = strncmp(socket_path, "shm://", 6) == 0;
-	const bool is_tcp = strncmp(socket_path, "tcp://", 6) == 0;
-	const bool swap = is_tcp ? true : false;
 
-	if(!(io->netatom = netatom_new(io->map, io->unmap, swap)))
+	if(  !(io->tx_urids = calloc(1, sizeof(sandbox_io_urids_t)))
+		|| !(io->rx_urids = calloc(1, sizeof(sandbox_io_urids_t))) )
 		return -1;
 
 	minimum = varchunk_body_size(minimum);
@@ -499,15 +874,23 @@ _sandbox_io_init(sandbox_io_t *io, LV2_URID_Map *map, LV2_URID_Unmap *unmap,
 
 	if(io->is_master)
 	{
+#if defined(__linux__)
+		atomic_init(&io->from_master->seq, 0);
+		atomic_init(&io->from_master->sleepers, 0);
+		atomic_init(&io->to_master->seq, 0);
+		atomic_init(&io->to_master->sleepers, 0);
+#else
 		if(sem_init(&io->from_master->sem, 1, 0) == -1)
 			return -1;
 		if(sem_init(&io->to_master->sem, 1, 0) == -1)
 			return -1;
+#endif
 
 		varchunk_init(&io->from_master->varchunk, minimum, true);
 		varchunk_init(&io->to_master->varchunk, minimum, true);
 
 		atomic_init(&io->shm->connected, false);
+		atomic_init(&io->shm->session, 0);
 	}
 
 	lv2_atom_forge_init(&io->forge, map);
@@ -539,18 +922,22 @@ _sandbox_io_deinit(sandbox_io_t *io, bool terminate)
 {
 	if(terminate)
 	{
+		io->window_ns = 0; // do not coalesce last message
 		_sandbox_io_send(io, 0, 0, io->ui_close_request, NULL);
+		_sandbox_io_signal_tx(io);
 		usleep(100000); // wait 100ms, for timer-based UIs to receive message
 	}
 
 	const size_t total_size = sizeof(sandbox_io_shm_t);
 	if(io->shm)
 	{
+#if !defined(__linux__)
 		if(io->is_master)
 		{
 			sem_destroy(&io->from_master->sem);
 			sem_destroy(&io->to_master->sem);
 		}
+#endif
 
 		munmap(io->shm, total_size);
 		if(io->is_master)
@@ -559,8 +946,10 @@ _sandbox_io_deinit(sandbox_io_t *io, bool terminate)
 	if(io->name)
 		free(io->name);
 
-	if(io->netatom)
-		netatom_free(io->netatom);
+	if(io->tx_urids)
+		free(io->tx_urids);
+	if(io->rx_urids)
+		free(io->rx_urids);
 }
 
 #ifdef __cplusplus
@@ -47,6 +47,9 @@ sandbox_master_new(sandbox_master_driver_t *driver, void *data, size_t minimum)
 	if(_sandbox_io_init(&sb->io, driver->map, driver->unmap, driver->socket_path, true, true, minimum))
 		goto fail;
 
+	if(driver->update_rate > 0.f)
+		sb->io.window_ns = 1000000000 / driver->update_rate;
+
 	return sb;
 
 fail:
@@ -104,7 +107,8 @@ sandbox_master_signal_rx(sandbox_master_t *sb)
 void
 sandbox_master_signal_tx(sandbox_master_t *sb)
 {
-	_sandbox_io_signal_tx(&sb->io);
+	if(sb)
+		_sandbox_io_signal_tx(&sb->io);
 }
 
 bool
@@ -37,6 +37,7 @@ struct _sandbox_master_driver_t {
 	LV2_URID_Unmap *unmap;
 	sandbox_master_recv_cb_t recv_cb;
 	sandbox_master_subscribe_cb_t subscribe_cb;
+	float update_rate; // coalesce wakeups of slave to this rate, 0: disabled
 };
 
 sandbox_master_t *
@@ -258,6 +258,8 @@ _write_function(LV2UI_Controller controller, uint32_t index,
 
 	const int status = _sandbox_io_send(&sb->io, index, size, protocol, buf);
 	(void)status; //TODO
+
+	_sandbox_io_signal_tx(&sb->io); // host polls every cycle, no need to coalesce
 }
 
 static inline uint32_t
@@ -734,7 +736,7 @@ sandbox_slave_new(int argc, char **argv, const sandbox_slave_driver_t *driver,
 	sb->host_resize.handle = data;
 	sb->host_resize.ui_resize = driver->resize_cb;
 
-	if(!(sb->mapper = mapper_new(0x1000000, 0, NULL, NULL, NULL, NULL))) // 16M
+	if(!(sb->mapper = mapper_new(0x10000, 0, NULL, NULL, NULL, NULL))) // 64K, grows on demand
 	{
 		fprintf(stderr, "mapper_new failed\n");
 		goto fail;
@@ -1162,6 +1164,8 @@ sandbox_slave_recv(sandbox_slave_t *sb)
 {
 	if(sb)
 	{
+		mapper_grow(sb->mapper); // UI thread is not rt-critical
+
 		return _sandbox_io_recv(&sb->io, _sandbox_recv_cb, NULL, sb);
 	}
 
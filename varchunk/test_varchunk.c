@@ -21,6 +21,7 @@
 #include <pthread.h>
 #include <unistd.h>
 #include <assert.h>
+#include <time.h>
 
 #include <varchunk.h>
 
@@ -40,6 +41,7 @@ static const struct timespec req = {
 static uint64_t iterations = 10000000;
 #define THRESHOLD (RAND_MAX / 256)
 #define PAD(SIZE) ( ( (size_t)(SIZE) + 7U ) & ( ~7U ) )
+#define BATCH 32
 
 static void *
 producer_main(void *arg)
@@ -120,6 +122,227 @@ consumer_main(void *arg)
 	return NULL;
 }
 
+static void *
+producer_batch_main(void *arg)
+{
+	varchunk_t *varchunk = arg;
+	uint8_t *ptr;
+	const uint8_t *end;
+	size_t written;
+	uint64_t cnt = 0;
+	unsigned staged = 0;
+
+	while(cnt < iterations)
+	{
+		written = PAD(rand() * 1024.f / RAND_MAX);
+
+		if( (ptr = varchunk_write_request(varchunk, written)) )
+		{
+			end = ptr + written;
+			for(uint8_t *src=ptr; src<end; src+=sizeof(uint64_t))
+			{
+				*(uint64_t *)src = cnt;
+			}
+			varchunk_write_stage(varchunk, written);
+			cnt++;
+
+			if(++staged < (unsigned)(rand() % BATCH) + 1)
+				continue;
+		}
+
+		// batch complete or buffer full
+		varchunk_write_commit(varchunk);
+		staged = 0;
+	}
+
+	varchunk_write_commit(varchunk);
+
+	return NULL;
+}
+
+static void *
+consumer_batch_main(void *arg)
+{
+	varchunk_t *varchunk = arg;
+	const uint8_t *ptr;
+	const uint8_t *end;
+	size_t toread;
+	uint64_t cnt = 0;
+
+	while(cnt < iterations)
+	{
+		// drain everything available, release it at once
+		while( (ptr = varchunk_read_request(varchunk, &toread)) )
+		{
+			end = ptr + toread;
+			for(const uint8_t *src=ptr; src<end; src+=sizeof(uint64_t))
+			{
+				assert(*(const uint64_t *)src == cnt);
+			}
+			varchunk_read_stage(varchunk);
+			cnt++;
+		}
+
+		varchunk_read_commit(varchunk);
+	}
+
+	return NULL;
+}
+
+static void
+test_threaded_batch()
+{
+	pthread_t producer;
+	pthread_t consumer;
+	varchunk_t *varchunk = varchunk_new(8192, true);
+	assert(varchunk);
+
+	pthread_create(&consumer, NULL, consumer_batch_main, varchunk);
+	pthread_create(&producer, NULL, producer_batch_main, varchunk);
+
+	pthread_join(producer, NULL);
+	pthread_join(consumer, NULL);
+
+	varchunk_free(varchunk);
+}
+
+#if !defined(_WIN32)
+typedef struct _bench_t bench_t;
+
+struct _bench_t {
+	varchunk_t *varchunk;
+	bool batch;
+	uint64_t lat [64]; // log2 histogram of latencies in ns
+};
+
+static inline uint64_t
+_bench_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static void *
+bench_producer_main(void *arg)
+{
+	bench_t *bench = arg;
+	varchunk_t *varchunk = bench->varchunk;
+	unsigned staged = 0;
+
+	for(uint64_t cnt = 0; cnt < iterations; )
+	{
+		uint64_t *ptr;
+
+		// small notification-sized chunks, as sent to the UI
+		if( (ptr = varchunk_write_request(varchunk, 2*sizeof(uint64_t))) )
+		{
+			ptr[0] = cnt++;
+			ptr[1] = _bench_now();
+
+			if(!bench->batch)
+			{
+				varchunk_write_advance(varchunk, 2*sizeof(uint64_t));
+				continue;
+			}
+
+			varchunk_write_stage(varchunk, 2*sizeof(uint64_t));
+			if(++staged < BATCH)
+				continue;
+		}
+
+		varchunk_write_commit(varchunk);
+		staged = 0;
+	}
+
+	varchunk_write_commit(varchunk);
+
+	return NULL;
+}
+
+static void *
+bench_consumer_main(void *arg)
+{
+	bench_t *bench = arg;
+	varchunk_t *varchunk = bench->varchunk;
+	const uint64_t *ptr;
+	size_t toread;
+
+	for(uint64_t cnt = 0; cnt < iterations; )
+	{
+		while( (ptr = varchunk_read_request(varchunk, &toread)) )
+		{
+			assert(ptr[0] == cnt);
+			const uint64_t dt = _bench_now() - ptr[1];
+			bench->lat[dt ? 64 - __builtin_clzll(dt) : 0] += 1;
+			cnt++;
+
+			if(!bench->batch)
+			{
+				varchunk_read_advance(varchunk);
+				break;
+			}
+
+			varchunk_read_stage(varchunk);
+		}
+
+		if(bench->batch)
+			varchunk_read_commit(varchunk);
+	}
+
+	return NULL;
+}
+
+static uint64_t
+_bench_percentile(const bench_t *bench, double p)
+{
+	const uint64_t rank = iterations * p;
+	uint64_t sum = 0;
+
+	for(unsigned i=0; i<64; i++)
+	{
+		sum += bench->lat[i];
+
+		if(sum > rank)
+			return i ? (1ULL << i) - 1 : 0; // upper bound of bucket
+	}
+
+	return UINT64_MAX;
+}
+
+static void
+bench_threaded(bool batch)
+{
+	pthread_t producer;
+	pthread_t consumer;
+	bench_t bench = {
+		.varchunk = varchunk_new(8192, true),
+		.batch = batch
+	};
+	assert(bench.varchunk);
+
+	const uint64_t t0 = _bench_now();
+
+	pthread_create(&consumer, NULL, bench_consumer_main, &bench);
+	pthread_create(&producer, NULL, bench_producer_main, &bench);
+
+	pthread_join(producer, NULL);
+	pthread_join(consumer, NULL);
+
+	const uint64_t t1 = _bench_now();
+	const double secs = (t1 - t0) * 1e-9;
+
+	fprintf(stdout, "%-8s %10.3f Mmsg/s  p50 < %6"PRIu64" ns  p99 < %6"PRIu64" ns"
+		"  p99.9 < %6"PRIu64" ns\n",
+		batch ? "batch" : "single", iterations / secs * 1e-6,
+		_bench_percentile(&bench, 0.5), _bench_percentile(&bench, 0.99),
+		_bench_percentile(&bench, 0.999));
+
+	varchunk_free(bench.varchunk);
+}
+#endif
+
 static void
 test_threaded()
 {
@@ -245,10 +468,17 @@ main(int argc, char **argv)
 	assert(varchunk_is_lock_free());
 
 	test_threaded();
+	test_threaded_batch();
 
 #if defined(VARCHUNK_USE_SHARED_MEM)
 	test_shared();
 #endif
 
+#if !defined(_WIN32)
+	// one release/acquire pair per chunk vs. per batch of up to BATCH chunks
+	bench_threaded(false);
+	bench_threaded(true);
+#endif
+
 	return 0;
 }
@@ -62,17 +62,30 @@ varchunk_write_request(varchunk_t *varchunk, size_t minimum);
 static inline void
 varchunk_write_advance(varchunk_t *varchunk, size_t written);
 
+static inline void
+varchunk_write_stage(varchunk_t *varchunk, size_t written);
+
+static inline void
+varchunk_write_commit(varchunk_t *varchunk);
+
 static inline const void *
 varchunk_read_request(varchunk_t *varchunk, size_t *toread);
 
 static inline void
 varchunk_read_advance(varchunk_t *varchunk);
 
+static inline void
+varchunk_read_stage(varchunk_t *varchunk);
+
+static inline void
+varchunk_read_commit(varchunk_t *varchunk);
+
 /*****************************************************************************
  * API END
  *****************************************************************************/
 
 #define VARCHUNK_PAD(SIZE) ( ( (size_t)(SIZE) + 7U ) & ( ~7U ) )
+#define VARCHUNK_CACHE_LINE 64
 
 typedef struct _varchunk_elmnt_t varchunk_elmnt_t;
 
@@ -84,16 +97,23 @@ struct _varchunk_elmnt_t {
 struct _varchunk_t {
   size_t size;
   size_t mask;
-	size_t rsvd;
-	size_t gapd;
 
 	memory_order acquire;
 	memory_order release;
 
-  atomic_size_t head;
-  atomic_size_t tail;
+	// producer side, on its own cache line
+  atomic_size_t head __attribute__((aligned(VARCHUNK_CACHE_LINE))); // committed
+	size_t head_local; // staged
+	size_t tail_cache; // last seen tail of consumer
+	size_t rsvd;
+	size_t gapd;
+
+	// consumer side, on its own cache line
+  atomic_size_t tail __attribute__((aligned(VARCHUNK_CACHE_LINE))); // committed
+	size_t tail_local; // staged
+	size_t head_cache; // last seen head of producer
 
-  uint8_t buf [] __attribute__((aligned(sizeof(varchunk_elmnt_t))));
+  uint8_t buf [] __attribute__((aligned(VARCHUNK_CACHE_LINE)));
 }; 
 
 static inline bool
@@ -125,7 +145,14 @@ varchunk_init(varchunk_t *varchunk, size_t body_size, bool release_and_acquire)
 		: memory_order_relaxed;
 
 	atomic_init(&varchunk->head, 0);
+	varchunk->head_local = 0;
+	varchunk->tail_cache = 0;
+	varchunk->rsvd = 0;
+	varchunk->gapd = 0;
+
 	atomic_init(&varchunk->tail, 0);
+	varchunk->tail_local = 0;
+	varchunk->head_cache = 0;
 
 	varchunk->size = body_size;
 	varchunk->mask = varchunk->size - 1;
@@ -140,9 +167,9 @@ varchunk_new(size_t minimum, bool release_and_acquire)
 	const size_t total_size = sizeof(varchunk_t) + body_size;
 
 #if defined(_WIN32)
-	varchunk = _aligned_malloc(total_size, sizeof(varchunk_elmnt_t));
+	varchunk = _aligned_malloc(total_size, VARCHUNK_CACHE_LINE);
 #else
-	posix_memalign((void **)&varchunk, sizeof(varchunk_elmnt_t), total_size);
+	posix_memalign((void **)&varchunk, VARCHUNK_CACHE_LINE, total_size);
 	mlock(varchunk, total_size); // prevent memory from being flushed to disk
 #endif
 
@@ -164,24 +191,12 @@ varchunk_free(varchunk_t *varchunk)
 	}
 }
 
-static inline void
-_varchunk_write_advance_raw(varchunk_t *varchunk, size_t head, size_t written)
-{
-	// only producer is allowed to advance write head
-	const size_t new_head = (head + written) & varchunk->mask;
-	atomic_store_explicit(&varchunk->head, new_head, varchunk->release);
-}
-
 static inline void *
-varchunk_write_request_max(varchunk_t *varchunk, size_t minimum, size_t *maximum)
+_varchunk_write_request_at(varchunk_t *varchunk, size_t head, size_t tail,
+	size_t padded, size_t *maximum)
 {
-	assert(varchunk);
-
 	size_t space; // size of writable buffer
 	size_t end; // virtual end of writable buffer
-	const size_t head = atomic_load_explicit(&varchunk->head, memory_order_relaxed); // read head
-	const size_t tail = atomic_load_explicit(&varchunk->tail, varchunk->acquire); // read tail (consumer modifies it any time)
-	const size_t padded = 2*sizeof(varchunk_elmnt_t) + VARCHUNK_PAD(minimum);
 
 	// calculate writable space
 	if(head > tail)
@@ -253,6 +268,26 @@ varchunk_write_request_max(varchunk_t *varchunk, size_t minimum, size_t *maximum
 	}
 }
 
+static inline void *
+varchunk_write_request_max(varchunk_t *varchunk, size_t minimum, size_t *maximum)
+{
+	assert(varchunk);
+
+	const size_t head = varchunk->head_local; // staged write head
+	const size_t padded = 2*sizeof(varchunk_elmnt_t) + VARCHUNK_PAD(minimum);
+
+	// try with cached tail first, only touch consumer cache line when full
+	void *ptr = _varchunk_write_request_at(varchunk, head, varchunk->tail_cache,
+		padded, maximum);
+	if(ptr)
+		return ptr;
+
+	varchunk->tail_cache = atomic_load_explicit(&varchunk->tail, varchunk->acquire); // read tail (consumer modifies it any time)
+
+	return _varchunk_write_request_at(varchunk, head, varchunk->tail_cache,
+		padded, maximum);
+}
+
 static inline void *
 varchunk_write_request(varchunk_t *varchunk, size_t minimum)
 {
@@ -260,14 +295,14 @@ varchunk_write_request(varchunk_t *varchunk, size_t minimum)
 }
 
 static inline void
-varchunk_write_advance(varchunk_t *varchunk, size_t written)
+varchunk_write_stage(varchunk_t *varchunk, size_t written)
 {
 	assert(varchunk);
 	// fail miserably if stupid programmer tries to write more than rsvd
 	assert(written <= varchunk->rsvd);
 
 	// write elmnt header at head
-	const size_t head = atomic_load_explicit(&varchunk->head, memory_order_relaxed);
+	const size_t head = varchunk->head_local;
 	if(varchunk->gapd > 0)
 	{
 		// fill end of first buffer with gap
@@ -288,17 +323,25 @@ varchunk_write_advance(varchunk_t *varchunk, size_t written)
 		elmnt->gap = 0;
 	}
 
-	// advance write head
-	_varchunk_write_advance_raw(varchunk, head,
-		varchunk->gapd + sizeof(varchunk_elmnt_t) + VARCHUNK_PAD(written));
+	// advance staged write head, only visible to consumer after commit
+	varchunk->head_local = (head + varchunk->gapd + sizeof(varchunk_elmnt_t)
+		+ VARCHUNK_PAD(written)) & varchunk->mask;
+}
+
+static inline void
+varchunk_write_commit(varchunk_t *varchunk)
+{
+	assert(varchunk);
+
+	// only producer is allowed to advance write head
+	atomic_store_explicit(&varchunk->head, varchunk->head_local, varchunk->release);
 }
 
 static inline void
-_varchunk_read_advance_raw(varchunk_t *varchunk, size_t tail, size_t read)
+varchunk_write_advance(varchunk_t *varchunk, size_t written)
 {
-	// only consumer is allowed to advance read tail 
-	const size_t new_tail = (tail + read) & varchunk->mask;
-	atomic_store_explicit(&varchunk->tail, new_tail, varchunk->release);
+	varchunk_write_stage(varchunk, written);
+	varchunk_write_commit(varchunk);
 }
 
 static inline const void *
@@ -306,8 +349,12 @@ varchunk_read_request(varchunk_t *varchunk, size_t *toread)
 {
 	assert(varchunk);
 	size_t space; // size of available buffer
-	const size_t tail = atomic_load_explicit(&varchunk->tail, memory_order_relaxed); // read tail
-	const size_t head = atomic_load_explicit(&varchunk->head, varchunk->acquire); // read head (producer modifies it any time)
+	const size_t tail = varchunk->tail_local; // staged read tail
+
+	// only touch producer cache line once everything seen so far is consumed
+	if(varchunk->head_cache == tail)
+		varchunk->head_cache = atomic_load_explicit(&varchunk->head, varchunk->acquire); // read head (producer modifies it any time)
+	const size_t head = varchunk->head_cache;
 
 	// calculate readable space
 	if(head > tail)
@@ -329,7 +376,7 @@ varchunk_read_request(varchunk_t *varchunk, size_t *toread)
 			if(elmnt->gap) // gap elmnt?
 			{
 				// skip gap
-				_varchunk_read_advance_raw(varchunk, tail, len1);
+				varchunk->tail_local = (tail + len1) & varchunk->mask;
 
 				// second part of available buffer
 				const uint8_t *buf2 = varchunk->buf;
@@ -363,16 +410,32 @@ varchunk_read_request(varchunk_t *varchunk, size_t *toread)
 }
 
 static inline void
-varchunk_read_advance(varchunk_t *varchunk)
+varchunk_read_stage(varchunk_t *varchunk)
 {
 	assert(varchunk);
 	// get elmnt header from tail (for size)
-	const size_t tail = atomic_load_explicit(&varchunk->tail, memory_order_relaxed);
+	const size_t tail = varchunk->tail_local;
 	const varchunk_elmnt_t *elmnt = (const varchunk_elmnt_t *)(varchunk->buf + tail);
 
-	// advance read tail
-	_varchunk_read_advance_raw(varchunk, tail,
-		sizeof(varchunk_elmnt_t) + VARCHUNK_PAD(elmnt->size));
+	// advance staged read tail, only visible to producer after commit
+	varchunk->tail_local = (tail + sizeof(varchunk_elmnt_t)
+		+ VARCHUNK_PAD(elmnt->size)) & varchunk->mask;
+}
+
+static inline void
+varchunk_read_commit(varchunk_t *varchunk)
+{
+	assert(varchunk);
+
+	// only consumer is allowed to advance read tail
+	atomic_store_explicit(&varchunk->tail, varchunk->tail_local, varchunk->release);
+}
+
+static inline void
+varchunk_read_advance(varchunk_t *varchunk)
+{
+	varchunk_read_stage(varchunk);
+	varchunk_read_commit(varchunk);
 }
 
 #undef VARCHUNK_PAD